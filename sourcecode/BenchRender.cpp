@@ -0,0 +1,226 @@
+//
+// BenchRender.cpp
+//
+//   A deterministic rendering benchmark.  See BenchRender.h.
+//
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "BenchRender.h"
+#include "TextureProj.h"
+#include "MyGeometries.h"
+#include "GlStateCache.h"
+#include "GlDebugOutput.h"
+#include "GlGpuProfiler.h"
+#include "CpuProfiler.h"
+#include "HeadlessContext.h"
+#include "GlOffscreenTarget.h"
+#include "GlGeomSphere.h"
+#include "GlGeomCylinder.h"
+#include "GlGeomTorus.h"
+#include "MathMisc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+std::vector<int> BenchRender::meshResolutions = { 4, 8, 16, 32 };
+
+namespace {
+    // The camera path: one orbit around the map, tilting and moving in and out.
+    const BenchCameraKey cameraPath[] = {
+        { 0.00, 0.25, 0.0,            0.0 },
+        { 0.25, 0.60, 0.5 * PI,      -8.0 },
+        { 0.50, 0.10, PI,            10.0 },
+        { 0.75, 0.45, 1.5 * PI,      25.0 },
+        { 1.00, 0.25, 2.0 * PI,       0.0 },
+    };
+    const int numCameraKeys = sizeof(cameraPath) / sizeof(cameraPath[0]);
+}
+
+void BenchRender::SetMeshResolutions(const char* commaSeparatedList)
+{
+    std::vector<int> resolutions;
+    const char* p = commaSeparatedList;
+    while (*p != 0) {
+        char* end;
+        long res = strtol(p, &end, 10);
+        if (end == p) {
+            break;
+        }
+        if (res >= 3 && res <= 80) {       // The range allowed by the 'M' and 'm' keys
+            resolutions.push_back((int)res);
+        }
+        else {
+            printf("Bench: mesh resolution %ld ignored (must be 3 to 80).\n", res);
+        }
+        p = (*end == ',') ? end + 1 : end;
+    }
+    if (!resolutions.empty()) {
+        meshResolutions = resolutions;
+    }
+}
+
+// Set the view to the camera path at the given frame, and upload everything that depends on it.
+void BenchRender::SetCameraForFrame(int frame, int numFrames)
+{
+    double s = numFrames > 1 ? (double)frame / (double)(numFrames - 1) : 0.0;
+    int k = 0;
+    while (k < numCameraKeys - 2 && s > cameraPath[k + 1].pathFraction) {
+        k++;
+    }
+    const BenchCameraKey& a = cameraPath[k];
+    const BenchCameraKey& b = cameraPath[k + 1];
+    double alpha = (s - a.pathFraction) / (b.pathFraction - a.pathFraction);
+    mySetView(a.viewAzimuth + alpha * (b.viewAzimuth - a.viewAzimuth),
+              a.viewDirection + alpha * (b.viewDirection - a.viewDirection),
+              a.ZextraDistance + alpha * (b.ZextraDistance - a.ZextraDistance));
+}
+
+// Time building (and uploading) the VBO and EBO of a sphere, a cylinder and a torus at the mesh resolution.
+//   The scene's meshes are remeshed lazily, at their next render, so separate meshes are built here.
+double BenchRender::TimeMeshing(int res)
+{
+    CpuProfileZone zone("Bench meshing");
+    long long meshingBegin = CpuProfiler::NowMicroseconds();
+    {
+        GlGeomSphere sphere(res, res);
+        GlGeomCylinder cylinder(res, res, res);
+        GlGeomTorus torus(res, res, 0.75);
+        sphere.InitializeAttribLocations(vertPos_loc, vertNormal_loc, vertTexCoords_loc);
+        cylinder.InitializeAttribLocations(vertPos_loc, vertNormal_loc, vertTexCoords_loc);
+        torus.InitializeAttribLocations(vertPos_loc, vertNormal_loc, vertTexCoords_loc);
+        glFinish();
+    }
+    GlStateCache::InvalidateVertexArray();      // The meshes' VAOs were bound, then deleted
+    return 1.0e-3 * (CpuProfiler::NowMicroseconds() - meshingBegin);
+}
+
+// The sample at the given fraction of the sorted samples (nearest rank).
+double BenchRender::Percentile(const std::vector<double>& sortedMs, double fraction)
+{
+    if (sortedMs.empty()) {
+        return 0.0;
+    }
+    size_t rank = (size_t)ceil(fraction * sortedMs.size());
+    return sortedMs[rank > 0 ? rank - 1 : 0];
+}
+
+bool BenchRender::Run(int numFrames, std::vector<BenchResult>& results)
+{
+    results.clear();
+    if (numFrames <= 0) {
+        return false;
+    }
+    int savedMeshRes = meshRes;
+    std::vector<double> frameMs(numFrames);
+    for (int res : meshResolutions) {
+        CpuProfileZone zone("Bench sweep");
+        meshRes = res;
+        MyRemeshGeometries();
+        double meshingMs = TimeMeshing(res);
+
+        // Warm up: let the driver finish any lazy work (shader variants, buffer uploads).
+        for (int i = 0; i < NumWarmupFrames; i++) {
+            SetCameraForFrame(0, numFrames);
+            mySetAnimationTime(0.0);
+            myRenderScene();
+        }
+        glFinish();
+        GlDebugOutput::ReportMessages();
+
+        long long drawCallsBefore = GlStateCache::NumDrawCalls();
+        long long trianglesBefore = GlStateCache::NumTriangles();
+        for (int i = 0; i < numFrames; i++) {
+            CpuProfileZone frameZone("Frame");
+            long long frameBegin = CpuProfiler::NowMicroseconds();
+            SetCameraForFrame(i, numFrames);
+            mySetAnimationTime(i * animateIncrement);
+            myRenderScene();
+            glFinish();                     // Wait for the frame, so its time is measured
+            frameMs[i] = 1.0e-3 * (CpuProfiler::NowMicroseconds() - frameBegin);
+        }
+        GlDebugOutput::ReportMessages();
+
+        BenchResult result;
+        result.meshRes = res;
+        result.numFrames = numFrames;
+        result.meshingMs = meshingMs;
+        result.drawCallsPerFrame = (double)(GlStateCache::NumDrawCalls() - drawCallsBefore) / numFrames;
+        result.trianglesPerFrame = (double)(GlStateCache::NumTriangles() - trianglesBefore) / numFrames;
+        double sumMs = 0.0;
+        for (double ms : frameMs) {
+            sumMs += ms;
+        }
+        result.meanMs = sumMs / numFrames;
+        std::sort(frameMs.begin(), frameMs.end());
+        result.p50Ms = Percentile(frameMs, 0.50);
+        result.p95Ms = Percentile(frameMs, 0.95);
+        result.p99Ms = Percentile(frameMs, 0.99);
+        result.maxMs = frameMs.back();
+        results.push_back(result);
+    }
+
+    meshRes = savedMeshRes;
+    MyRemeshGeometries();
+    return !results.empty();
+}
+
+void BenchRender::PrintResults(const std::vector<BenchResult>& results)
+{
+    printf("Bench: %d frames per mesh resolution.\n", results.empty() ? 0 : results[0].numFrames);
+    printf("  meshRes meshing ms    mean ms     p50 ms     p95 ms     p99 ms     max ms  draws/frame  triangles/frame\n");
+    for (const BenchResult& r : results) {
+        printf("  %7d %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %12.1f %16.0f\n",
+            r.meshRes, r.meshingMs, r.meanMs, r.p50Ms, r.p95Ms, r.p99Ms, r.maxMs, r.drawCallsPerFrame, r.trianglesPerFrame);
+    }
+}
+
+bool BenchRender::WriteCSV(const char* filename, const std::vector<BenchResult>& results)
+{
+    FILE* outfile = fopen(filename, "w");
+    if (outfile == nullptr) {
+        printf("Unable to open %s for writing.\n", filename);
+        return false;
+    }
+    fprintf(outfile, "meshRes,frames,meshing_ms,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,draw_calls_per_frame,triangles_per_frame\n");
+    for (const BenchResult& r : results) {
+        fprintf(outfile, "%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.1f,%.0f\n",
+            r.meshRes, r.numFrames, r.meshingMs, r.meanMs, r.p50Ms, r.p95Ms, r.p99Ms, r.maxMs, r.drawCallsPerFrame, r.trianglesPerFrame);
+    }
+    fclose(outfile);
+    printf("Bench results saved to %s.\n", filename);
+    return true;
+}
+
+int runBenchmark(int width, int height, int numFrames, const char* csvFilename, const char* traceFilename)
+{
+    long long startupBegin = CpuProfiler::NowMicroseconds();
+    HeadlessContext headlessContext;
+    GlOffscreenTarget offscreenTarget;
+    if (!setupHeadless(headlessContext, offscreenTarget, width, height)) {
+        return -1;
+    }
+    CpuProfiler::RecordZone("Startup", startupBegin, CpuProfiler::NowMicroseconds());
+    spinMode = false;           // The benchmark sets the animation time itself
+
+    std::vector<BenchResult> results;
+    if (!BenchRender::Run(numFrames, results)) {
+        printf("Bench: nothing rendered.\n");
+        return -1;
+    }
+    printf("Bench: %d x %d, renderer %s.\n", width, height, (const char*)glGetString(GL_RENDERER));
+    BenchRender::PrintResults(results);
+    GlGpuProfiler::PrintReport();       // GPU time of each render pass, over all the sweeps
+    printOcclusionReport();             // Before the report's frames, which are not part of the benchmark
+    printDepthPrepassReport();          // Fragments shaded with and without the depth pre-pass
+    if (csvFilename != nullptr && !BenchRender::WriteCSV(csvFilename, results)) {
+        return -1;
+    }
+    if (traceFilename != nullptr) {
+        CpuProfiler::DumpChromeTrace(traceFilename);
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+//
+// BenchRender.h  ---  Header file for BenchRender.cpp
+//
+//   A deterministic rendering benchmark, run headless with --bench.
+//   The camera flies a scripted path through keyframes of viewAzimuth,
+//   viewDirection and ZextraDistance, and the animation advances by a fixed
+//   step each frame, so every run renders exactly the same frames.
+//   The path is flown once for each mesh resolution in the sweep.
+//
+//   For each mesh resolution, reports the time to mesh, the mean, p50, p95
+//   and p99 frame time (CPU time including glFinish), and the draw calls and
+//   triangles per frame.
+//
+
+#ifndef BENCH_RENDER_H
+#define BENCH_RENDER_H
+
+#include <vector>
+
+// One keyframe of the camera path.  The view is interpolated linearly between keyframes.
+struct BenchCameraKey {
+    double pathFraction;        // 0 at the first frame, 1 at the last frame
+    double viewAzimuth;
+    double viewDirection;
+    double ZextraDistance;
+};
+
+// The results for one mesh resolution
+struct BenchResult {
+    int meshRes;
+    int numFrames;
+    double meshingMs;           // Time to build a sphere, cylinder and torus at meshRes (GlGeom* meshing)
+    double meanMs;
+    double p50Ms;
+    double p95Ms;
+    double p99Ms;
+    double maxMs;
+    double drawCallsPerFrame;
+    double trianglesPerFrame;
+};
+
+class BenchRender {
+
+public:
+    static constexpr int DefaultNumFrames = 300;
+    static constexpr int NumWarmupFrames = 10;     // Rendered before each sweep, not measured
+
+    // The mesh resolutions swept, in order.  Default: 4, 8, 16, 32.
+    static void SetMeshResolutions(const std::vector<int>& resolutions) { meshResolutions = resolutions; }
+    static void SetMeshResolutions(const char* commaSeparatedList);    // E.g., "4,8,16"
+
+    // Fly the camera path numFrames times, once for each mesh resolution.
+    //   The scene must be set up, and rendering into a target of the given size.
+    //   Returns false if nothing could be rendered.
+    static bool Run(int numFrames, std::vector<BenchResult>& results);
+
+    static void PrintResults(const std::vector<BenchResult>& results);
+    static bool WriteCSV(const char* filename, const std::vector<BenchResult>& results);
+
+private:
+    static std::vector<int> meshResolutions;
+
+    static void SetCameraForFrame(int frame, int numFrames);
+    static double TimeMeshing(int res);
+    static double Percentile(const std::vector<double>& sortedMs, double fraction);
+};
+
+// The --bench entry point: set up headless rendering, run the benchmark and print the report.
+int runBenchmark(int width, int height, int numFrames, const char* csvFilename, const char* traceFilename);
+
+#endif // BENCH_RENDER_H
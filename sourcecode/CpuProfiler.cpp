@@ -0,0 +1,135 @@
+//
+// CpuProfiler.cpp
+//
+//   Scoped CPU profiling zones, recorded into per-thread ring buffers,
+//   and dumped as a Chrome trace.  See CpuProfiler.h.
+//
+
+#include "CpuProfiler.h"
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+bool CpuProfiler::enabled = true;
+
+namespace {
+
+    struct ZoneEvent {
+        const char* name;
+        long long start;        // Microseconds
+        long long duration;
+    };
+
+    // The ring buffer of one thread.  Only the owning thread writes to it.
+    struct ThreadBuffer {
+        int threadId;
+        std::string threadName;
+        std::vector<ZoneEvent> events;
+        std::atomic<long long> numWritten{ 0 };     // Total events written (not wrapped)
+    };
+
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    std::mutex buffersMutex;        // Guards allBuffers and the thread names
+    std::vector<std::unique_ptr<ThreadBuffer>> allBuffers;  // Never shrinks: threads keep pointers
+
+    ThreadBuffer* GetThreadBuffer()
+    {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (buffer == nullptr) {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            allBuffers.emplace_back(new ThreadBuffer());
+            buffer = allBuffers.back().get();
+            buffer->threadId = (int)allBuffers.size();
+            buffer->events.resize(CpuProfiler::ThreadBufferSize);
+        }
+        return buffer;
+    }
+
+    // Write a string as a JSON string (with quotes).
+    void WriteJsonString(FILE* fp, const char* s)
+    {
+        fputc('"', fp);
+        for (; *s != 0; s++) {
+            if (*s == '"' || *s == '\\') {
+                fputc('\\', fp);
+            }
+            fputc(*s, fp);
+        }
+        fputc('"', fp);
+    }
+}
+
+long long CpuProfiler::NowMicroseconds()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void CpuProfiler::SetThreadName(const char* name)
+{
+    ThreadBuffer* buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    buffer->threadName = name;
+}
+
+void CpuProfiler::RecordZone(const char* name, long long startMicroseconds, long long endMicroseconds)
+{
+    ThreadBuffer* buffer = GetThreadBuffer();
+    long long n = buffer->numWritten.load(std::memory_order_relaxed);
+    ZoneEvent& event = buffer->events[n % ThreadBufferSize];
+    event.name = name;
+    event.start = startMicroseconds;
+    event.duration = endMicroseconds - startMicroseconds;
+    buffer->numWritten.store(n + 1, std::memory_order_release);
+}
+
+bool CpuProfiler::DumpChromeTrace(const char* filename)
+{
+    FILE* fp = fopen(filename, "w");
+    if (fp == nullptr) {
+        printf("Unable to open file %s for writing.\n", filename);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    int numEvents = 0;
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (const std::unique_ptr<ThreadBuffer>& buffer : allBuffers) {
+        if (!buffer->threadName.empty()) {
+            fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                first ? "" : ",\n", buffer->threadId);
+            WriteJsonString(fp, buffer->threadName.c_str());
+            fprintf(fp, "}}");
+            first = false;
+        }
+        // The events still in the ring buffer, oldest first.
+        //   Events written while dumping may be skipped or torn; that is fine for a trace.
+        long long end = buffer->numWritten.load(std::memory_order_acquire);
+        long long begin = end > ThreadBufferSize ? end - ThreadBufferSize : 0;
+        for (long long i = begin; i < end; i++) {
+            const ZoneEvent& event = buffer->events[i % ThreadBufferSize];
+            fprintf(fp, "%s{\"name\":", first ? "" : ",\n");
+            WriteJsonString(fp, event.name);
+            fprintf(fp, ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld}",
+                buffer->threadId, event.start, event.duration);
+            first = false;
+            numEvents++;
+        }
+    }
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+    printf("CPU profile: %d zones written to %s (open in chrome://tracing or ui.perfetto.dev).\n", numEvents, filename);
+    return true;
+}
+
+void CpuProfiler::Clear()
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : allBuffers) {
+        buffer->numWritten.store(0, std::memory_order_release);
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+//
+// CpuProfiler.h  ---  Header file for CpuProfiler.cpp
+//
+//   Hierarchical CPU profiling with scoped zones:
+//       void MyFunction() {
+//           CpuProfileZone zone("MyFunction");
+//           ...
+//       }
+//   Zones nest: a zone opened inside another zone is its child.
+//
+//   Each thread records its zones into its own ring buffer of ThreadBufferSize
+//   events (the oldest events are overwritten).  Recording a zone costs two
+//   clock reads and one store into the ring buffer, with no locks, so the zones
+//   can be left compiled in.
+//
+//   DumpChromeTrace writes the events of all threads as a JSON trace file,
+//   which can be loaded into chrome://tracing or https://ui.perfetto.dev.
+//
+
+#ifndef CPU_PROFILER_H
+#define CPU_PROFILER_H
+
+class CpuProfiler {
+
+public:
+    static constexpr int ThreadBufferSize = 1 << 16;     // Events kept per thread
+
+    static void SetEnabled(bool enable) { enabled = enable; }
+    static bool IsEnabled() { return enabled; }
+
+    // Name the calling thread in the trace (e.g., "Main", "Worker 1").
+    static void SetThreadName(const char* name);
+
+    // Microseconds since the profiler started.
+    static long long NowMicroseconds();
+
+    // Record a finished zone of the calling thread.  The name must be a string constant
+    //   (or otherwise outlive the profiler): only the pointer is stored.
+    static void RecordZone(const char* name, long long startMicroseconds, long long endMicroseconds);
+
+    // Write all recorded events as a Chrome trace event JSON file.  Returns false on failure.
+    static bool DumpChromeTrace(const char* filename);
+
+    // Forget all recorded events.  Call only while no other thread is recording.
+    static void Clear();
+
+private:
+    static bool enabled;
+};
+
+// CpuProfileZone
+//    Records the time from its construction to its destruction as a zone.
+class CpuProfileZone {
+public:
+    explicit CpuProfileZone(const char* zoneName)
+        : name(zoneName), start(CpuProfiler::IsEnabled() ? CpuProfiler::NowMicroseconds() : -1) {}
+    ~CpuProfileZone() {
+        if (start >= 0) {
+            CpuProfiler::RecordZone(name, start, CpuProfiler::NowMicroseconds());
+        }
+    }
+
+    CpuProfileZone(const CpuProfileZone&) = delete;
+    CpuProfileZone& operator=(const CpuProfileZone&) = delete;
+
+private:
+    const char* name;
+    long long start;        // -1 if the profiler was disabled
+};
+
+#endif // CPU_PROFILER_H
@@ -21,9 +21,13 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <vector>
 
 #include "EduPhong.h"
+#include "GlStateCache.h"
+#include "GlDebugOutput.h"
 #include "GlShaderMgr.h"
+#include "GlUniformRing.h"
 
 #include <GL/glew.h> 
 #include <GLFW/glfw3.h>
@@ -50,16 +54,31 @@ const unsigned int phUseFresnel_loc = 8;               // Corresponds to "locati
 
 /* *** 
  * Functions for uniform variable locations
+ *   The locations are looked up once, by phRegisterShaderProgram, and stored
+ *   in a record for the program (indexed by the program ID).
+ *   Programs that have not been registered fall back to glGetUniformLocation.
  * *** */
 
+std::vector<phProgramInfo> phProgramInfos;     // Indexed by program ID
+
+const phProgramInfo* phGetProgramInfo(unsigned int programID) {
+    if (programID != 0 && programID < phProgramInfos.size() && phProgramInfos[programID].programID == programID) {
+        return &phProgramInfos[programID];
+    }
+    return nullptr;
+}
+
 unsigned int phGetProjMatLoc(unsigned int programID) {
-    return glGetUniformLocation(programID, phProjMatName);
+    const phProgramInfo* info = phGetProgramInfo(programID);
+    return info ? info->projMatLoc : glGetUniformLocation(programID, phProjMatName);
 }
 unsigned int phGetModelviewMatLoc(unsigned int programID) {
-    return glGetUniformLocation(programID, phModelviewMatName);
+    const phProgramInfo* info = phGetProgramInfo(programID);
+    return info ? info->modelviewMatLoc : glGetUniformLocation(programID, phModelviewMatName);
 }
 unsigned int phGetApplyTextureLoc(unsigned int programID) {
-    return glGetUniformLocation(programID, phApplyTextureName);
+    const phProgramInfo* info = phGetProgramInfo(programID);
+    return info ? info->applyTextureLoc : glGetUniformLocation(programID, phApplyTextureName);
 }
 
 const char* globallightBlockName= "phGlobal";       // Name of the global light uniform block
@@ -94,6 +113,8 @@ int globallightBlockSize;           // Size of globallight buffer in bytes
 int lightsBlockSize;                // Size of data for a single light
 int lightsBlockOffset;              // Offset for the light block in the uniform buffer object
 int lightStride;                    // Stride between light blocks in the shader.
+std::vector<char> phongBlockData;   // The contents of the two blocks (laid out as in phongUBO)
+bool phongBlockDirty = true;        // phongBlockData has changed since it was loaded into phongUBO
 
 /*
 * Build and compile two shader programs
@@ -134,9 +155,23 @@ bool phRegisterShaderProgram(unsigned int programID)
     glUniformBlockBinding(programID, globallightBlockIndex, 0);      // Buffer binding 0 for global lights
     glUniformBlockBinding(programID, lightsBlockIndex, 1);           // Buffer binding 1 for lights
 
-    glUseProgram(programID);
-    unsigned int applyTextureLocation = phGetApplyTextureLoc(programID);
-    glUniform1i(applyTextureLocation, 0); // Default is to  not apply the texture
+    // Resolve the uniform locations once, and keep them in the program's record.
+    phProgramInfo info;
+    info.programID = programID;
+    info.projMatLoc = glGetUniformLocation(programID, phProjMatName);
+    info.modelviewMatLoc = glGetUniformLocation(programID, phModelviewMatName);
+    info.applyTextureLoc = glGetUniformLocation(programID, phApplyTextureName);
+    info.globallightBlockIndex = globallightBlockIndex;
+    info.lightsBlockIndex = lightsBlockIndex;
+    if (programID >= phProgramInfos.size()) {
+        phProgramInfo unused;
+        unused.programID = 0;           // Marks an entry with no registered program
+        phProgramInfos.resize(programID + 1, unused);
+    }
+    phProgramInfos[programID] = info;
+
+    GlStateCache::UseProgram(programID);
+    GlStateCache::Uniform1i(info.applyTextureLoc, 0); // Default is to  not apply the texture
 
     if (shaderLayoutInfoKnown) {
         return true;
@@ -147,11 +182,13 @@ bool phRegisterShaderProgram(unsigned int programID)
     glGetActiveUniformBlockiv(programID, lightsBlockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &lightsBlockSize);
     glGenBuffers(1, &phongUBO);
     glBindBuffer(GL_UNIFORM_BUFFER, phongUBO);
+    GlDebugOutput::LabelObject(GL_BUFFER, phongUBO, "EduPhong lights UBO");
     int uboAlign;
     glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlign);
     lightsBlockOffset = uboAlign * (1 + (globallightBlockSize - 1) / uboAlign );
     int totalSize = lightsBlockOffset + lightsBlockSize;
-    glBufferData(GL_UNIFORM_BUFFER, totalSize, 0, GL_STATIC_DRAW);
+    glBufferData(GL_UNIFORM_BUFFER, totalSize, 0, GL_DYNAMIC_DRAW);     // Updated whenever the lights change
+    phongBlockData.assign(totalSize, 0);
     glBindBufferRange(GL_UNIFORM_BUFFER, 0, phongUBO, 0, globallightBlockSize);
     glBindBufferRange(GL_UNIFORM_BUFFER, 1, phongUBO, lightsBlockOffset, lightsBlockSize);
 
@@ -196,9 +233,69 @@ void phMaterial::LoadIntoShaders()
     glVertexAttrib1f(phUseFresnel_loc, UseFresnel ? 1.0f : 0.0f);	   // Load Use_Fresnel flag as a float 1.0 or 0.0.
 }
 
+// ********
+// phMaterialRegistry
+// ********
+std::vector<const phMaterial*> phMaterialRegistry::materials;
+std::vector<float> phMaterialRegistry::uploadedData;
+unsigned int phMaterialRegistry::tableUBO = 0;
+long long phMaterialRegistry::numUploads = 0;
+
+int phMaterialRegistry::GetID(const phMaterial* material)
+{
+    for (int i = 0; i < (int)materials.size(); i++) {
+        if (materials[i] == material) {
+            return i;
+        }
+    }
+    if ((int)materials.size() == phMaxNumMaterials) {
+        fprintf(stderr, "phMaterialRegistry: More than %d materials.\n", phMaxNumMaterials);
+        return -1;
+    }
+    materials.push_back(material);
+    return (int)materials.size() - 1;
+}
+
+void phMaterialRegistry::LoadIntoShaders()
+{
+    if (materials.empty()) {
+        return;
+    }
+    float tableData[16 * phMaxNumMaterials] = { 0.0f };
+    int numFloats = 16 * (int)materials.size();
+    for (int i = 0; i < (int)materials.size(); i++) {
+        const phMaterial& material = *materials[i];
+        float* entry = tableData + 16 * i;
+        material.EmissiveColor.Dump(entry);
+        entry[3] = material.SpecularExponent;
+        material.AmbientColor.Dump(entry + 4);
+        entry[7] = material.UseFresnel ? 1.0f : 0.0f;
+        material.DiffuseColor.Dump(entry + 8);
+        entry[11] = 0.0f;
+        material.SpecularColor.Dump(entry + 12);
+        entry[15] = 0.0f;
+    }
+    if (tableUBO != 0 && (int)uploadedData.size() == numFloats
+            && memcmp(uploadedData.data(), tableData, numFloats * sizeof(float)) == 0) {
+        return;         // No material was edited
+    }
+    if (tableUBO == 0) {
+        glGenBuffers(1, &tableUBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, tableUBO);
+        GlDebugOutput::LabelObject(GL_BUFFER, tableUBO, "EduPhong material table UBO");
+    }
+    // The whole table is respecified, at its full size (the shaders declare phMaxNumMaterials entries).
+    glBindBuffer(GL_UNIFORM_BUFFER, tableUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(tableData), tableData, GL_STATIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, phMaterialTableBinding, tableUBO);
+    uploadedData.assign(tableData, tableData + numFloats);
+    numUploads++;
+}
+
+// phGlobal and phLight load into phongBlockData.  The data reaches the shaders with phLoadLightBlocks().
 void phGlobal::LoadIntoShaders()
 {
-    char* buffer = new char[globallightBlockSize];
+    char* buffer = phongBlockData.data();
     GlobalAmbientColor.Dump((float*)(buffer + offsetsGlobal[0]));
     memcpy(buffer + offsetsGlobal[1], &NumLights, sizeof(unsigned int));
     memcpy(buffer + offsetsGlobal[2], LocalViewer ? &trueGLbool : &falseGLbool, 4);      // Note the obscure way of loading a bool as a 4 byte integer
@@ -207,15 +304,12 @@ void phGlobal::LoadIntoShaders()
     memcpy(buffer + offsetsGlobal[5], EnableAmbient ? &trueGLbool : &falseGLbool, 4);
     memcpy(buffer + offsetsGlobal[6], EnableSpecular ? &trueGLbool : &falseGLbool, 4);
     memcpy(buffer + offsetsGlobal[7], UseHalfwayVector ? &trueGLbool : &falseGLbool, 4);   
-    glBindBuffer(GL_UNIFORM_BUFFER, phongUBO);
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, globallightBlockSize, buffer);
-
-    delete[] buffer;
+    phongBlockDirty = true;
 }
 
 void phLight::LoadIntoShaders(int lightNumber) {
     assert(0<=lightNumber && lightNumber < phMaxNumLights);
-    char* buffer = new char[lightStride];       // Allocate enough space to hold data for one light
+    char* buffer = phongBlockData.data() + lightsBlockOffset + lightNumber * lightStride;
     memcpy(buffer + offsetsLight[0], IsEnabled ? &trueGLbool : &falseGLbool, 4);      // Note: load a bool as a 4 byte integer
     memcpy(buffer + offsetsLight[1], IsAttenuated ? &trueGLbool : &falseGLbool, 4);
     memcpy(buffer + offsetsLight[2], IsSpotLight ? &trueGLbool : &falseGLbool, 4);
@@ -230,10 +324,32 @@ void phLight::LoadIntoShaders(int lightNumber) {
     memcpy(buffer + offsetsLight[11], &ConstantAttenuation, sizeof(float));
     memcpy(buffer + offsetsLight[12], &LinearAttenuation, sizeof(float));
     memcpy(buffer + offsetsLight[13], &QuadraticAttenuation, sizeof(float));
-    glBindBuffer(GL_UNIFORM_BUFFER, phongUBO);
-    int startLoc = lightsBlockOffset + lightNumber * lightStride;
-    glBufferSubData(GL_UNIFORM_BUFFER, startLoc, lightStride, buffer);
+    phongBlockDirty = true;
+}
 
+// Bind the global light and light array blocks for the next draws.
+//   With a uniform ring, the blocks are copied into this frame's region
+//   (every frame, since the regions are reused).  Otherwise phongUBO is
+//   updated, only if the lights have changed.
+void phLoadLightBlocks(GlUniformRing* ring)
+{
+    int totalSize = (int)phongBlockData.size();
+    int offset;
+    void* ringData = (ring != nullptr && totalSize > 0) ? ring->Allocate(totalSize, &offset) : nullptr;
+    if (ringData != nullptr) {
+        memcpy(ringData, phongBlockData.data(), totalSize);
+        ring->Flush();
+        ring->BindRange(0, offset, globallightBlockSize);
+        ring->BindRange(1, offset + lightsBlockOffset, lightsBlockSize);
+        return;
+    }
+    if (phongBlockDirty && totalSize > 0) {
+        glBindBuffer(GL_UNIFORM_BUFFER, phongUBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, totalSize, phongBlockData.data());
+        phongBlockDirty = false;
+    }
+    glBindBufferRange(GL_UNIFORM_BUFFER, 0, phongUBO, 0, globallightBlockSize);
+    glBindBufferRange(GL_UNIFORM_BUFFER, 1, phongUBO, lightsBlockOffset, lightsBlockSize);
 }
 
 
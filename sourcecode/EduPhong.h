@@ -21,6 +21,9 @@
 
 #include "LinearR3.h"
 #include "LinearR4.h"
+#include <vector>
+
+class GlUniformRing;
 
 constexpr int phMaxNumLights = 8;           // Needs to match the number in the shaders
 
@@ -47,6 +50,40 @@ public:
     void LoadIntoShaders();
 };
 
+// ********
+// phMaterialRegistry - 
+//   A table of all materials in a uniform buffer, for shaders that look
+//   materials up by ID instead of reading the constant vertex attributes.
+//   Each material gets an ID when it is first registered.  LoadIntoShaders
+//   compares the table with the materials' current values, and uploads it only
+//   when a material has been edited.
+//   Shader side (std140), bound to phMaterialTableBinding:
+//      struct phMaterialData { vec4 emissiveColor;  // Alpha: specular exponent
+//                              vec4 ambientColor;   // Alpha: 1.0 to use the Fresnel factor
+//                              vec4 diffuseColor; vec4 specularColor; };
+//      layout (std140) uniform phMaterialTable { phMaterialData materials[phMaxNumMaterials]; };
+// ********
+constexpr int phMaxNumMaterials = 64;       // Needs to match the number in the shaders
+constexpr unsigned int phMaterialTableBinding = 4;
+constexpr const char* phMaterialTableName = "phMaterialTable";
+
+class phMaterialRegistry {
+public:
+    // The ID of the material, registering it if it is new.  Returns -1 if the table is full.
+    static int GetID(const phMaterial* material);
+    static int GetNumMaterials() { return (int)materials.size(); }
+
+    // Upload the table if any material changed since the last upload, and bind it.  Once per frame.
+    static void LoadIntoShaders();
+    static long long NumUploads() { return numUploads; }
+
+private:
+    static std::vector<const phMaterial*> materials;
+    static std::vector<float> uploadedData;     // The table as last uploaded: 16 floats per material
+    static unsigned int tableUBO;
+    static long long numUploads;
+};
+
 // ********
 // phLight - 
 //   Light properties describe the color/brightness of a light.
@@ -128,6 +165,25 @@ extern const unsigned int UseFresnel_loc;                  // Corresponds to "lo
 void setup_phong_shaders();                     // Reads from EduPhong.glsl. Compiles and links the two "standard" shader programs
 bool phRegisterShaderProgram(unsigned int programID);
 
+// phGlobal::LoadIntoShaders and phLight::LoadIntoShaders only record the data.
+//   Call phLoadLightBlocks before drawing, once per frame if a uniform ring is used
+//   (ring == nullptr: the data is loaded into the shaders' own uniform buffer).
+void phLoadLightBlocks(GlUniformRing* ring = nullptr);
+
+// phProgramInfo - 
+//   The uniform locations and uniform block indices of a registered shader program.
+//   Filled in once by phRegisterShaderProgram, so the getters below need no
+//   glGetUniformLocation string lookups.
+struct phProgramInfo {
+    unsigned int programID;
+    unsigned int projMatLoc;
+    unsigned int modelviewMatLoc;
+    unsigned int applyTextureLoc;
+    unsigned int globallightBlockIndex;
+    unsigned int lightsBlockIndex;
+};
+const phProgramInfo* phGetProgramInfo(unsigned int programID);     // nullptr if not registered
+
 unsigned int phGetProjMatLoc(unsigned int programID);
 unsigned int phGetModelviewMatLoc(unsigned int programID);
 unsigned int phGetApplyTextureLoc(unsigned int programID);
@@ -0,0 +1,102 @@
+//
+// FrameTimeHistogram.cpp
+//
+//   A histogram of frame times.  See FrameTimeHistogram.h.
+//
+
+#include "FrameTimeHistogram.h"
+#include <stdio.h>
+#include <math.h>
+
+void FrameTimeHistogram::Reset()
+{
+    for (int i = 0; i < NumBuckets; i++) {
+        buckets[i] = 0;
+    }
+    numSamples = 0;
+    minMs = 0.0;
+    maxMs = 0.0;
+    sumMs = 0.0;
+    sumSqMs = 0.0;
+}
+
+void FrameTimeHistogram::AddSample(double seconds)
+{
+    double ms = 1000.0 * seconds;
+    int i = (int)(ms / BucketMs);
+    buckets[i < NumBuckets ? (i < 0 ? 0 : i) : NumBuckets - 1]++;
+    if (numSamples == 0 || ms < minMs) {
+        minMs = ms;
+    }
+    if (numSamples == 0 || ms > maxMs) {
+        maxMs = ms;
+    }
+    numSamples++;
+    sumMs += ms;
+    sumSqMs += ms * ms;
+}
+
+double FrameTimeHistogram::GetMeanMs() const
+{
+    return numSamples == 0 ? 0.0 : sumMs / numSamples;
+}
+
+double FrameTimeHistogram::GetStdDevMs() const
+{
+    if (numSamples < 2) {
+        return 0.0;
+    }
+    double mean = GetMeanMs();
+    double variance = (sumSqMs - numSamples * mean * mean) / (numSamples - 1);
+    return variance > 0.0 ? sqrt(variance) : 0.0;
+}
+
+// Returns the upper edge of the bucket holding the given fraction of the samples.
+double FrameTimeHistogram::GetPercentileMs(double fraction) const
+{
+    if (numSamples == 0) {
+        return 0.0;
+    }
+    long long target = (long long)ceil(fraction * numSamples);
+    long long count = 0;
+    for (int i = 0; i < NumBuckets - 1; i++) {
+        count += buckets[i];
+        if (count >= target) {
+            return (i + 1) * BucketMs;
+        }
+    }
+    return maxMs;
+}
+
+void FrameTimeHistogram::Print(const char* title) const
+{
+    printf("%s: %lld frames, mean %.2f ms (%.1f fps), std dev %.2f ms, min %.2f ms, max %.2f ms\n",
+        title, numSamples, GetMeanMs(), GetMeanMs() > 0.0 ? 1000.0 / GetMeanMs() : 0.0,
+        GetStdDevMs(), GetMinMs(), GetMaxMs());
+    if (numSamples == 0) {
+        return;
+    }
+    printf("  p50 %.1f ms, p95 %.1f ms, p99 %.1f ms\n",
+        GetPercentileMs(0.50), GetPercentileMs(0.95), GetPercentileMs(0.99));
+    long long largest = 0;
+    for (int i = 0; i < NumBuckets; i++) {
+        largest = buckets[i] > largest ? buckets[i] : largest;
+    }
+    const int barWidth = 50;
+    for (int i = 0; i < NumBuckets; i++) {
+        if (buckets[i] == 0) {
+            continue;
+        }
+        int bar = (int)((barWidth * buckets[i] + largest - 1) / largest);
+        if (i < NumBuckets - 1) {
+            printf("  %5.1f-%5.1f ms %8lld ", i * BucketMs, (i + 1) * BucketMs, buckets[i]);
+        }
+        else {
+            printf("  %5.1f+      ms %8lld ", i * BucketMs, buckets[i]);
+        }
+        for (int k = 0; k < bar; k++) {
+            putchar('#');
+        }
+        putchar('\n');
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+//
+// FrameTimeHistogram.h  ---  Header file for FrameTimeHistogram.cpp
+//
+//   A histogram of frame times, for looking at frame pacing.
+//   Frame times are put into buckets BucketMs milliseconds wide;
+//   frames longer than NumBuckets*BucketMs go into the last bucket.
+//   Also keeps the min, max, mean and standard deviation.
+//
+
+#ifndef FRAME_TIME_HISTOGRAM_H
+#define FRAME_TIME_HISTOGRAM_H
+
+class FrameTimeHistogram {
+
+public:
+    static constexpr int NumBuckets = 80;
+    static constexpr double BucketMs = 0.5;     // Buckets cover 0 to 40 milliseconds
+
+    FrameTimeHistogram() { Reset(); }
+
+    void Reset();
+    void AddSample(double seconds);
+
+    long long GetNumSamples() const { return numSamples; }
+    double GetMinMs() const { return numSamples == 0 ? 0.0 : minMs; }
+    double GetMaxMs() const { return maxMs; }
+    double GetMeanMs() const;
+    double GetStdDevMs() const;
+    double GetPercentileMs(double fraction) const;   // E.g., 0.99.  Accurate to one bucket.
+    long long GetBucketCount(int i) const { return buckets[i]; }
+
+    // Print the statistics and a bar chart of the non-empty buckets.
+    void Print(const char* title) const;
+
+private:
+    long long buckets[NumBuckets];
+    long long numSamples;
+    double minMs;
+    double maxMs;
+    double sumMs;
+    double sumSqMs;
+};
+
+#endif // FRAME_TIME_HISTOGRAM_H
@@ -0,0 +1,241 @@
+//
+// GlDebugOutput.cpp
+//
+//   Collects OpenGL debug messages with the KHR_debug callback.
+//   See GlDebugOutput.h.
+//
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "GlDebugOutput.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <mutex>
+
+bool check_for_opengl_errors();
+
+bool GlDebugOutput::active = false;
+int GlDebugOutput::minSeverityRank = 0;
+long long GlDebugOutput::numErrors = 0;
+
+namespace {
+
+    // A message from the callback, waiting to be printed.
+    struct DebugMessage {
+        GLenum source;
+        GLenum type;
+        GLuint id;
+        GLenum severity;
+        std::string text;
+        std::string groups;         // The debug groups open when the message was generated
+    };
+
+    const int MaxQueuedMessages = 64;       // Later messages are counted, but not kept
+
+    std::mutex queueMutex;                  // The callback may run on a driver thread (when asynchronous)
+    std::vector<DebugMessage> messageQueue;
+    int numDroppedMessages = 0;
+
+    std::vector<std::string> groupStack;    // Only used with the synchronous callback
+
+    // 0 = notification, 1 = low, 2 = medium, 3 = high
+    int SeverityRank(GLenum severity) {
+        switch (severity) {
+        case GL_DEBUG_SEVERITY_HIGH:
+            return 3;
+        case GL_DEBUG_SEVERITY_MEDIUM:
+            return 2;
+        case GL_DEBUG_SEVERITY_LOW:
+            return 1;
+        default:
+            return 0;
+        }
+    }
+
+    const char* SourceName(GLenum source) {
+        switch (source) {
+        case GL_DEBUG_SOURCE_API:               return "API";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM:     return "Window system";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER:   return "Shader compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY:       return "Third party";
+        case GL_DEBUG_SOURCE_APPLICATION:       return "Application";
+        default:                                return "Other";
+        }
+    }
+
+    const char* TypeName(GLenum type) {
+        switch (type) {
+        case GL_DEBUG_TYPE_ERROR:               return "ERROR";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "Deprecated behavior";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "Undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY:         return "Portability";
+        case GL_DEBUG_TYPE_PERFORMANCE:         return "Performance";
+        case GL_DEBUG_TYPE_MARKER:              return "Marker";
+        default:                                return "Other";
+        }
+    }
+
+    const char* SeverityName(GLenum severity) {
+        static const char* names[4] = { "notification", "low", "medium", "high" };
+        return names[SeverityRank(severity)];
+    }
+}
+
+void GlDebugOutput::SetWindowHints()
+{
+#if GL_DEBUG_CHECKS
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+#endif
+}
+
+bool GlDebugOutput::Initialize()
+{
+    if (!GLEW_KHR_debug && !GLEW_VERSION_4_3) {
+        active = false;
+        printf("KHR_debug not available: checking for OpenGL errors with glGetError.\n");
+        return false;
+    }
+    glEnable(GL_DEBUG_OUTPUT);
+#if GL_DEBUG_CHECKS
+    // Synchronous: the callback runs inside the OpenGL call that caused the message.
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    SetMinSeverity(GL_DEBUG_SEVERITY_LOW);
+#else
+    glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    SetMinSeverity(GL_DEBUG_SEVERITY_HIGH);
+#endif
+    glDebugMessageCallback(MessageCallback, nullptr);
+    active = true;
+    numErrors = 0;
+    return true;
+}
+
+void GlDebugOutput::SetMinSeverity(GLenum severity)
+{
+    static const GLenum severities[4] = {
+        GL_DEBUG_SEVERITY_NOTIFICATION, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_HIGH };
+    minSeverityRank = SeverityRank(severity);
+    if (!GLEW_KHR_debug && !GLEW_VERSION_4_3) {
+        return;
+    }
+    for (int i = 0; i < 4; i++) {
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severities[i], 0, nullptr, i >= minSeverityRank);
+    }
+}
+
+void GlDebugOutput::EnableMessages(GLenum source, GLenum type, bool enable)
+{
+    if (active) {
+        glDebugMessageControl(source, type, GL_DONT_CARE, 0, nullptr, enable);
+    }
+}
+
+void GLAPIENTRY GlDebugOutput::MessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+                                               GLsizei length, const GLchar* message, const void* userParam)
+{
+    if (SeverityRank(severity) < minSeverityRank) {
+        return;         // In case the driver ignores glDebugMessageControl
+    }
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if ((int)messageQueue.size() >= MaxQueuedMessages) {
+        numDroppedMessages++;
+        return;
+    }
+    DebugMessage msg;
+    msg.source = source;
+    msg.type = type;
+    msg.id = id;
+    msg.severity = severity;
+    msg.text.assign(message, length >= 0 ? (size_t)length : strlen(message));
+#if GL_DEBUG_CHECKS
+    for (const std::string& group : groupStack) {
+        msg.groups += (msg.groups.empty() ? "" : " > ") + group;
+    }
+#endif
+    messageQueue.push_back(std::move(msg));
+}
+
+int GlDebugOutput::ReportMessages(const char* label)
+{
+    std::vector<DebugMessage> messages;
+    int numDropped;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (messageQueue.empty() && numDroppedMessages == 0) {
+            return 0;
+        }
+        messages.swap(messageQueue);
+        numDropped = numDroppedMessages;
+        numDroppedMessages = 0;
+    }
+
+    int errors = 0;
+    for (const DebugMessage& msg : messages) {
+        if (msg.type == GL_DEBUG_TYPE_ERROR) {
+            errors++;
+        }
+        printf("OpenGL %s (%s, %s severity, id %u): %s\n",
+            TypeName(msg.type), SourceName(msg.source), SeverityName(msg.severity), msg.id, msg.text.c_str());
+        if (!msg.groups.empty()) {
+            printf("    in: %s\n", msg.groups.c_str());
+        }
+        if (label != nullptr) {
+            printf("    found at: %s\n", label);
+        }
+    }
+    if (numDropped > 0) {
+        printf("OpenGL debug output: %d more messages were dropped.\n", numDropped);
+    }
+    numErrors += errors;
+    return errors;
+}
+
+bool GlDebugOutput::CheckErrors(const char* label)
+{
+    if (active) {
+        return ReportMessages(label) != 0;
+    }
+    bool foundErrors = check_for_opengl_errors();
+    if (foundErrors && label != nullptr) {
+        printf("    found at: %s\n", label);
+    }
+    return foundErrors;
+}
+
+void GlDebugOutput::LabelObject(GLenum identifier, unsigned int name, const char* label)
+{
+#if GL_DEBUG_CHECKS
+    if (active && name != 0) {
+        glObjectLabel(identifier, name, -1, label);
+    }
+#else
+    (void)identifier; (void)name; (void)label;
+#endif
+}
+
+void GlDebugOutput::PushGroup(const char* label)
+{
+#if GL_DEBUG_CHECKS
+    if (active) {
+        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, label);
+        groupStack.push_back(label);
+    }
+#else
+    (void)label;
+#endif
+}
+
+void GlDebugOutput::PopGroup()
+{
+#if GL_DEBUG_CHECKS
+    if (active && !groupStack.empty()) {
+        glPopDebugGroup();
+        groupStack.pop_back();
+    }
+#endif
+}
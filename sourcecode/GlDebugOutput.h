@@ -0,0 +1,93 @@
+#pragma once
+
+//
+// GlDebugOutput.h  ---  Header file for GlDebugOutput.cpp
+//
+//   Collects OpenGL errors and warnings with the debug output callback
+//   (KHR_debug, core in OpenGL 4.3), instead of calling glGetError after
+//   every draw.  glGetError waits for the driver; the callback does not.
+//
+//   The messages are queued by the callback and printed by ReportMessages
+//   (or CheckErrors), which makes no OpenGL calls.  Messages can be filtered
+//   by source, type and severity.
+//
+//   If KHR_debug is not available, CheckErrors falls back to
+//   check_for_opengl_errors(), i.e., to glGetError.
+//
+//   GL_DEBUG_CHECKS is the compile-time switch:
+//     1 (the default, unless NDEBUG is defined): a debug context is requested,
+//        the callback is synchronous, CheckHotPath checks for errors, and
+//        objects and render passes are labeled.  A message is printed with
+//        the debug groups that were open when it was generated, and with the
+//        label of the CheckHotPath that reported it.
+//     0 (release builds): CheckHotPath, the labels and the debug groups compile
+//        to nothing.  The callback is asynchronous and reports only errors.
+//
+
+#ifndef GL_DEBUG_OUTPUT_H
+#define GL_DEBUG_OUTPUT_H
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#ifndef GL_DEBUG_CHECKS
+#ifdef NDEBUG
+#define GL_DEBUG_CHECKS 0
+#else
+#define GL_DEBUG_CHECKS 1
+#endif
+#endif
+
+class GlDebugOutput {
+
+public:
+    // Request a debug context (when GL_DEBUG_CHECKS is on).  Call before glfwCreateWindow.
+    static void SetWindowHints();
+
+    // Install the debug message callback.  Call after glewInit.
+    //   Returns false if KHR_debug is not available (glGetError is used instead).
+    static bool Initialize();
+    static bool IsActive() { return active; }
+
+    // Filtering.  The arguments are the OpenGL enums, e.g., GL_DEBUG_SOURCE_SHADER_COMPILER,
+    //   GL_DEBUG_TYPE_PERFORMANCE, GL_DEBUG_SEVERITY_MEDIUM.  GL_DONT_CARE matches all.
+    static void SetMinSeverity(GLenum severity);        // Messages less severe are dropped
+    static void EnableMessages(GLenum source, GLenum type, bool enable);
+
+    // Print the queued messages.  Returns the number of errors among them.
+    //   The label (may be nullptr) is printed with the messages, to show where they were found.
+    static int ReportMessages(const char* label = nullptr);
+
+    // Check for errors: ReportMessages if the callback is installed,
+    //   otherwise check_for_opengl_errors().  Returns true if there were errors.
+    static bool CheckErrors(const char* label);
+
+    // Check for errors on the rendering hot path: does nothing unless GL_DEBUG_CHECKS is on.
+    static void CheckHotPath(const char* label) {
+#if GL_DEBUG_CHECKS
+        CheckErrors(label);
+#else
+        (void)label;
+#endif
+    }
+
+    // Labels for objects (GL_BUFFER, GL_VERTEX_ARRAY, GL_PROGRAM, GL_TEXTURE, ...)
+    //   and debug groups around passes.  These do nothing unless GL_DEBUG_CHECKS is on.
+    static void LabelObject(GLenum identifier, unsigned int name, const char* label);
+    static void PushGroup(const char* label);
+    static void PopGroup();
+
+    // Total number of errors reported since Initialize.
+    static long long NumErrors() { return numErrors; }
+
+private:
+    static bool active;
+    static int minSeverityRank;
+    static long long numErrors;
+
+    static void GLAPIENTRY MessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+                                           GLsizei length, const GLchar* message, const void* userParam);
+};
+
+#endif // GL_DEBUG_OUTPUT_H
@@ -0,0 +1,224 @@
+//
+// GlFrameCapture.cpp
+//
+//   Asynchronous frame capture through a ring of pixel buffer objects.
+//   See GlFrameCapture.h.
+//
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "GlFrameCapture.h"
+#include "GlDebugOutput.h"
+#include "CpuProfiler.h"
+#include <string.h>
+
+bool GlFrameCapture::Start(const char* filename, int theWidth, int theHeight, int framesPerSecond)
+{
+    Stop();
+    if (theWidth <= 0 || theHeight <= 0) {
+        return false;
+    }
+    outfile = fopen(filename, "wb");
+    if (outfile == nullptr) {
+        printf("Capture: unable to open %s for writing.\n", filename);
+        return false;
+    }
+    const char* extension = strrchr(filename, '.');
+    y4mFormat = (extension != nullptr && strcmp(extension, ".y4m") == 0);
+    width = theWidth;
+    height = theHeight;
+    frameBytes = (size_t)4 * width * height;
+    if (y4mFormat) {
+        fprintf(outfile, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width, height, framesPerSecond);
+    }
+
+    // The PBOs are read back into (GL_STREAM_READ), and read by the CPU once each.
+    glGenBuffers(NumPBOs, pbos);
+    for (int i = 0; i < NumPBOs; i++) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+        GlDebugOutput::LabelObject(GL_BUFFER, pbos[i], "GlFrameCapture PBO");
+        fences[i] = nullptr;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    head = 0;
+    numInFlight = 0;
+
+    numCaptured = numWritten = numFenceWaits = numWriterWaits = 0;
+    readbackMs = 0.0;
+    stopWriter = false;
+    writerThread = std::thread(&GlFrameCapture::WriterLoop, this);
+    printf("Capture: recording %d x %d to %s (%s).\n", width, height, filename, y4mFormat ? "Y4M" : "raw RGB");
+    return true;
+}
+
+void GlFrameCapture::CaptureFrame()
+{
+    if (outfile == nullptr) {
+        return;
+    }
+    CpuProfileZone zone("GlFrameCapture::CaptureFrame");
+    long long begin = CpuProfiler::NowMicroseconds();
+
+    // Copy out every frame that is already finished, oldest first.
+    while (numInFlight > 0 && RetireOldest(false)) {
+    }
+    // If the ring is full, the oldest frame must be finished to reuse its PBO.
+    if (numInFlight == NumPBOs) {
+        numFenceWaits++;
+        RetireOldest(true);
+    }
+
+    // Start the asynchronous read into the next free PBO.  GL_RGBA is usually the framebuffer's own format.
+    int slot = (head + numInFlight) % NumPBOs;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    numInFlight++;
+    numCaptured++;
+
+    readbackMs += 1.0e-3 * (CpuProfiler::NowMicroseconds() - begin);
+}
+
+bool GlFrameCapture::RetireOldest(bool wait)
+{
+    GLsync fence = (GLsync)fences[head];
+    GLenum status = glClientWaitSync(fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000000ull : 0);
+    if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) {
+        if (!wait) {
+            return false;
+        }
+        printf("Capture: a frame readback did not finish.\n");
+    }
+    glDeleteSync(fence);
+    fences[head] = nullptr;
+
+    // Take a free buffer (or wait for the writer thread to free one), then copy the frame into it.
+    std::vector<unsigned char> frame;
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        if (queuedFrames.size() >= MaxQueuedFrames) {
+            numWriterWaits++;
+            queueChanged.wait(lock, [this] { return queuedFrames.size() < MaxQueuedFrames; });
+        }
+        if (!freeFrames.empty()) {
+            frame.swap(freeFrames.back());
+            freeFrames.pop_back();
+        }
+    }
+    frame.resize(frameBytes);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[head]);
+    const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes, GL_MAP_READ_BIT);
+    if (pixels != nullptr) {
+        memcpy(frame.data(), pixels, frameBytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    head = (head + 1) % NumPBOs;
+    numInFlight--;
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queuedFrames.push_back(std::move(frame));
+    }
+    queueChanged.notify_all();
+    return true;
+}
+
+void GlFrameCapture::Stop()
+{
+    if (outfile == nullptr) {
+        return;
+    }
+    while (numInFlight > 0) {
+        RetireOldest(true);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopWriter = true;
+    }
+    queueChanged.notify_all();
+    writerThread.join();
+    glDeleteBuffers(NumPBOs, pbos);
+    for (int i = 0; i < NumPBOs; i++) {
+        pbos[i] = 0;
+    }
+    fclose(outfile);
+    outfile = nullptr;
+    queuedFrames.clear();
+    freeFrames.clear();
+
+    printf("Capture: %lld frames captured, %lld written.  Readback %.3f ms per frame on the render thread.\n",
+        numCaptured, numWritten, numCaptured > 0 ? readbackMs / numCaptured : 0.0);
+    if (numFenceWaits > 0 || numWriterWaits > 0) {
+        printf("  Waited %lld times for the GPU and %lld times for the writer thread.\n", numFenceWaits, numWriterWaits);
+    }
+}
+
+// The writer thread: write the queued frames in order, until stopped and the queue is empty.
+void GlFrameCapture::WriterLoop()
+{
+    CpuProfiler::SetThreadName("Capture writer");
+    std::vector<unsigned char> scratch;
+    for (;;) {
+        std::vector<unsigned char> frame;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueChanged.wait(lock, [this] { return stopWriter || !queuedFrames.empty(); });
+            if (queuedFrames.empty()) {
+                return;                 // Stopped, and all frames are written
+            }
+            frame.swap(queuedFrames.front());
+            queuedFrames.pop_front();
+        }
+        queueChanged.notify_all();
+        WriteFrame(frame, scratch);
+        numWritten++;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            freeFrames.push_back(std::move(frame));
+        }
+    }
+}
+
+// Write one RGBA frame (bottom row first, as OpenGL reads it) to the file, top row first.
+void GlFrameCapture::WriteFrame(const std::vector<unsigned char>& rgba, std::vector<unsigned char>& scratch)
+{
+    CpuProfileZone zone("GlFrameCapture::WriteFrame");
+    size_t numPixels = (size_t)width * height;
+    scratch.resize(3 * numPixels);
+    if (y4mFormat) {
+        // Planar Y, Cb, Cr with the BT.601 studio range coefficients.
+        unsigned char* yPlane = scratch.data();
+        unsigned char* cbPlane = yPlane + numPixels;
+        unsigned char* crPlane = cbPlane + numPixels;
+        for (int row = 0; row < height; row++) {
+            const unsigned char* src = rgba.data() + (size_t)4 * width * (height - 1 - row);
+            size_t dst = (size_t)width * row;
+            for (int col = 0; col < width; col++, src += 4, dst++) {
+                int r = src[0], g = src[1], b = src[2];
+                yPlane[dst] = (unsigned char)((66 * r + 129 * g + 25 * b + 128 + (16 << 8)) >> 8);
+                cbPlane[dst] = (unsigned char)((-38 * r - 74 * g + 112 * b + 128 + (128 << 8)) >> 8);
+                crPlane[dst] = (unsigned char)((112 * r - 94 * g - 18 * b + 128 + (128 << 8)) >> 8);
+            }
+        }
+        fputs("FRAME\n", outfile);
+    }
+    else {
+        for (int row = 0; row < height; row++) {
+            const unsigned char* src = rgba.data() + (size_t)4 * width * (height - 1 - row);
+            unsigned char* dst = scratch.data() + (size_t)3 * width * row;
+            for (int col = 0; col < width; col++, src += 4, dst += 3) {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+            }
+        }
+    }
+    fwrite(scratch.data(), 1, scratch.size(), outfile);
+}
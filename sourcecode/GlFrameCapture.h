@@ -0,0 +1,91 @@
+#pragma once
+
+//
+// GlFrameCapture.h  ---  Header file for GlFrameCapture.cpp
+//
+//   Captures rendered frames to a video file without stalling the pipeline.
+//   Each frame is read into one of a ring of pixel buffer objects (PBOs) with
+//   an asynchronous glReadPixels, and a fence is placed after it.  A PBO is
+//   mapped only when its fence has signaled, normally a few frames later, so
+//   the CPU does not wait for the GPU.  The pixels are copied out and handed
+//   to a writer thread, which converts and writes them.
+//
+//   Output formats, from the filename's extension:
+//     .y4m   YUV4MPEG2 (4:4:4), e.g., for ffmpeg or mpv.
+//     other  Raw RGB, 8 bits per component, top row first
+//            (ffmpeg -f rawvideo -pixel_format rgb24 -video_size WxH -i file).
+//
+//   Call CaptureFrame() after rendering each frame (before the buffer swap),
+//   with the framebuffer to capture bound for reading.
+//
+
+#ifndef GL_FRAME_CAPTURE_H
+#define GL_FRAME_CAPTURE_H
+
+#include <stdio.h>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class GlFrameCapture {
+
+public:
+    static constexpr int NumPBOs = 4;               // Frames in flight between glReadPixels and the copy out
+    static constexpr int MaxQueuedFrames = 8;       // Frames waiting for the writer thread
+
+    GlFrameCapture() {}
+    ~GlFrameCapture() { Stop(); }
+
+    // Disable all copy and assignment operators (the object owns the PBOs and the thread).
+    GlFrameCapture(const GlFrameCapture&) = delete;
+    GlFrameCapture& operator=(const GlFrameCapture&) = delete;
+
+    // Open the file and create the PBOs.  Returns false (with a message) on failure.
+    bool Start(const char* filename, int width, int height, int framesPerSecond = 60);
+
+    // Read back the current frame.  Frames that are ready are passed to the writer thread.
+    void CaptureFrame();
+
+    // Finish all frames in flight, wait for the writer thread, close the file, and print statistics.
+    void Stop();
+
+    bool IsCapturing() const { return outfile != nullptr; }
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+
+private:
+    FILE* outfile = nullptr;
+    bool y4mFormat = false;
+    int width = 0;
+    int height = 0;
+    size_t frameBytes = 0;              // Bytes in one RGBA frame as read back
+
+    // The PBO ring: PBOs head, head+1, ..., are waiting for their fences.
+    unsigned int pbos[NumPBOs] = { 0 };
+    void* fences[NumPBOs] = { nullptr };        // GLsync
+    int head = 0;                       // Oldest PBO in flight
+    int numInFlight = 0;
+
+    // The writer thread's queue, and a pool of frame buffers for reuse
+    std::thread writerThread;
+    std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    std::deque<std::vector<unsigned char>> queuedFrames;
+    std::vector<std::vector<unsigned char>> freeFrames;
+    bool stopWriter = false;
+
+    // Statistics
+    long long numCaptured = 0;
+    long long numWritten = 0;
+    long long numFenceWaits = 0;        // Times the ring was full and a fence was not yet signaled
+    long long numWriterWaits = 0;       // Times the writer thread was behind
+    double readbackMs = 0.0;            // Time spent in CaptureFrame
+
+    bool RetireOldest(bool wait);       // Copy out the oldest PBO in flight, if its fence has signaled (or wait for it)
+    void WriterLoop();
+    void WriteFrame(const std::vector<unsigned char>& rgba, std::vector<unsigned char>& scratch);
+};
+
+#endif // GL_FRAME_CAPTURE_H
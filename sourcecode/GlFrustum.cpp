@@ -0,0 +1,160 @@
+//
+// GlFrustum.cpp
+//
+//   View frustum planes for culling.  See GlFrustum.h.
+//
+
+#include "GlFrustum.h"
+#include "LinearR4.h"
+#include <math.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define GL_FRUSTUM_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+void GlCullBoxes::Resize(int numBoxes)
+{
+    centerX.resize(numBoxes);
+    centerY.resize(numBoxes);
+    centerZ.resize(numBoxes);
+    extentX.resize(numBoxes);
+    extentY.resize(numBoxes);
+    extentZ.resize(numBoxes);
+}
+
+void GlCullBoxes::Set(int i, const float boxMin[3], const float boxMax[3])
+{
+    centerX[i] = 0.5f * (boxMin[0] + boxMax[0]);
+    centerY[i] = 0.5f * (boxMin[1] + boxMax[1]);
+    centerZ[i] = 0.5f * (boxMin[2] + boxMax[2]);
+    extentX[i] = 0.5f * (boxMax[0] - boxMin[0]);
+    extentY[i] = 0.5f * (boxMax[1] - boxMin[1]);
+    extentZ[i] = 0.5f * (boxMax[2] - boxMin[2]);
+}
+
+// The center is transformed, and each new half extent is the sum of the
+//    old half extents scaled by the absolute values of the matrix's row.
+void GlCullBoxes::Set(int i, const LinearMapR4& m, const float boxMin[3], const float boxMax[3])
+{
+    double c[3], e[3];
+    for (int k = 0; k < 3; k++) {
+        c[k] = 0.5 * ((double)boxMin[k] + (double)boxMax[k]);
+        e[k] = 0.5 * ((double)boxMax[k] - (double)boxMin[k]);
+    }
+    centerX[i] = (float)(m.m11 * c[0] + m.m12 * c[1] + m.m13 * c[2] + m.m14);
+    centerY[i] = (float)(m.m21 * c[0] + m.m22 * c[1] + m.m23 * c[2] + m.m24);
+    centerZ[i] = (float)(m.m31 * c[0] + m.m32 * c[1] + m.m33 * c[2] + m.m34);
+    extentX[i] = (float)(fabs(m.m11) * e[0] + fabs(m.m12) * e[1] + fabs(m.m13) * e[2]);
+    extentY[i] = (float)(fabs(m.m21) * e[0] + fabs(m.m22) * e[1] + fabs(m.m23) * e[2]);
+    extentZ[i] = (float)(fabs(m.m31) * e[0] + fabs(m.m32) * e[1] + fabs(m.m33) * e[2]);
+}
+
+// Each plane is the fourth row of the matrix plus or minus one of the other rows
+//    (the clip space tests -w <= x <= w, -w <= y <= w, -w <= z <= w).
+void GlFrustum::Set(const LinearMapR4& m)
+{
+    const double rows[4][4] = {
+        { m.m11, m.m12, m.m13, m.m14 },
+        { m.m21, m.m22, m.m23, m.m24 },
+        { m.m31, m.m32, m.m33, m.m34 },
+        { m.m41, m.m42, m.m43, m.m44 } };
+    for (int i = 0; i < 6; i++) {
+        double sign = (i & 1) ? -1.0 : 1.0;
+        const double* row = rows[i >> 1];
+        double plane[4];
+        for (int k = 0; k < 4; k++) {
+            plane[k] = rows[3][k] + sign * row[k];
+        }
+        double norm = sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        double scale = norm > 0.0 ? 1.0 / norm : 0.0;
+        for (int k = 0; k < 4; k++) {
+            planes[i][k] = (float)(scale * plane[k]);
+        }
+    }
+}
+
+// The radius is scaled by the largest scaling of the model matrix (the longest column).
+bool GlFrustum::SphereVisible(const LinearMapR4& m, const float center[3], float radius) const
+{
+    float worldCenter[3] = {
+        (float)(m.m11 * center[0] + m.m12 * center[1] + m.m13 * center[2] + m.m14),
+        (float)(m.m21 * center[0] + m.m22 * center[1] + m.m23 * center[2] + m.m24),
+        (float)(m.m31 * center[0] + m.m32 * center[1] + m.m33 * center[2] + m.m34) };
+    double scaleSq = m.m11 * m.m11 + m.m21 * m.m21 + m.m31 * m.m31;
+    double columnSq = m.m12 * m.m12 + m.m22 * m.m22 + m.m32 * m.m32;
+    scaleSq = columnSq > scaleSq ? columnSq : scaleSq;
+    columnSq = m.m13 * m.m13 + m.m23 * m.m23 + m.m33 * m.m33;
+    scaleSq = columnSq > scaleSq ? columnSq : scaleSq;
+    return SphereVisible(worldCenter, (float)(radius * sqrt(scaleSq)));
+}
+
+bool GlFrustum::SphereVisible(const float center[3], float radius) const
+{
+    for (int i = 0; i < 6; i++) {
+        const float* p = planes[i];
+        if (p[0] * center[0] + p[1] * center[1] + p[2] * center[2] + p[3] < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A box is outside a plane if even its corner farthest along the plane's
+//    normal is outside: the center's distance plus the box's reach along the
+//    normal, |a|*ex + |b|*ey + |c|*ez, is negative.
+bool GlFrustum::BoxVisible(const float center[3], const float extent[3]) const
+{
+    for (int i = 0; i < 6; i++) {
+        const float* p = planes[i];
+        float dist = p[0] * center[0] + p[1] * center[1] + p[2] * center[2] + p[3];
+        float reach = fabsf(p[0]) * extent[0] + fabsf(p[1]) * extent[1] + fabsf(p[2]) * extent[2];
+        if (dist + reach < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void GlFrustum::BoxesVisible(const GlCullBoxes& boxes, int begin, int end, unsigned char* visible) const
+{
+    int i = begin;
+#ifdef GL_FRUSTUM_USE_SSE
+    __m128 planeA[6], planeB[6], planeC[6], planeD[6], absA[6], absB[6], absC[6];
+    for (int p = 0; p < 6; p++) {
+        planeA[p] = _mm_set1_ps(planes[p][0]);
+        planeB[p] = _mm_set1_ps(planes[p][1]);
+        planeC[p] = _mm_set1_ps(planes[p][2]);
+        planeD[p] = _mm_set1_ps(planes[p][3]);
+        absA[p] = _mm_set1_ps(fabsf(planes[p][0]));
+        absB[p] = _mm_set1_ps(fabsf(planes[p][1]));
+        absC[p] = _mm_set1_ps(fabsf(planes[p][2]));
+    }
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= end; i += 4) {
+        __m128 cx = _mm_loadu_ps(&boxes.centerX[i]);
+        __m128 cy = _mm_loadu_ps(&boxes.centerY[i]);
+        __m128 cz = _mm_loadu_ps(&boxes.centerZ[i]);
+        __m128 ex = _mm_loadu_ps(&boxes.extentX[i]);
+        __m128 ey = _mm_loadu_ps(&boxes.extentY[i]);
+        __m128 ez = _mm_loadu_ps(&boxes.extentZ[i]);
+        __m128 outside = zero;
+        for (int p = 0; p < 6; p++) {
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeA[p], cx), _mm_mul_ps(planeB[p], cy)),
+                                     _mm_add_ps(_mm_mul_ps(planeC[p], cz), planeD[p]));
+            __m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absA[p], ex), _mm_mul_ps(absB[p], ey)),
+                                      _mm_mul_ps(absC[p], ez));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, reach), zero));
+        }
+        int outsideMask = _mm_movemask_ps(outside);
+        for (int k = 0; k < 4; k++) {
+            visible[i + k] = ((outsideMask >> k) & 1) ? 0 : 1;
+        }
+    }
+#endif
+    for (; i < end; i++) {
+        const float center[3] = { boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i] };
+        const float extent[3] = { boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i] };
+        visible[i] = BoxVisible(center, extent) ? 1 : 0;
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+//
+// GlFrustum.h  ---  Header file for GlFrustum.cpp
+//
+//   The six planes of a view frustum, for culling objects that cannot be seen.
+//   The planes are found from the product of the projection and the view
+//   matrices, so they are in world coordinates (or in model coordinates,
+//   if the model matrix is included in the product).
+//
+//   Objects are culled by their bounding spheres, or, more tightly, by their
+//   axis-aligned bounding boxes.  The boxes are kept in a GlCullBoxes, as a
+//   structure of arrays, so BoxesVisible can test four boxes at a time with SSE.
+//
+
+#ifndef GL_FRUSTUM_H
+#define GL_FRUSTUM_H
+
+#include <vector>
+
+class LinearMapR4;
+
+// GlCullBoxes
+//    Axis-aligned boxes in world coordinates, as their centers and half
+//    extents, with one array for each coordinate.
+class GlCullBoxes {
+
+public:
+    void Resize(int numBoxes);
+    int Size() const { return (int)centerX.size(); }
+
+    // Set box i from its corners.
+    void Set(int i, const float boxMin[3], const float boxMax[3]);
+    // Set box i to the box around a box in model coordinates placed by the model matrix.
+    void Set(int i, const LinearMapR4& modelMatrix, const float boxMin[3], const float boxMax[3]);
+
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;     // Half the size of the box along each axis
+};
+
+class GlFrustum {
+
+public:
+    GlFrustum() {}
+    explicit GlFrustum(const LinearMapR4& projViewMatrix) { Set(projViewMatrix); }
+
+    // Set the planes from projectionMatrix * viewMatrix.
+    void Set(const LinearMapR4& projViewMatrix);
+
+    // Is any part of the sphere inside all six planes?  (Conservative: may return true for invisible spheres.)
+    bool SphereVisible(const float center[3], float radius) const;
+    // The same, for a sphere in model coordinates placed by the model matrix.
+    bool SphereVisible(const LinearMapR4& modelMatrix, const float center[3], float radius) const;
+
+    // Is any part of the box inside all six planes?  (Conservative, like SphereVisible.)
+    bool BoxVisible(const float center[3], const float extent[3]) const;
+    // Test boxes begin through end-1, setting visible[i] to 1 if box i may be visible, or else to 0.
+    //   Four boxes are tested at a time, with SSE when it is available.
+    void BoxesVisible(const GlCullBoxes& boxes, int begin, int end, unsigned char* visible) const;
+
+    // Plane i is a*x + b*y + c*z + d >= 0 inside, with (a,b,c) a unit vector.
+    //   The planes are left, right, bottom, top, near, far.
+    const float* GetPlane(int i) const { return planes[i]; }
+
+private:
+    float planes[6][4];
+};
+
+#endif // GL_FRUSTUM_H
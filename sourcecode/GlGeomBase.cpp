@@ -25,6 +25,7 @@
 
 
 #include "GlGeomBase.h"
+#include "GlStateCache.h"
 #include "assert.h"
 
 // Use the static library (so glew32.dll is not needed):
@@ -53,7 +54,7 @@ void GlGeomBase::InitializeAttribLocations(
 
     // Link the VBO and EBO to the VAO, and request OpenGL to
     //   allocate memory for them.
-    glBindVertexArray(theVAO);
+    GlStateCache::BindVertexArray(theVAO);
     glBindBuffer(GL_ARRAY_BUFFER, theVBO);
     int numVertices = UseTexCoords() ? GetNumVerticesTexCoords() : GetNumVerticesNoTexCoords();
     glBufferData(GL_ARRAY_BUFFER, StrideVal() * numVertices * sizeof(float), 0, GL_STATIC_DRAW);
@@ -80,7 +81,7 @@ void GlGeomBase::InitializeAttribLocations(
 void GlGeomBase::CalcVBOandEBO_Base() {
 
 	// Calculate the buffer data - map and the unmap the two buffers.
-    glBindVertexArray(theVAO);
+    GlStateCache::BindVertexArray(theVAO);
     glBindBuffer(GL_ARRAY_BUFFER, theVBO);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, theEBO);
     float* VBOdata = (float*)glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
@@ -92,7 +93,7 @@ void GlGeomBase::CalcVBOandEBO_Base() {
     glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
  
     // Good practice to unbind things: helps with debugging if nothing else
-    glBindVertexArray(0); 
+    GlStateCache::BindVertexArray(0); 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
@@ -121,9 +122,9 @@ void GlGeomBase::RenderEBO(unsigned int drawMode, int numRenderElements, int EBO
     if (theVAO == 0) {
         assert(false && "InitializeAttribLocations must be called before rendering!");
     }
-    glBindVertexArray(theVAO);
+    GlStateCache::BindVertexArray(theVAO);     // The VAO is left bound: the state cache skips rebinding it
     glDrawElements(drawMode, (GLsizei)numRenderElements, GL_UNSIGNED_INT, (void*)(EBOstart * sizeof(unsigned int)));
-    glBindVertexArray(0);           // Good practice to unbind: helps with debugging if nothing else
+    GlStateCache::CountDraw(drawMode, numRenderElements);
 }
 
 // **********************************************
@@ -135,21 +136,23 @@ void GlGeomBase::RenderElements(unsigned int drawMode, int numRenderElements, co
 {
     unsigned int tempEBO;
     glGenBuffers(1, &tempEBO);
-    glBindVertexArray(theVAO);
+    GlStateCache::BindVertexArray(theVAO);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tempEBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, numRenderElements * sizeof(unsigned int), elementsData, GL_STATIC_DRAW);
 
     glDrawElements(drawMode, numRenderElements, GL_UNSIGNED_INT, 0);
+    GlStateCache::CountDraw(drawMode, numRenderElements);
     
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, theEBO);  // Restore the main EBO (The VAO maintains its knowledge of this)
     glDeleteBuffers(1, &tempEBO);
-    glBindVertexArray(0);
+    GlStateCache::BindVertexArray(0);
 
 }
 
 GlGeomBase::~GlGeomBase()
 {
-    glDeleteBuffers(3, &theVAO);  // The three buffer id's are contigous in memory!
+    glDeleteVertexArrays(1, &theVAO);
+    glDeleteBuffers(2, &theVBO);  // The two buffer id's are contigous in memory!
 }
 
 
@@ -0,0 +1,229 @@
+//
+// GlGpuProfiler.cpp
+//
+//   GPU timing of render passes with a ring of GL_TIME_ELAPSED queries.
+//   See GlGpuProfiler.h.
+//
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "GlGpuProfiler.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include "assert.h"
+
+bool GlGpuProfiler::enabled = true;
+bool GlGpuProfiler::initialized = false;
+std::vector<GlGpuProfiler::Pass> GlGpuProfiler::passes;
+unsigned int GlGpuProfiler::queries[GlGpuProfiler::FramesInFlight][GlGpuProfiler::MaxPassesPerFrame];
+GlGpuProfiler::FrameSlot GlGpuProfiler::slots[GlGpuProfiler::FramesInFlight];
+int GlGpuProfiler::curSlot = 0;
+int GlGpuProfiler::curPass = -1;
+bool GlGpuProfiler::inFrame = false;
+long long GlGpuProfiler::numDroppedFrames = 0;
+
+void GlGpuProfiler::Initialize()
+{
+    if (initialized) {
+        return;
+    }
+    glGenQueries(FramesInFlight * MaxPassesPerFrame, &queries[0][0]);
+    for (int s = 0; s < FramesInFlight; s++) {
+        slots[s].numQueries = 0;
+    }
+    curSlot = 0;
+    initialized = true;
+}
+
+void GlGpuProfiler::BeginFrame()
+{
+    if (!enabled || !initialized) {
+        return;
+    }
+    curSlot = (curSlot + 1) % FramesInFlight;
+    ReadBackSlot(curSlot);          // Issued FramesInFlight frames ago
+    slots[curSlot].numQueries = 0;
+    inFrame = true;
+}
+
+void GlGpuProfiler::EndFrame()
+{
+    assert(curPass == -1);          // Every BeginPass needs an EndPass
+    inFrame = false;
+}
+
+void GlGpuProfiler::BeginPass(const char* name)
+{
+    if (!inFrame) {
+        return;
+    }
+    assert(curPass == -1);          // Passes cannot be nested
+    FrameSlot& slot = slots[curSlot];
+    if (slot.numQueries >= MaxPassesPerFrame) {
+        return;
+    }
+    curPass = FindPass(name);
+    slot.passOfQuery[slot.numQueries] = curPass;
+    glBeginQuery(GL_TIME_ELAPSED, queries[curSlot][slot.numQueries]);
+    slot.numQueries++;
+}
+
+void GlGpuProfiler::EndPass()
+{
+    if (curPass == -1) {
+        return;
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    curPass = -1;
+}
+
+int GlGpuProfiler::FindPass(const char* name)
+{
+    for (int i = 0; i < (int)passes.size(); i++) {
+        if (strcmp(passes[i].name.c_str(), name) == 0) {
+            return i;
+        }
+    }
+    Pass newPass;
+    newPass.name = name;
+    newPass.numSamples = 0;
+    newPass.nextSample = 0;
+    newPass.lastMs = 0.0;
+    passes.push_back(newPass);
+    return (int)passes.size() - 1;
+}
+
+// Read back the queries of one slot, if they are all available.
+//   Queries finish in order, so it suffices to check the last one.
+void GlGpuProfiler::ReadBackSlot(int s)
+{
+    FrameSlot& slot = slots[s];
+    if (slot.numQueries == 0) {
+        return;
+    }
+    int available = 0;
+    glGetQueryObjectiv(queries[s][slot.numQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        numDroppedFrames++;         // Don't wait for the GPU
+        return;
+    }
+    for (int q = 0; q < slot.numQueries; q++) {
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(queries[s][q], GL_QUERY_RESULT, &nanoseconds);
+        AddSample(slot.passOfQuery[q], (double)nanoseconds * 1.0e-6);
+    }
+}
+
+void GlGpuProfiler::AddSample(int i, double ms)
+{
+    Pass& pass = passes[i];
+    pass.samples[pass.nextSample] = ms;
+    pass.nextSample = (pass.nextSample + 1) % WindowSize;
+    pass.numSamples = std::min(pass.numSamples + 1, WindowSize);
+    pass.lastMs = ms;
+}
+
+std::vector<double> GlGpuProfiler::SortedSamples(int i)
+{
+    const Pass& pass = passes[i];
+    std::vector<double> sorted(pass.samples, pass.samples + pass.numSamples);
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+double GlGpuProfiler::GetLastMs(int i)
+{
+    return passes[i].lastMs;
+}
+
+double GlGpuProfiler::GetMinMs(int i)
+{
+    const Pass& pass = passes[i];
+    if (pass.numSamples == 0) {
+        return 0.0;
+    }
+    return *std::min_element(pass.samples, pass.samples + pass.numSamples);
+}
+
+double GlGpuProfiler::GetAvgMs(int i)
+{
+    const Pass& pass = passes[i];
+    if (pass.numSamples == 0) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (int k = 0; k < pass.numSamples; k++) {
+        sum += pass.samples[k];
+    }
+    return sum / pass.numSamples;
+}
+
+double GlGpuProfiler::GetP99Ms(int i)
+{
+    std::vector<double> sorted = SortedSamples(i);
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    int k = (int)(0.99 * (sorted.size() - 1) + 0.5);
+    return sorted[k];
+}
+
+void GlGpuProfiler::ResetStatistics()
+{
+    for (Pass& pass : passes) {
+        pass.numSamples = 0;
+        pass.nextSample = 0;
+        pass.lastMs = 0.0;
+    }
+    numDroppedFrames = 0;
+}
+
+void GlGpuProfiler::PrintReport()
+{
+    printf("GPU pass times (ms, last %d frames):   min       avg       p99\n", WindowSize);
+    for (int i = 0; i < GetNumPasses(); i++) {
+        printf("  %-24s %6d %9.4f %9.4f %9.4f\n",
+            GetPassName(i), GetNumSamples(i), GetMinMs(i), GetAvgMs(i), GetP99Ms(i));
+    }
+    if (numDroppedFrames > 0) {
+        printf("  (%lld frames dropped: their results were not ready)\n", numDroppedFrames);
+    }
+}
+
+bool GlGpuProfiler::DumpCSV(const char* filename)
+{
+    FILE* fp = fopen(filename, "w");
+    if (fp == nullptr) {
+        printf("Unable to open file %s for writing.\n", filename);
+        return false;
+    }
+    fprintf(fp, "pass,samples,last_ms,min_ms,avg_ms,p99_ms\n");
+    for (int i = 0; i < GetNumPasses(); i++) {
+        fprintf(fp, "%s,%d,%.6f,%.6f,%.6f,%.6f\n",
+            GetPassName(i), GetNumSamples(i), GetLastMs(i), GetMinMs(i), GetAvgMs(i), GetP99Ms(i));
+    }
+    fclose(fp);
+    return true;
+}
+
+bool GlGpuProfiler::DumpJSON(const char* filename)
+{
+    FILE* fp = fopen(filename, "w");
+    if (fp == nullptr) {
+        printf("Unable to open file %s for writing.\n", filename);
+        return false;
+    }
+    fprintf(fp, "{\n  \"droppedFrames\": %lld,\n  \"passes\": [\n", numDroppedFrames);
+    for (int i = 0; i < GetNumPasses(); i++) {
+        fprintf(fp, "    { \"pass\": \"%s\", \"samples\": %d, \"lastMs\": %.6f, \"minMs\": %.6f, \"avgMs\": %.6f, \"p99Ms\": %.6f }%s\n",
+            GetPassName(i), GetNumSamples(i), GetLastMs(i), GetMinMs(i), GetAvgMs(i), GetP99Ms(i),
+            (i + 1 < GetNumPasses()) ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+    return true;
+}
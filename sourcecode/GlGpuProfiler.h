@@ -0,0 +1,93 @@
+#pragma once
+
+//
+// GlGpuProfiler.h  ---  Header file for GlGpuProfiler.cpp
+//
+//   Measures the GPU time of named render passes with GL_TIME_ELAPSED queries
+//   (core in OpenGL 3.3).
+//
+//   The queries of each frame go into one slot of a ring of FramesInFlight slots.
+//   A slot is read back when it comes around again, FramesInFlight frames later,
+//   and only if all its results are available: the profiler never waits for the GPU.
+//   (If the results are still not available, the slot's samples are dropped.)
+//
+//   For each pass, the last WindowSize samples are kept, giving rolling
+//   min, average and 99th percentile times.
+//
+//   Usage, once per frame:
+//       GlGpuProfiler::BeginFrame();
+//       GlGpuProfiler::BeginPass("Floor");  ... draw ...  GlGpuProfiler::EndPass();
+//       ...
+//       GlGpuProfiler::EndFrame();
+//   GL_TIME_ELAPSED queries cannot be nested, so passes cannot be nested either.
+//
+
+#ifndef GL_GPU_PROFILER_H
+#define GL_GPU_PROFILER_H
+
+#include <string>
+#include <vector>
+
+class GlGpuProfiler {
+
+public:
+    static constexpr int FramesInFlight = 4;        // Frames between issuing a query and reading it back
+    static constexpr int MaxPassesPerFrame = 16;
+    static constexpr int WindowSize = 256;          // Number of samples in the rolling statistics
+
+    // Allocate the query objects.  Call after the OpenGL context is created.
+    static void Initialize();
+    static void SetEnabled(bool enable) { enabled = enable; }
+    static bool IsEnabled() { return enabled; }
+
+    static void BeginFrame();       // Reads back the results of an earlier frame
+    static void EndFrame();
+    static void BeginPass(const char* name);
+    static void EndPass();
+
+    // The passes, in the order they were first seen.  Times are in milliseconds.
+    static int GetNumPasses() { return (int)passes.size(); }
+    static const char* GetPassName(int i) { return passes[i].name.c_str(); }
+    static int GetNumSamples(int i) { return passes[i].numSamples; }
+    static double GetLastMs(int i);
+    static double GetMinMs(int i);
+    static double GetAvgMs(int i);
+    static double GetP99Ms(int i);
+    static long long GetNumDroppedFrames() { return numDroppedFrames; }
+
+    static void ResetStatistics();
+    static void PrintReport();
+    // Write the statistics of all passes.  Return false if the file cannot be written.
+    static bool DumpCSV(const char* filename);
+    static bool DumpJSON(const char* filename);
+
+private:
+    struct Pass {
+        std::string name;
+        double samples[WindowSize];         // Circular buffer of times, in milliseconds
+        int numSamples;                     // Number of valid samples (at most WindowSize)
+        int nextSample;                     // Where the next sample goes
+        double lastMs;
+    };
+    struct FrameSlot {
+        int numQueries;
+        int passOfQuery[MaxPassesPerFrame];
+    };
+
+    static bool enabled;
+    static bool initialized;
+    static std::vector<Pass> passes;
+    static unsigned int queries[FramesInFlight][MaxPassesPerFrame];
+    static FrameSlot slots[FramesInFlight];
+    static int curSlot;
+    static int curPass;                     // The pass being timed, or -1
+    static bool inFrame;
+    static long long numDroppedFrames;
+
+    static int FindPass(const char* name);
+    static void ReadBackSlot(int slot);
+    static void AddSample(int pass, double ms);
+    static std::vector<double> SortedSamples(int i);
+};
+
+#endif // GL_GPU_PROFILER_H
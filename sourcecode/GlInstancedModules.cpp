@@ -0,0 +1,642 @@
+//
+// GlInstancedModules.cpp
+//
+//   Draws repeated modules with instanced rendering.
+//   See GlInstancedModules.h for how the instances are laid out.
+//
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "GlInstancedModules.h"
+#include "GlStateCache.h"
+#include "GlDebugOutput.h"
+#include "WorkerPool.h"
+#include "SoftwareOcclusion.h"
+#include "CpuProfiler.h"
+#include "assert.h"
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+
+void GlInstancedModules::Clear()
+{
+    modules.clear();
+    instancesChanged = true;
+}
+
+int GlInstancedModules::AddModule(int mesh, int pass, phMaterial* material)
+{
+    assert(mesh >= 0);
+    Module newModule;
+    newModule.mesh = mesh;
+    newModule.pass = pass;
+    newModule.material = material;
+    modules.push_back(newModule);
+    instancesChanged = true;
+    return (int)modules.size() - 1;
+}
+
+void GlInstancedModules::AddInstance(int module, const LinearMapR4& modelMatrix, unsigned int texture, int occlusionGroup,
+                                     int pvsObject)
+{
+    GlModuleInstance instance;
+    instance.modelMatrix = modelMatrix;
+    instance.texture = texture;
+    instance.occlusionGroup = occlusionGroup;
+    instance.pvsObject = pvsObject;
+    modules[module].instances.push_back(instance);
+    instancesChanged = true;
+}
+
+void GlInstancedModules::ClearInstances(int module)
+{
+    modules[module].instances.clear();
+    instancesChanged = true;
+}
+
+void GlInstancedModules::InitializeAttribLocations(unsigned int instanceMatrix_loc)
+{
+    assert(geometry != nullptr && geometry->GetVAO() != 0);
+    instanceLoc = instanceMatrix_loc;
+
+    // Generate Vertex Array Object and the instance buffer, if not already done.
+    if (theVAO == 0) {
+        glGenVertexArrays(1, &theVAO);
+        glGenBuffers(1, &theInstanceVBO);
+    }
+
+    GlStateCache::BindVertexArray(theVAO);
+    geometry->BindBuffersToVAO();
+
+    // The model matrix takes four attribute locations, one per column.
+    //    Each column advances once per instance.
+    glBindBuffer(GL_ARRAY_BUFFER, theInstanceVBO);
+    const int stride = FloatsPerInstance * sizeof(float);
+    for (int c = 0; c < 4; c++) {
+        glVertexAttribPointer(instanceLoc + c, 4, GL_FLOAT, GL_FALSE, stride, (void*)(4 * c * sizeof(float)));
+        glEnableVertexAttribArray(instanceLoc + c);
+        glVertexAttribDivisor(instanceLoc + c, 1);
+    }
+    GlDebugOutput::LabelObject(GL_VERTEX_ARRAY, theVAO, "GlInstancedModules VAO");
+    GlDebugOutput::LabelObject(GL_BUFFER, theInstanceVBO, "GlInstancedModules instance VBO");
+
+    // Good practice to unbind things: helps with debugging if nothing else
+    GlStateCache::BindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    instanceBufferLoaded = false;
+}
+
+// Sort the instances by module and texture, and find the runs of instances
+//    that can be drawn together.
+// With occlusion queries, the instances are sorted by module, occlusion group
+//    and texture, so each group's runs follow each other.
+void GlInstancedModules::SortInstances()
+{
+    sortedInstances.clear();
+    runs.clear();
+    const bool byGroup = useOcclusionQueries;
+    for (int m = 0; m < (int)modules.size(); m++) {
+        int firstOfModule = (int)sortedInstances.size();
+        for (const GlModuleInstance& instance : modules[m].instances) {
+            sortedInstances.push_back(&instance);
+        }
+        std::stable_sort(sortedInstances.begin() + firstOfModule, sortedInstances.end(),
+            [byGroup](const GlModuleInstance* a, const GlModuleInstance* b) {
+                if (byGroup && a->occlusionGroup != b->occlusionGroup) {
+                    return a->occlusionGroup < b->occlusionGroup;
+                }
+                return a->texture < b->texture; });
+        for (int i = firstOfModule; i < (int)sortedInstances.size(); i++) {
+            if (i == firstOfModule || sortedInstances[i]->texture != runs.back().texture
+                || (byGroup && sortedInstances[i]->occlusionGroup != sortedInstances[i - 1]->occlusionGroup)) {
+                InstanceRun newRun;
+                newRun.module = m;
+                newRun.texture = sortedInstances[i]->texture;
+                newRun.firstInstance = i;
+                newRun.numInstances = 0;
+                newRun.group = -1;
+                runs.push_back(newRun);
+            }
+            runs.back().numInstances++;
+        }
+    }
+    instanceMeshes.resize(sortedInstances.size());
+    for (const InstanceRun& run : runs) {
+        std::fill(instanceMeshes.begin() + run.firstInstance,
+                  instanceMeshes.begin() + run.firstInstance + run.numInstances, modules[run.module].mesh);
+    }
+    // The instances do not move, so their bounding boxes are found once.
+    instanceBoxes.Resize((int)sortedInstances.size());
+    for (int i = 0; i < (int)sortedInstances.size(); i++) {
+        const GlMeshBounds& bounds = geometry->GetMeshBounds(instanceMeshes[i]);
+        instanceBoxes.Set(i, sortedInstances[i]->modelMatrix, bounds.boxMin, bounds.boxMax);
+    }
+    FindOcclusionGroups();
+    instancesChanged = false;
+    stagingValid = false;
+}
+
+// **********************************************
+// Cull the instances and stage the matrices of the visible instances.
+// First the workers test each instance's bounding box against the frustum
+//    (four at a time, see GlFrustum::BoxesVisible), counting the
+//    visible instances in each chunk (and noting if they changed).
+// Then the chunks' places in the staged matrices are found, and the workers
+//    copy the visible instances' matrices there, keeping their order, so the
+//    visible instances of each run are packed together.
+// For instancing, the staged model matrices do not depend on the view: if no
+//    instance became visible or hidden, they are left as they are.
+// **********************************************
+void GlInstancedModules::BuildPackets(const LinearMapR4& viewMatrix, const GlFrustum* frustum, bool forInstancing,
+                                      const SoftwareOcclusion* occlusion, const unsigned char* pvsRow)
+{
+    CpuProfileZone zone("GlInstancedModules::BuildPackets");
+    assert(geometry != nullptr);
+    if (instancesChanged) {
+        SortInstances();
+    }
+    for (OcclusionGroup& group : occlusionGroups) {
+        group.mode = DrawNormally;      // Until RenderOcclusionQueries
+    }
+    int numInstances = (int)sortedInstances.size();
+    int numChunks = WorkerPool::NumChunks(numInstances, PacketGrainSize);
+    if ((int)instanceVisible.size() != numInstances) {
+        instanceVisible.assign(numInstances, 0);
+        stagingValid = false;
+    }
+    chunkNumVisible.resize(numChunks);
+    chunkFirstVisible.resize(numChunks);
+    chunkChanged.resize(numChunks);
+    chunkNumOccluded.assign(numChunks, 0);
+    instanceTested.resize(numInstances);
+    viewMatrix.DumpByColumns(viewEntries);
+
+    WorkerPool::ParallelFor(numInstances, PacketGrainSize, [&](int begin, int end) {
+        CpuProfileZone chunkZone("Instance culling");
+        int numVisible = 0;
+        bool changed = false;
+        if (frustum != nullptr) {
+            frustum->BoxesVisible(instanceBoxes, begin, end, instanceTested.data());
+        }
+        else {
+            std::fill(instanceTested.begin() + begin, instanceTested.begin() + end, (unsigned char)1);
+        }
+        if (pvsRow != nullptr) {
+            for (int i = begin; i < end; i++) {
+                int object = sortedInstances[i]->pvsObject;
+                if (object >= 0) {
+                    instanceTested[i] &= (pvsRow[object >> 3] >> (object & 7)) & 1;
+                }
+            }
+        }
+        int chunk = begin / PacketGrainSize;
+        if (occlusion != nullptr) {
+            chunkNumOccluded[chunk] = occlusion->BoxesVisible(instanceBoxes, begin, end, instanceTested.data());
+        }
+        for (int i = begin; i < end; i++) {
+            unsigned char visible = instanceTested[i];
+            changed = changed || (instanceVisible[i] != visible);
+            instanceVisible[i] = visible;
+            numVisible += visible;
+        }
+        chunkNumVisible[chunk] = numVisible;
+        chunkChanged[chunk] = changed;
+    });
+
+    int totalVisible = 0;
+    bool anyChanged = false;
+    for (int c = 0; c < numChunks; c++) {
+        chunkFirstVisible[c] = totalVisible;
+        totalVisible += chunkNumVisible[c];
+        anyChanged = anyChanged || chunkChanged[c];
+    }
+    numInstancesCulled = numInstances - totalVisible;
+    numInstancesOccluded = 0;
+    for (int numOccluded : chunkNumOccluded) {
+        numInstancesOccluded += numOccluded;
+    }
+    for (InstanceRun& run : runs) {
+        run.firstVisible = CountVisibleBefore(run.firstInstance);
+        run.numVisible = CountVisibleBefore(run.firstInstance + run.numInstances) - run.firstVisible;
+    }
+
+    if (forInstancing && stagedForInstancing && stagingValid && !anyChanged) {
+        return;     // The staged model matrices (and the instance buffer) are still right
+    }
+    stagedMatrices.resize((size_t)totalVisible * FloatsPerInstance);
+    WorkerPool::ParallelFor(numInstances, PacketGrainSize, [&](int begin, int end) {
+        CpuProfileZone chunkZone("Instance staging");
+        float* dest = stagedMatrices.data() + (size_t)chunkFirstVisible[begin / PacketGrainSize] * FloatsPerInstance;
+        for (int i = begin; i < end; i++) {
+            if (!instanceVisible[i]) {
+                continue;
+            }
+            if (forInstancing) {
+                sortedInstances[i]->modelMatrix.DumpByColumns(dest);
+            }
+            else {
+                (viewMatrix * sortedInstances[i]->modelMatrix).DumpByColumns(dest);
+            }
+            dest += FloatsPerInstance;
+        }
+    });
+    stagedForInstancing = forInstancing;
+    stagingValid = true;
+    instanceBufferLoaded = false;
+}
+
+// The number of visible instances before the instance (in sortedInstances).
+int GlInstancedModules::CountVisibleBefore(int instance) const
+{
+    int chunk = instance / PacketGrainSize;
+    if (chunk >= (int)chunkFirstVisible.size()) {
+        return chunkFirstVisible.empty() ? 0 : chunkFirstVisible.back() + chunkNumVisible.back();
+    }
+    int count = chunkFirstVisible[chunk];
+    for (int i = chunk * PacketGrainSize; i < instance; i++) {
+        count += instanceVisible[i];
+    }
+    return count;
+}
+
+// **********************************************
+// Render with the instanced shader program.
+// The modelview matrix uniform is loaded once with the view matrix;
+//    the model matrices come from the instance buffer, which is reloaded
+//    from the staged matrices when they have changed.
+// Each run is drawn with one instanced draw call.  The instance attributes
+//    are pointed at the run's first visible instance (base instances need OpenGL 4.2).
+// For depthOnly, the materials and textures are ignored.
+// **********************************************
+void GlInstancedModules::RenderInstancedRuns(unsigned int shaderProgram, int firstPass, int lastPass, bool depthOnly)
+{
+    assert(theVAO != 0);
+    assert(stagingValid && stagedForInstancing && "BuildPackets(..., true) must be called first");
+    numDrawCalls = 0;
+    numInstancesDrawn = 0;
+    numTrianglesDrawn = 0;
+
+    GlStateCache::UseProgram(shaderProgram);
+    unsigned int modelviewLoc = phGetModelviewMatLoc(shaderProgram);
+    unsigned int applyTextureLoc = phGetApplyTextureLoc(shaderProgram);
+    GlStateCache::UniformMatrix4fv(modelviewLoc, viewEntries);
+
+    GlStateCache::BindVertexArray(theVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, theInstanceVBO);
+    if (!instanceBufferLoaded) {
+        glBufferData(GL_ARRAY_BUFFER, stagedMatrices.size() * sizeof(float), stagedMatrices.data(), GL_DYNAMIC_DRAW);
+        instanceBufferLoaded = true;
+    }
+    const phMaterial* curMaterial = nullptr;
+    unsigned int curTexture = 0;
+    bool curApplyTexture = false;
+    int activeGroup = -1;           // The occlusion group whose query or conditional render is open
+    const int stride = FloatsPerInstance * sizeof(float);
+
+    for (const InstanceRun& run : runs) {
+        const Module& module = modules[run.module];
+        if (module.pass < firstPass || module.pass > lastPass || run.numVisible == 0) {
+            continue;
+        }
+        if (!depthOnly && run.group != activeGroup) {
+            EndOcclusionGroup(activeGroup);
+            BeginOcclusionGroup(run.group);
+            activeGroup = run.group;
+        }
+        if (!depthOnly && module.material != curMaterial) {
+            module.material->LoadIntoShaders();
+            curMaterial = module.material;
+        }
+        bool applyTexture = (!depthOnly && run.texture != 0);
+        if (applyTexture && run.texture != curTexture) {
+            GlStateCache::BindTexture2D(run.texture);
+            curTexture = run.texture;
+        }
+        if (applyTexture != curApplyTexture) {
+            GlStateCache::Uniform1i(applyTextureLoc, applyTexture);
+            curApplyTexture = applyTexture;
+        }
+        for (int c = 0; c < 4; c++) {
+            size_t offset = ((size_t)run.firstVisible * FloatsPerInstance + 4 * c) * sizeof(float);
+            glVertexAttribPointer(instanceLoc + c, 4, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+        }
+        const GlMeshRange& range = geometry->GetMesh(module.mesh);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, range.numIndices, GL_UNSIGNED_INT,
+            (void*)(range.firstIndex * sizeof(unsigned int)), run.numVisible, range.baseVertex);
+        numDrawCalls++;
+        GlStateCache::CountDraw(GL_TRIANGLES, range.numIndices, run.numVisible);
+        numInstancesDrawn += run.numVisible;
+        numTrianglesDrawn += run.numVisible * (range.numIndices / 3);
+    }
+    EndOcclusionGroup(activeGroup);
+
+    if (curApplyTexture) {
+        GlStateCache::Uniform1i(applyTextureLoc, false);           // Turn off applying texture!
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GlDebugOutput::CheckHotPath("GlInstancedModules::RenderInstanced");
+}
+
+void GlInstancedModules::RenderDepth(unsigned int depthProgram, int firstPass, int lastPass)
+{
+    if (stagedForInstancing) {
+        RenderInstancedRuns(depthProgram, firstPass, lastPass, true);
+    }
+    else {
+        RenderOneByOneRuns(depthProgram, firstPass, lastPass, true);
+    }
+}
+
+// **********************************************
+// Render without instancing: one draw call per visible instance, from the geometry's VAO,
+//    with the modelview matrices staged by BuildPackets.
+// Used when the instanced shader program is not available.
+// **********************************************
+void GlInstancedModules::RenderOneByOneRuns(unsigned int shaderProgram, int firstPass, int lastPass, bool depthOnly)
+{
+    assert(geometry != nullptr && geometry->GetVAO() != 0);
+    assert(stagingValid && !stagedForInstancing && "BuildPackets(..., false) must be called first");
+    numDrawCalls = 0;
+    numInstancesDrawn = 0;
+    numTrianglesDrawn = 0;
+
+    GlStateCache::UseProgram(shaderProgram);
+    unsigned int modelviewLoc = phGetModelviewMatLoc(shaderProgram);
+    unsigned int applyTextureLoc = phGetApplyTextureLoc(shaderProgram);
+
+    GlStateCache::BindVertexArray(geometry->GetVAO());
+    const phMaterial* curMaterial = nullptr;
+    unsigned int curTexture = 0;
+    bool curApplyTexture = false;
+    int activeGroup = -1;           // The occlusion group whose query or conditional render is open
+
+    for (const InstanceRun& run : runs) {
+        const Module& module = modules[run.module];
+        if (module.pass < firstPass || module.pass > lastPass || run.numVisible == 0) {
+            continue;
+        }
+        if (!depthOnly && run.group != activeGroup) {
+            EndOcclusionGroup(activeGroup);
+            BeginOcclusionGroup(run.group);
+            activeGroup = run.group;
+        }
+        if (!depthOnly && module.material != curMaterial) {
+            module.material->LoadIntoShaders();
+            curMaterial = module.material;
+        }
+        bool applyTexture = (!depthOnly && run.texture != 0);
+        if (applyTexture && run.texture != curTexture) {
+            GlStateCache::BindTexture2D(run.texture);
+            curTexture = run.texture;
+        }
+        if (applyTexture != curApplyTexture) {
+            GlStateCache::Uniform1i(applyTextureLoc, applyTexture);
+            curApplyTexture = applyTexture;
+        }
+        const GlMeshRange& range = geometry->GetMesh(module.mesh);
+        const float* modelview = stagedMatrices.data() + (size_t)run.firstVisible * FloatsPerInstance;
+        for (int i = 0; i < run.numVisible; i++, modelview += FloatsPerInstance) {
+            GlStateCache::UniformMatrix4fv(modelviewLoc, modelview);
+            glDrawElementsBaseVertex(GL_TRIANGLES, range.numIndices, GL_UNSIGNED_INT,
+                (void*)(range.firstIndex * sizeof(unsigned int)), range.baseVertex);
+            numDrawCalls++;
+            GlStateCache::CountDraw(GL_TRIANGLES, range.numIndices);
+        }
+        numInstancesDrawn += run.numVisible;
+        numTrianglesDrawn += run.numVisible * (range.numIndices / 3);
+    }
+    EndOcclusionGroup(activeGroup);
+
+    if (curApplyTexture) {
+        GlStateCache::Uniform1i(applyTextureLoc, false);           // Turn off applying texture!
+    }
+    GlDebugOutput::CheckHotPath("GlInstancedModules::RenderOneByOne");
+}
+
+// **********************************************
+// Occlusion queries
+// **********************************************
+void GlInstancedModules::SetOcclusionQueries(bool useQueries)
+{
+    if (useQueries != useOcclusionQueries) {
+        useOcclusionQueries = useQueries;
+        instancesChanged = true;        // The runs are split by occlusion group, or not
+    }
+}
+
+// GL_ANY_SAMPLES_PASSED_CONSERVATIVE lets the GPU answer from its coarse depth
+//    tests (OpenGL 4.3 or ARB_ES3_compatibility).
+unsigned int GlInstancedModules::OcclusionQueryTarget()
+{
+    return (GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility) ? GL_ANY_SAMPLES_PASSED_CONSERVATIVE : GL_ANY_SAMPLES_PASSED;
+}
+
+// Each run of consecutive runs of one module with the same occlusion group becomes a group.
+//    The group's box is the box around its instances' boxes.
+void GlInstancedModules::FindOcclusionGroups()
+{
+    occlusionGroups.clear();
+    if (!useOcclusionQueries) {
+        return;
+    }
+    for (int r = 0; r < (int)runs.size(); r++) {
+        InstanceRun& run = runs[r];
+        int instanceGroup = sortedInstances[run.firstInstance]->occlusionGroup;
+        if (instanceGroup < 0) {
+            continue;
+        }
+        const InstanceRun* prevRun = (r > 0) ? &runs[r - 1] : nullptr;
+        if (prevRun == nullptr || prevRun->group < 0 || prevRun->module != run.module
+            || sortedInstances[prevRun->firstInstance]->occlusionGroup != instanceGroup) {
+            OcclusionGroup newGroup;
+            newGroup.firstRun = r;
+            newGroup.numRuns = 0;
+            for (int k = 0; k < 3; k++) {
+                newGroup.boxMin[k] = FLT_MAX;
+                newGroup.boxMax[k] = -FLT_MAX;
+            }
+            newGroup.queryIssued = false;
+            newGroup.mode = DrawNormally;
+            occlusionGroups.push_back(newGroup);
+        }
+        OcclusionGroup& group = occlusionGroups.back();
+        group.numRuns++;
+        run.group = (int)occlusionGroups.size() - 1;
+        for (int i = run.firstInstance; i < run.firstInstance + run.numInstances; i++) {
+            const float center[3] = { instanceBoxes.centerX[i], instanceBoxes.centerY[i], instanceBoxes.centerZ[i] };
+            const float extent[3] = { instanceBoxes.extentX[i], instanceBoxes.extentY[i], instanceBoxes.extentZ[i] };
+            for (int k = 0; k < 3; k++) {
+                group.boxMin[k] = std::min(group.boxMin[k], center[k] - extent[k]);
+                group.boxMax[k] = std::max(group.boxMax[k], center[k] + extent[k]);
+            }
+        }
+    }
+}
+
+// Does any part of the box lie outside the plane?  (For the near plane: is the box cut by it?)
+static bool BoxCrossesPlane(const float* plane, const float boxMin[3], const float boxMax[3])
+{
+    float dist = plane[3], reach = 0.0f;
+    for (int k = 0; k < 3; k++) {
+        dist += plane[k] * 0.5f * (boxMin[k] + boxMax[k]);
+        reach += fabsf(plane[k]) * 0.5f * (boxMax[k] - boxMin[k]);
+    }
+    return dist - reach < 0.0f;
+}
+
+// **********************************************
+// Decide how each group is drawn in this frame, from its last query result.
+//    A result that is not available yet is not waited for: the group is drawn.
+// The boxes are drawn with color and depth writes off, so they only count samples.
+// **********************************************
+void GlInstancedModules::RenderOcclusionQueries(unsigned int boxProgram, const GlFrustum& frustum, int firstPass, int lastPass)
+{
+    numGroupsHidden = 0;
+    numGroupsDrawn = 0;
+    if (!useOcclusionQueries || occlusionGroups.empty()) {
+        return;
+    }
+    if (boxVAO == 0) {
+        static const float boxVerts[8 * 3] = {
+            -1, -1, -1,   1, -1, -1,   -1, 1, -1,   1, 1, -1,
+            -1, -1,  1,   1, -1,  1,   -1, 1,  1,   1, 1,  1 };
+        static const unsigned int boxElts[36] = {
+            1, 3, 7,  1, 7, 5,   0, 4, 6,  0, 6, 2,   2, 6, 7,  2, 7, 3,
+            0, 1, 5,  0, 5, 4,   4, 5, 7,  4, 7, 6,   0, 2, 3,  0, 3, 1 };
+        glGenVertexArrays(1, &boxVAO);
+        glGenBuffers(2, boxBuffers);
+        GlStateCache::BindVertexArray(boxVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, boxBuffers[0]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(boxVerts), boxVerts, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, boxBuffers[1]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(boxElts), boxElts, GL_STATIC_DRAW);
+        GlDebugOutput::LabelObject(GL_VERTEX_ARRAY, boxVAO, "GlInstancedModules occlusion box VAO");
+        GlStateCache::BindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    if (occlusionQueries.size() < occlusionGroups.size()) {
+        size_t numOld = occlusionQueries.size();
+        occlusionQueries.resize(occlusionGroups.size());
+        glGenQueries((GLsizei)(occlusionQueries.size() - numOld), occlusionQueries.data() + numOld);
+    }
+
+    const unsigned int target = OcclusionQueryTarget();
+    const float* nearPlane = frustum.GetPlane(4);
+    bool drawingBoxes = false;
+    unsigned int modelviewLoc = 0;
+    for (int g = 0; g < (int)occlusionGroups.size(); g++) {
+        OcclusionGroup& group = occlusionGroups[g];
+        const Module& module = modules[runs[group.firstRun].module];
+        if (module.pass < firstPass || module.pass > lastPass) {
+            continue;
+        }
+        bool visible = true;
+        if (group.queryIssued) {
+            GLint available = 0;
+            glGetQueryObjectiv(occlusionQueries[g], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint anySamples = 0;
+                glGetQueryObjectuiv(occlusionQueries[g], GL_QUERY_RESULT, &anySamples);
+                visible = (anySamples != 0);
+            }
+        }
+        int numVisible = 0;
+        for (int r = group.firstRun; r < group.firstRun + group.numRuns; r++) {
+            numVisible += runs[r].numVisible;
+        }
+        if (numVisible == 0) {
+            group.mode = DrawNormally;      // Culled by the frustum: there is nothing to draw
+            group.queryIssued = false;
+            continue;
+        }
+        if (visible || BoxCrossesPlane(nearPlane, group.boxMin, group.boxMax)) {
+            group.mode = DrawInQuery;       // The query is issued when the group is drawn
+            numGroupsDrawn++;
+            continue;
+        }
+        if (!drawingBoxes) {
+            GlStateCache::UseProgram(boxProgram);
+            modelviewLoc = phGetModelviewMatLoc(boxProgram);
+            GlStateCache::BindVertexArray(boxVAO);
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            glDepthMask(GL_FALSE);
+            drawingBoxes = true;
+        }
+        // The modelview matrix takes the unit box to the group's box: view matrix * translate * scale.
+        float boxModelview[16];
+        float center[3], extent[3];
+        for (int k = 0; k < 3; k++) {
+            center[k] = 0.5f * (group.boxMin[k] + group.boxMax[k]);
+            extent[k] = 0.5f * (group.boxMax[k] - group.boxMin[k]);
+        }
+        for (int row = 0; row < 4; row++) {
+            for (int col = 0; col < 3; col++) {
+                boxModelview[4 * col + row] = viewEntries[4 * col + row] * extent[col];
+            }
+            boxModelview[12 + row] = viewEntries[row] * center[0] + viewEntries[4 + row] * center[1]
+                                   + viewEntries[8 + row] * center[2] + viewEntries[12 + row];
+        }
+        GlStateCache::UniformMatrix4fv(modelviewLoc, boxModelview);
+        glBeginQuery(target, occlusionQueries[g]);
+        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, (void*)0);
+        glEndQuery(target);
+        GlStateCache::CountDraw(GL_TRIANGLES, 36);
+        group.queryIssued = true;
+        group.mode = DrawIfBoxVisible;
+        numGroupsHidden++;
+    }
+    if (drawingBoxes) {
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthMask(GL_TRUE);
+    }
+}
+
+void GlInstancedModules::BeginOcclusionGroup(int group)
+{
+    if (group < 0) {
+        return;
+    }
+    OcclusionGroup& theGroup = occlusionGroups[group];
+    if (theGroup.mode == DrawInQuery) {
+        glBeginQuery(OcclusionQueryTarget(), occlusionQueries[group]);
+        theGroup.queryIssued = true;
+    }
+    else if (theGroup.mode == DrawIfBoxVisible) {
+        glBeginConditionalRender(occlusionQueries[group], GL_QUERY_NO_WAIT);
+    }
+}
+
+void GlInstancedModules::EndOcclusionGroup(int group)
+{
+    if (group < 0) {
+        return;
+    }
+    if (occlusionGroups[group].mode == DrawInQuery) {
+        glEndQuery(OcclusionQueryTarget());
+    }
+    else if (occlusionGroups[group].mode == DrawIfBoxVisible) {
+        glEndConditionalRender();
+    }
+}
+
+GlInstancedModules::~GlInstancedModules()
+{
+    if (theVAO != 0) {
+        glDeleteVertexArrays(1, &theVAO);
+        glDeleteBuffers(1, &theInstanceVBO);
+    }
+    if (boxVAO != 0) {
+        glDeleteVertexArrays(1, &boxVAO);
+        glDeleteBuffers(2, boxBuffers);
+    }
+    if (!occlusionQueries.empty()) {
+        glDeleteQueries((GLsizei)occlusionQueries.size(), occlusionQueries.data());
+    }
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+//
+// GlInstancedModules.h  ---  Header file for GlInstancedModules.cpp
+//
+//   Draws repeated modules (e.g., crates) with instanced rendering.
+//   A module is one mesh in a GlStaticGeometry, modeled once.
+//   Each instance of a module gives a model matrix and a texture.
+//   The instances are sorted by module and then by texture, and each run of
+//   instances with the same module and texture is drawn with one
+//   glDrawElementsInstancedBaseVertex.
+//
+//   Rendering is in two steps.  BuildPackets does the per-instance work on the
+//   worker threads (see WorkerPool.h): frustum culling, and staging the matrices
+//   of the visible instances, packed run by run.  The render functions then only
+//   make OpenGL calls.  For instancing the staged matrices are the model
+//   matrices, which are uploaded to the instance buffer only when the set of
+//   visible instances changes; for drawing one by one they are the modelview matrices.
+//
+//   Occlusion queries (optional): instances may be given an occlusion group,
+//   and each group is tested as a whole.  A group that was hidden in the last
+//   frame is tested by drawing its bounding box (depth test only) inside an
+//   occlusion query, and its draws are made conditional on the query with
+//   glBeginConditionalRender, so the GPU skips them if no sample of the box
+//   passed.  A group that was visible is drawn inside its query, which tells
+//   the next frame if it is still visible.  The results are read a frame later,
+//   and only if they are available, so the CPU never waits for the GPU.
+//
+//   The instanced vertex shader reads the model matrix as a mat4 vertex
+//   attribute (four locations, starting at the location given to
+//   InitializeAttribLocations) and multiplies it by the modelviewMatrix uniform,
+//   which holds the view matrix.
+//
+
+#ifndef GL_INSTANCED_MODULES_H
+#define GL_INSTANCED_MODULES_H
+
+#include <limits.h>
+#include <vector>
+
+#include "LinearR4.h"
+#include "EduPhong.h"
+#include "GlStaticGeometry.h"
+#include "GlFrustum.h"
+
+class SoftwareOcclusion;
+
+// GlModuleInstance
+//    One copy of a module.
+struct GlModuleInstance {
+    LinearMapR4 modelMatrix;        // Places the module in the scene
+    unsigned int texture;           // OpenGL texture name, or 0 for no texture
+    int occlusionGroup;             // Instances of a module with the same group are occlusion tested together (-1 for none)
+    int pvsObject;                  // The instance's object in the potentially visible set (-1 for none)
+};
+
+class GlInstancedModules
+{
+public:
+    static constexpr int FloatsPerInstance = 16;    // The model matrix, by columns
+
+    GlInstancedModules() {}
+    ~GlInstancedModules();
+
+    // Disable all copy and assignment operators (the object owns OpenGL buffers).
+    GlInstancedModules(const GlInstancedModules&) = delete;
+    GlInstancedModules& operator=(const GlInstancedModules&) = delete;
+
+    // All modules are meshes in this geometry (must be loaded before InitializeAttribLocations).
+    void SetGeometry(const GlStaticGeometry* theGeometry) { geometry = theGeometry; }
+
+    // Building the modules and their instances.
+    //   Instances may be added and removed at any time; the instance buffer
+    //   is reloaded before the next render.
+    void Clear();
+    int AddModule(int mesh, int pass, phMaterial* material);    // Returns the index of the module
+    int GetNumModules() const { return (int)modules.size(); }
+    void AddInstance(int module, const LinearMapR4& modelMatrix, unsigned int texture, int occlusionGroup = -1,
+                     int pvsObject = -1);
+    void ClearInstances(int module);
+    int GetNumInstances(int module) const { return (int)modules[module].instances.size(); }
+    const GlModuleInstance& GetInstance(int module, int i) const { return modules[module].instances[i]; }
+
+    // Allocate the VAO and the instance buffer.
+    //   The VAO has the geometry's vertex attributes, plus the model matrix
+    //   in locations instanceMatrix_loc through instanceMatrix_loc+3.
+    void InitializeAttribLocations(unsigned int instanceMatrix_loc);
+
+    // Cull the instances and stage the matrices of the visible ones, for all passes.
+    //   Call once per frame, before rendering.  If frustum is null, nothing is culled.
+    //   forInstancing selects RenderInstanced (model matrices) or RenderOneByOne (modelview matrices).
+    //   If occlusion is not null, instances it finds hidden are culled (it must have been rendered for this view).
+    //   If pvsRow is not null, an instance with a pvsObject is culled unless the object's bit in the row is set.
+    //   Makes no OpenGL calls.
+    void BuildPackets(const LinearMapR4& viewMatrix, const GlFrustum* frustum, bool forInstancing,
+                      const SoftwareOcclusion* occlusion = nullptr, const unsigned char* pvsRow = nullptr);
+
+    // Render the visible instances of modules in passes firstPass through lastPass.
+    //   RenderInstanced needs the instanced shader program.
+    //   RenderOneByOne works with any shader program registered with
+    //      phRegisterShaderProgram, drawing each instance with its own modelview matrix.
+    // The shader program and the VAO are left bound, and applying textures is left turned off.
+    // All state changes go through GlStateCache.
+    void RenderInstanced(unsigned int shaderProgram, int firstPass = 0, int lastPass = INT_MAX)
+        { RenderInstancedRuns(shaderProgram, firstPass, lastPass, false); }
+    void RenderOneByOne(unsigned int shaderProgram, int firstPass = 0, int lastPass = INT_MAX)
+        { RenderOneByOneRuns(shaderProgram, firstPass, lastPass, false); }
+
+    // Render only the depth, for a depth pre-pass: no materials and no textures.
+    //   The depth-only program takes the same matrices as the program for the
+    //   rendering chosen by BuildPackets (instanced or one by one).
+    void RenderDepth(unsigned int depthProgram, int firstPass = 0, int lastPass = INT_MAX);
+
+    // Occlusion queries for the instances' occlusion groups.
+    //   With them on, each group is drawn in its own runs (instead of runs of all instances with the same texture).
+    void SetOcclusionQueries(bool useQueries);
+    bool GetOcclusionQueries() const { return useOcclusionQueries; }
+    // Read the last results and draw the bounding boxes of the groups that were hidden, with the box program
+    //   (it reads the position at location 0, and takes the modelview matrix as a uniform).
+    //   Call after BuildPackets and after the occluders have been drawn, and before rendering the passes.
+    //   Groups whose box is cut by the frustum's near plane are not tested (they are drawn in their queries).
+    //   Leaves the color and depth writes on.
+    void RenderOcclusionQueries(unsigned int boxProgram, const GlFrustum& frustum, int firstPass = 0, int lastPass = INT_MAX);
+
+    // Statistics for the most recent call to BuildPackets()
+    int NumInstancesCulled() const { return numInstancesCulled; }       // Including the occluded instances
+    int NumInstancesOccluded() const { return numInstancesOccluded; }
+
+    // Statistics for the most recent call to RenderOcclusionQueries()
+    int NumGroupsHidden() const { return numGroupsHidden; }     // Hidden in the last results: tested with their boxes
+    int NumGroupsDrawn() const { return numGroupsDrawn; }       // Visible in the last results (or not known): drawn
+
+    // Statistics for the most recent render
+    int NumDrawCalls() const { return numDrawCalls; }
+    int NumInstancesDrawn() const { return numInstancesDrawn; }
+    int NumTrianglesDrawn() const { return numTrianglesDrawn; }
+
+private:
+    void RenderInstancedRuns(unsigned int shaderProgram, int firstPass, int lastPass, bool depthOnly);
+    void RenderOneByOneRuns(unsigned int shaderProgram, int firstPass, int lastPass, bool depthOnly);
+
+    struct Module {
+        int mesh;                   // Index of the mesh in the geometry
+        int pass;                   // Render pass
+        phMaterial* material;       // Material (underlying the texture)
+        std::vector<GlModuleInstance> instances;
+    };
+    // A run of instances of one module with the same texture.
+    struct InstanceRun {
+        int module;
+        unsigned int texture;
+        int firstInstance;          // Position in sortedInstances
+        int numInstances;
+        int firstVisible;           // Position of its first visible instance in the staged matrices
+        int numVisible;
+        int group;                  // Index in occlusionGroups, or -1
+    };
+
+    std::vector<Module> modules;
+    const GlStaticGeometry* geometry = nullptr;
+
+    // The instances sorted by module and texture, and the runs of instances.
+    std::vector<const GlModuleInstance*> sortedInstances;
+    std::vector<int> instanceMeshes;            // The mesh of each sorted instance
+    GlCullBoxes instanceBoxes;                  // The bounding box of each sorted instance, in world coordinates
+    std::vector<InstanceRun> runs;
+    bool instancesChanged = true;
+    void SortInstances();
+
+    // The occlusion groups: runs firstRun through firstRun+numRuns-1, all of one module.
+    enum OcclusionMode { DrawNormally, DrawInQuery, DrawIfBoxVisible };
+    struct OcclusionGroup {
+        int firstRun;
+        int numRuns;
+        float boxMin[3], boxMax[3];         // The bounding box of the instances, in world coordinates
+        bool queryIssued;                   // Has its query been issued since the instances were sorted?
+        OcclusionMode mode;                 // How the group is drawn in this frame
+    };
+    bool useOcclusionQueries = false;
+    std::vector<OcclusionGroup> occlusionGroups;
+    std::vector<unsigned int> occlusionQueries;     // One query for each group
+    unsigned int boxVAO = 0;                        // The unit box [-1,1]^3, for drawing the groups' bounding boxes
+    unsigned int boxBuffers[2] = { 0, 0 };
+    int numGroupsHidden = 0;
+    int numGroupsDrawn = 0;
+    void FindOcclusionGroups();
+    void BeginOcclusionGroup(int group);
+    void EndOcclusionGroup(int group);
+    static unsigned int OcclusionQueryTarget();
+
+    // Culling and staging, done by the workers in chunks of PacketGrainSize instances
+    static constexpr int PacketGrainSize = 512;
+    std::vector<unsigned char> instanceVisible;
+    std::vector<unsigned char> instanceTested;  // The culling tests of each instance, this frame
+    std::vector<int> chunkNumVisible;           // Visible instances in each chunk
+    std::vector<int> chunkFirstVisible;         // Their position in the staged matrices
+    std::vector<unsigned char> chunkChanged;    // Did the chunk's visible instances change?
+    std::vector<int> chunkNumOccluded;          // Instances occluded in each chunk
+    std::vector<float> stagedMatrices;          // FloatsPerInstance floats per visible instance
+    float viewEntries[16];                      // The view matrix, by columns
+    bool stagedForInstancing = false;
+    bool stagingValid = false;
+    int numInstancesCulled = 0;
+    int numInstancesOccluded = 0;
+    int CountVisibleBefore(int instance) const;
+
+    unsigned int theVAO = 0;            // Vertex Array Object (geometry plus instance attributes)
+    unsigned int theInstanceVBO = 0;    // Per-instance model matrices
+    unsigned int instanceLoc = 0;       // First of the four locations of the model matrix
+    bool instanceBufferLoaded = false;     // Does the instance buffer hold the staged matrices?
+
+    int numDrawCalls = 0;
+    int numInstancesDrawn = 0;
+    int numTrianglesDrawn = 0;
+};
+
+#endif  // GL_INSTANCED_MODULES_H
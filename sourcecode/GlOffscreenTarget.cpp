@@ -0,0 +1,65 @@
+//
+// GlOffscreenTarget.cpp
+//
+//   A framebuffer object for offscreen rendering.
+//   See GlOffscreenTarget.h.
+//
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "GlOffscreenTarget.h"
+#include "GlDebugOutput.h"
+#include <stdio.h>
+
+bool GlOffscreenTarget::Create(int theWidth, int theHeight)
+{
+    if (theFBO == 0) {
+        glGenFramebuffers(1, &theFBO);
+        glGenRenderbuffers(1, &colorRB);
+        glGenRenderbuffers(1, &depthRB);
+    }
+    width = theWidth;
+    height = theHeight;
+
+    glBindRenderbuffer(GL_RENDERBUFFER, colorRB);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRB);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, theFBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRB);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRB);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    GlDebugOutput::LabelObject(GL_FRAMEBUFFER, theFBO, "GlOffscreenTarget FBO");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        printf("Offscreen framebuffer %d x %d is not complete (status 0x%x).\n", width, height, status);
+        return false;
+    }
+    return true;
+}
+
+void GlOffscreenTarget::Bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, theFBO);
+    glViewport(0, 0, width, height);
+}
+
+void GlOffscreenTarget::BindDefault()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+GlOffscreenTarget::~GlOffscreenTarget()
+{
+    if (theFBO != 0) {
+        glDeleteFramebuffers(1, &theFBO);
+        glDeleteRenderbuffers(1, &colorRB);
+        glDeleteRenderbuffers(1, &depthRB);
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+//
+// GlOffscreenTarget.h  ---  Header file for GlOffscreenTarget.cpp
+//
+//   A framebuffer object to render into instead of a window:
+//   an RGBA8 color renderbuffer and a 24 bit depth renderbuffer.
+//   While it is bound, glReadPixels (e.g., RgbImage::LoadFromOpenglBuffer)
+//   reads its color buffer.
+//
+
+#ifndef GL_OFFSCREEN_TARGET_H
+#define GL_OFFSCREEN_TARGET_H
+
+class GlOffscreenTarget {
+
+public:
+    GlOffscreenTarget() {}
+    ~GlOffscreenTarget();
+
+    // Disable all copy and assignment operators (the object owns OpenGL objects).
+    GlOffscreenTarget(const GlOffscreenTarget&) = delete;
+    GlOffscreenTarget& operator=(const GlOffscreenTarget&) = delete;
+
+    // Allocate (or reallocate) the framebuffer at this size.
+    //   Returns false if the framebuffer is not complete.
+    bool Create(int width, int height);
+
+    // Bind for drawing and reading, and set the viewport to the whole target.
+    void Bind() const;
+    static void BindDefault();          // Back to the window (or nothing, when headless)
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    unsigned int GetFBO() const { return theFBO; }
+
+private:
+    unsigned int theFBO = 0;
+    unsigned int colorRB = 0;
+    unsigned int depthRB = 0;
+    int width = 0;
+    int height = 0;
+};
+
+#endif // GL_OFFSCREEN_TARGET_H
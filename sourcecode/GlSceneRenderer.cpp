@@ -0,0 +1,434 @@
+//
+// GlSceneRenderer.cpp
+//
+//   A data-driven renderer for static scene geometry.
+//   See GlSceneRenderer.h for how the scene table is laid out.
+//
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "GlSceneRenderer.h"
+#include "GlStateCache.h"
+#include "GlUniformRing.h"
+#include "GlDebugOutput.h"
+#include "WorkerPool.h"
+#include "SoftwareOcclusion.h"
+#include "CpuProfiler.h"
+#include "assert.h"
+#include <algorithm>
+#include <string.h>
+
+namespace {
+    // The position of the item in the list, adding it to the end if it is not there.
+    template<typename T>
+    unsigned long long KeyIndex(std::vector<T>& list, T item)
+    {
+        size_t i = std::find(list.begin(), list.end(), item) - list.begin();
+        if (i == list.size()) {
+            list.push_back(item);
+        }
+        return i;
+    }
+}
+
+void GlSceneRenderer::Clear()
+{
+    objects.clear();
+    keyTextures.clear();
+    keyMaterials.clear();
+    keyTransforms.clear();
+    objectKeys.clear();
+    objectMaterialIDs.clear();
+    objectBoxes.Resize(0);
+}
+
+int GlSceneRenderer::AddObject(const GlSceneObject& object)
+{
+    objects.push_back(object);
+    objectKeys.push_back(MakeSortKey(object));
+    int materialID = phMaterialRegistry::GetID(object.material);
+    objectMaterialIDs.push_back(materialID >= 0 ? materialID : 0);
+    int index = (int)objects.size() - 1;
+    UpdateObjectBox(index);
+    return index;
+}
+
+// The object's bounding box in world coordinates, from its mesh's box.
+void GlSceneRenderer::UpdateObjectBox(int i)
+{
+    assert(geometry != nullptr);
+    const GlSceneObject& obj = objects[i];
+    const GlMeshBounds& bounds = geometry->GetMeshBounds(obj.mesh);
+    if (objectBoxes.Size() <= i) {
+        objectBoxes.Resize(i + 1);
+    }
+    if (obj.modelMatrix == nullptr) {
+        objectBoxes.Set(i, bounds.boxMin, bounds.boxMax);
+    }
+    else {
+        objectBoxes.Set(i, *obj.modelMatrix, bounds.boxMin, bounds.boxMax);
+    }
+}
+
+// The sort key, from the most to the least significant bits:
+//    pass (8 bits), texture (12 bits), material (10 bits), model matrix (10 bits),
+//    depth (24 bits, filled in each frame by BuildPackets).
+//    Textures, materials and model matrices are numbered in the order they are first seen.
+//    There is one shader program and one VAO per renderer, so they need no bits.
+//    The largest value of each field is kept for objects with more states than the fields hold:
+//    these objects are sorted after the rest of their pass, by depth alone.  (Sorting only
+//    groups the draws; RenderPackets still compares the state itself, so they draw correctly.)
+unsigned long long GlSceneRenderer::MakeSortKey(const GlSceneObject& object)
+{
+    assert(0 <= object.pass && object.pass <= 0xff);
+    unsigned long long textureIndex = KeyIndex(keyTextures, object.texture);
+    unsigned long long materialIndex = KeyIndex<const phMaterial*>(keyMaterials, object.material);
+    unsigned long long transformIndex = KeyIndex(keyTransforms, object.modelMatrix);
+    if (textureIndex >= 0xfff || materialIndex >= 0x3ff || transformIndex >= 0x3ff) {
+        textureIndex = 0xfff;
+        materialIndex = 0x3ff;
+        transformIndex = 0x3ff;
+    }
+    return ((unsigned long long)(object.pass & 0xff) << 56) | ((textureIndex & 0xfff) << 44)
+        | ((materialIndex & 0x3ff) << 34) | ((transformIndex & 0x3ff) << 24);
+}
+
+// The depth bits of the sort key: the distance from the viewer to the nearest
+//    corner of the mesh's bounding box (the same box that is culled), so nearer
+//    objects sort first.  The bits of a non-negative float increase with its value;
+//    the top 24 bits are kept.
+unsigned long long GlSceneRenderer::DepthKey(const float modelview[16], const GlMeshBounds& bounds)
+{
+    // The largest eye-space z of the box's corners: on each axis, take the end that gives the larger z.
+    float z = modelview[14];
+    for (int i = 0; i < 3; i++) {
+        float row = modelview[4 * i + 2];
+        z += row * (row > 0.0f ? bounds.boxMax[i] : bounds.boxMin[i]);
+    }
+    float distance = -z;        // The viewer looks down the negative z-axis
+    if (!(distance > 0.0f)) {
+        distance = 0.0f;
+    }
+    unsigned int bits;
+    memcpy(&bits, &distance, sizeof(bits));
+    return bits >> 8;
+}
+
+// **********************************************
+// Build the draw packets.
+// The workers fill one packet slot per object: the culling tests against
+//    the object's world-space bounding box (in objectBoxes, see GlCullBoxes),
+//    and the modelview matrix.
+// The keys get the depth of the objects.  In ObjectDataArray mode, materials
+//    and transforms do not split the draws, so their bits are cleared and
+//    each texture's objects are simply sorted front to back.
+// The visible packets are then gathered and radix sorted by their keys
+//    (stable, so objects with the same key keep their order in the table).
+// **********************************************
+void GlSceneRenderer::BuildPackets(const LinearMapR4& viewMatrix, const GlFrustum* frustum,
+                                   const SoftwareOcclusion* occlusion, const unsigned char* pvsRow)
+{
+    CpuProfileZone zone("GlSceneRenderer::BuildPackets");
+    assert(geometry != nullptr);
+    int numObjects = (int)objects.size();
+    packetSlots.resize(numObjects);
+    packetVisible.resize(numObjects);
+    chunkNumOccluded.assign(WorkerPool::NumChunks(numObjects, PacketGrainSize), 0);
+    unsigned long long keyMask = (dataMode == ObjectDataArray) ? ~StateKeyMask : ~0ull;
+
+    WorkerPool::ParallelFor(numObjects, PacketGrainSize, [&](int begin, int end) {
+        CpuProfileZone chunkZone("Scene packets");
+        if (frustum != nullptr || occlusion != nullptr) {
+            for (int i = begin; i < end; i++) {
+                if (objects[i].modelMatrix != nullptr) {
+                    UpdateObjectBox(i);         // The model matrix may have changed
+                }
+            }
+        }
+        if (frustum != nullptr) {
+            frustum->BoxesVisible(objectBoxes, begin, end, packetVisible.data());
+        }
+        else {
+            std::fill(packetVisible.begin() + begin, packetVisible.begin() + end, (unsigned char)1);
+        }
+        if (pvsRow != nullptr) {
+            for (int i = begin; i < end; i++) {
+                packetVisible[i] &= (pvsRow[i >> 3] >> (i & 7)) & 1;
+            }
+        }
+        if (occlusion != nullptr) {
+            chunkNumOccluded[begin / PacketGrainSize] = occlusion->BoxesVisible(objectBoxes, begin, end, packetVisible.data());
+        }
+        for (int i = begin; i < end; i++) {
+            if (!packetVisible[i]) {
+                continue;
+            }
+            const GlSceneObject& obj = objects[i];
+            const GlMeshBounds& bounds = geometry->GetMeshBounds(obj.mesh);
+            GlDrawPacket& packet = packetSlots[i];
+            packet.pass = obj.pass;
+            packet.mesh = obj.mesh;
+            packet.texture = obj.texture;
+            packet.material = obj.material;
+            packet.materialID = objectMaterialIDs[i];
+            packet.modelMatrix = obj.modelMatrix;
+            if (obj.modelMatrix == nullptr) {
+                viewMatrix.DumpByColumns(packet.modelview);
+            }
+            else {
+                (viewMatrix * (*obj.modelMatrix)).DumpByColumns(packet.modelview);
+            }
+            packet.sortKey = (objectKeys[i] & keyMask) | DepthKey(packet.modelview, bounds);
+        }
+    });
+
+    sortKeys.clear();
+    sortSlots.clear();
+    for (int i = 0; i < numObjects; i++) {
+        if (packetVisible[i]) {
+            sortKeys.push_back(packetSlots[i].sortKey);
+            sortSlots.push_back(i);
+        }
+    }
+    numObjectsCulled = numObjects - (int)sortSlots.size();
+    numObjectsOccluded = 0;
+    for (int numOccluded : chunkNumOccluded) {
+        numObjectsOccluded += numOccluded;
+    }
+    packetSorter.Sort(sortKeys, sortSlots);
+    packets.clear();
+    for (int slot : sortSlots) {
+        packets.push_back(packetSlots[slot]);
+    }
+}
+
+// **********************************************
+// Render the draw packets.
+// State is only changed when it differs from the previous packet:
+//    the shader program and the VAO are selected once, and the material,
+//    the modelview matrix, the texture and the applyTexture flag are loaded
+//    only when they change.
+// Packets between two state changes are drawn with one (multi-)draw call.
+// For depthOnly, the materials and textures are ignored.
+// In DrawDataBlock mode the shader program has no modelview uniform to fall back on:
+//    if the ring cannot hold the matrices, nothing is drawn and the packets are counted as skipped.
+// **********************************************
+void GlSceneRenderer::RenderPackets(unsigned int shaderProgram, int firstPass, int lastPass, bool depthOnly)
+{
+    assert(geometry != nullptr && geometry->GetVAO() != 0);
+    numDrawCalls = 0;
+    numStateChanges = 0;
+    numObjectsDrawn = 0;
+    numTrianglesDrawn = 0;
+    numObjectsSkipped = 0;
+
+    if (dataMode == ObjectDataArray) {
+        RenderObjectData(shaderProgram, firstPass, lastPass, depthOnly);
+        return;
+    }
+    bool useRing = (dataMode == DrawDataBlock);
+    if (useRing && !LoadDrawData(firstPass, lastPass)) {
+        for (const GlDrawPacket& packet : packets) {
+            if (packet.pass >= firstPass && packet.pass <= lastPass) {
+                numObjectsSkipped++;
+            }
+        }
+        return;
+    }
+    GlStateCache::UseProgram(shaderProgram);
+    unsigned int modelviewLoc = phGetModelviewMatLoc(shaderProgram);
+    unsigned int applyTextureLoc = phGetApplyTextureLoc(shaderProgram);
+    GlStateCache::BindVertexArray(geometry->GetVAO());
+
+    const phMaterial* curMaterial = nullptr;
+    const LinearMapR4* curModelMatrix = nullptr;
+    bool modelviewLoaded = false;
+    unsigned int curTexture = 0;
+    bool curApplyTexture = false;
+
+    for (int i = 0; i < (int)packets.size(); i++) {
+        const GlDrawPacket& packet = packets[i];
+        if (packet.pass < firstPass || packet.pass > lastPass) {
+            continue;
+        }
+        bool applyTexture = (!depthOnly && packet.texture != 0);
+        if (!depthOnly && packet.material != curMaterial) {
+            FlushBatch();
+            packet.material->LoadIntoShaders();
+            curMaterial = packet.material;
+            numStateChanges++;
+        }
+        if (!modelviewLoaded || packet.modelMatrix != curModelMatrix) {
+            FlushBatch();
+            if (useRing) {
+                dataRing->BindRange(DrawDataBinding, drawDataOffsets[i], 16 * sizeof(float));
+            }
+            else {
+                GlStateCache::UniformMatrix4fv(modelviewLoc, packet.modelview);
+            }
+            curModelMatrix = packet.modelMatrix;
+            modelviewLoaded = true;
+            numStateChanges++;
+        }
+        if (applyTexture && packet.texture != curTexture) {
+            FlushBatch();
+            GlStateCache::BindTexture2D(packet.texture);
+            curTexture = packet.texture;
+            numStateChanges++;
+        }
+        if (applyTexture != curApplyTexture) {
+            FlushBatch();
+            GlStateCache::Uniform1i(applyTextureLoc, applyTexture);
+            curApplyTexture = applyTexture;
+            numStateChanges++;
+        }
+        AddToBatch(geometry->GetMesh(packet.mesh));
+    }
+    FlushBatch();
+
+    if (curApplyTexture) {
+        GlStateCache::Uniform1i(applyTextureLoc, false);           // Turn off applying texture!
+    }
+    GlDebugOutput::CheckHotPath("GlSceneRenderer::Render");
+}
+
+// Write one modelview matrix for each run of packets with the same model matrix
+//    straight into the ring.  Returns false if the ring is out of space.
+bool GlSceneRenderer::LoadDrawData(int firstPass, int lastPass)
+{
+    drawDataOffsets.resize(packets.size());
+    const LinearMapR4* curModelMatrix = nullptr;
+    int curOffset = -1;
+    for (int i = 0; i < (int)packets.size(); i++) {
+        const GlDrawPacket& packet = packets[i];
+        if (packet.pass < firstPass || packet.pass > lastPass) {
+            continue;
+        }
+        if (curOffset < 0 || packet.modelMatrix != curModelMatrix) {
+            void* data = dataRing->Allocate(sizeof(packet.modelview), &curOffset);
+            if (data == nullptr) {
+                return false;
+            }
+            memcpy(data, packet.modelview, sizeof(packet.modelview));
+            curModelMatrix = packet.modelMatrix;
+        }
+        drawDataOffsets[i] = curOffset;
+    }
+    dataRing->Flush();
+    return true;
+}
+
+// **********************************************
+// Render the draw packets with the object records in the ring.
+// Each record is the modelview matrix and the material's ID in phMaterialRegistry's table.
+// The packets are split into batches of up to MaxObjectsPerDraw packets
+//    with the same texture (any texture, for depthOnly).  The batch's records are written into the ring
+//    and bound as the phObjectArray block; then the batch is drawn with one
+//    multi-draw, and the shader finds its record with gl_DrawIDARB.
+// A batch that does not fit in the ring is not drawn, and is counted as skipped.
+// **********************************************
+void GlSceneRenderer::RenderObjectData(unsigned int shaderProgram, int firstPass, int lastPass, bool depthOnly)
+{
+    GlStateCache::UseProgram(shaderProgram);
+    unsigned int applyTextureLoc = phGetApplyTextureLoc(shaderProgram);
+    GlStateCache::BindVertexArray(geometry->GetVAO());
+
+    unsigned int curTexture = 0;
+    bool curApplyTexture = false;
+    int numPackets = (int)packets.size();
+    int i = 0;
+    while (i < numPackets) {
+        const GlDrawPacket& first = packets[i];
+        if (first.pass < firstPass || first.pass > lastPass) {
+            i++;
+            continue;
+        }
+        // The batch is packets i through end-1.
+        int end = i + 1;
+        while (end < numPackets && end - i < MaxObjectsPerDraw && (depthOnly || packets[end].texture == first.texture)
+                && packets[end].pass >= firstPass && packets[end].pass <= lastPass) {
+            end++;
+        }
+
+        bool applyTexture = (!depthOnly && first.texture != 0);
+        if (applyTexture && first.texture != curTexture) {
+            GlStateCache::BindTexture2D(first.texture);
+            curTexture = first.texture;
+            numStateChanges++;
+        }
+        if (applyTexture != curApplyTexture) {
+            GlStateCache::Uniform1i(applyTextureLoc, applyTexture);
+            curApplyTexture = applyTexture;
+            numStateChanges++;
+        }
+
+        int offset;
+        ObjectRecord* records = (ObjectRecord*)dataRing->Allocate((end - i) * sizeof(ObjectRecord), &offset);
+        if (records == nullptr) {
+            numObjectsSkipped += end - i;
+            i = end;
+            continue;
+        }
+        for (int k = i; k < end; k++) {
+            const GlDrawPacket& packet = packets[k];
+            ObjectRecord& record = records[k - i];
+            memcpy(record.modelview, packet.modelview, sizeof(record.modelview));
+            record.materialID[0] = packet.materialID;
+            record.materialID[1] = record.materialID[2] = record.materialID[3] = 0;
+            AddToBatch(geometry->GetMesh(packet.mesh));
+        }
+        dataRing->Flush();
+        dataRing->BindRange(ObjectDataBinding, offset, (end - i) * sizeof(ObjectRecord));
+        numStateChanges++;
+        FlushBatch();
+        i = end;
+    }
+
+    if (curApplyTexture) {
+        GlStateCache::Uniform1i(applyTextureLoc, false);           // Turn off applying texture!
+    }
+    GlDebugOutput::CheckHotPath("GlSceneRenderer::Render");
+}
+
+void GlSceneRenderer::SetDataMode(DataMode mode, GlUniformRing* ring)
+{
+    assert(mode == ModelviewUniform || ring != nullptr);
+    dataMode = mode;
+    dataRing = ring;
+}
+
+void GlSceneRenderer::AddToBatch(const GlMeshRange& range)
+{
+    batchCounts.push_back(range.numIndices);
+    batchElements += range.numIndices;
+    batchOffsets.push_back((const void*)(range.firstIndex * sizeof(unsigned int)));
+    batchBaseVertices.push_back(range.baseVertex);
+    numObjectsDrawn++;
+    numTrianglesDrawn += range.numIndices / 3;
+}
+
+// Draw all mesh ranges in the current batch with one draw call.
+void GlSceneRenderer::FlushBatch()
+{
+    int batchSize = (int)batchCounts.size();
+    if (batchSize == 0) {
+        return;
+    }
+    if (batchSize == 1) {
+        glDrawElementsBaseVertex(GL_TRIANGLES, batchCounts[0], GL_UNSIGNED_INT,
+            (void*)batchOffsets[0], batchBaseVertices[0]);
+    }
+    else {
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, batchCounts.data(), GL_UNSIGNED_INT,
+            batchOffsets.data(), batchSize, batchBaseVertices.data());
+    }
+    numDrawCalls++;
+    GlStateCache::CountDraw(GL_TRIANGLES, batchElements);
+    batchElements = 0;
+    batchCounts.clear();
+    batchOffsets.clear();
+    batchBaseVertices.clear();
+}
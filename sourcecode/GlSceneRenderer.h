@@ -0,0 +1,195 @@
+#pragma once
+
+//
+// GlSceneRenderer.h  ---  Header file for GlSceneRenderer.cpp
+//
+//   A data-driven renderer for static scene geometry.
+//   The scene is described by a table of GlSceneObject's (one row per
+//   object: mesh, texture, material and transform).  The meshes all live
+//   in one GlStaticGeometry.
+//
+//   Rendering is in two steps.  BuildPackets does all the per-object work on
+//   the worker threads (see WorkerPool.h): frustum culling (of the objects'
+//   bounding boxes, kept in world coordinates, see GlFrustum.h), the modelview
+//   matrix and a 64-bit sort key for each object.  The visible objects become
+//   a compact array of draw packets, radix sorted by the key (see RadixSort.h).
+//   Render then only makes
+//   OpenGL calls: it walks the packets, changes state when it differs from the
+//   previous packet, and draws each run of packets with the same texture,
+//   material and transform with a single glMultiDrawElementsBaseVertex.
+//
+//   How the per-object data reaches the shaders is set by SetDataMode:
+//     ModelviewUniform: the modelviewMatrix uniform, and the material as
+//         constant vertex attributes (phMaterial::LoadIntoShaders).
+//     DrawDataBlock: the modelview matrix is written into a uniform ring and
+//         bound as the phDrawData block with glBindBufferRange.
+//     ObjectDataArray: the modelview matrix and the material ID of every object
+//         in a batch are written into the ring as the phObjectArray block, and
+//         the shader indexes it with gl_DrawIDARB (ARB_shader_draw_parameters).
+//         The materials are in phMaterialRegistry's table, which must be loaded.
+//         Only texture changes split the batches, so a run of objects with the
+//         same texture, any materials and any transforms is one multi-draw.
+//
+
+#ifndef GL_SCENE_RENDERER_H
+#define GL_SCENE_RENDERER_H
+
+#include <limits.h>
+#include <vector>
+
+#include "LinearR4.h"
+#include "EduPhong.h"
+#include "GlStaticGeometry.h"
+#include "GlFrustum.h"
+#include "RadixSort.h"
+
+class GlUniformRing;
+class SoftwareOcclusion;
+
+// GlSceneObject
+//    One row of the scene table.
+//    Objects are rendered sorted by pass, texture, material and transform,
+//    so the order of the table does not matter; then front to back.
+//    Objects with the same sort key keep their order in the table.
+struct GlSceneObject {
+    int pass;                       // Render pass: e.g., floor, walls, crates.
+    int mesh;                       // Index of the mesh in the renderer's GlStaticGeometry
+    unsigned int texture;           // OpenGL texture name, or 0 for no texture
+    phMaterial* material;           // Material (underlying the texture)
+    const LinearMapR4* modelMatrix; // Model matrix, or nullptr for the identity
+};
+
+// GlDrawPacket
+//    Everything needed to draw one visible object, built by BuildPackets.
+struct GlDrawPacket {
+    unsigned long long sortKey;     // Pass, texture, material, transform and depth (see MakeSortKey)
+    int pass;
+    int mesh;
+    unsigned int texture;
+    phMaterial* material;
+    int materialID;                 // The material's ID in phMaterialRegistry
+    const LinearMapR4* modelMatrix; // Packets with the same model matrix share the modelview matrix
+    float modelview[16];            // viewMatrix times the model matrix, by columns
+};
+
+class GlSceneRenderer
+{
+public:
+    GlSceneRenderer() {}
+
+    // All meshes are drawn from this geometry (must be loaded before rendering).
+    void SetGeometry(const GlStaticGeometry* theGeometry) { geometry = theGeometry; }
+
+    // The modelview matrix as a uniform block: "uniform phDrawData { mat4 modelviewMatrix; };"
+    static constexpr unsigned int DrawDataBinding = 2;
+    static constexpr const char* DrawDataBlockName = "phDrawData";
+    // The object records as a uniform block: "uniform phObjectArray { phObjectData objects[MaxObjectsPerDraw]; };"
+    //   (see MySceneShaders.glsl).  MaxObjectsPerDraw needs to match the number in the shaders.
+    static constexpr unsigned int ObjectDataBinding = 3;
+    static constexpr const char* ObjectDataBlockName = "phObjectArray";
+    static constexpr int MaxObjectsPerDraw = 128;
+
+    // The shader programs given to Render must match the mode.  The block modes need a ring.
+    enum DataMode { ModelviewUniform, DrawDataBlock, ObjectDataArray };
+    void SetDataMode(DataMode mode, GlUniformRing* ring = nullptr);
+    DataMode GetDataMode() const { return dataMode; }
+
+    // Building the scene table
+    void Clear();
+    int AddObject(const GlSceneObject& object);     // Returns the index of the new object
+    int GetNumObjects() const { return (int)objects.size(); }
+    GlSceneObject& GetObject(int i) { return objects[i]; }
+    const GlSceneObject& GetObject(int i) const { return objects[i]; }
+
+    // Build the draw packets of the visible objects, for all passes.  Call once per frame, before Render.
+    //   The modelview matrix for each object is viewMatrix times its model matrix.
+    //   If frustum is not null, objects outside it are culled.
+    //   If occlusion is not null, objects it finds hidden are culled (it must have been rendered for this view).
+    //   If pvsRow is not null, object i is culled unless bit i of the row is set (see MapPvs::CellRow).
+    //   Makes no OpenGL calls.
+    void BuildPackets(const LinearMapR4& viewMatrix, const GlFrustum* frustum = nullptr,
+                      const SoftwareOcclusion* occlusion = nullptr, const unsigned char* pvsRow = nullptr);
+
+    // Render the packets in passes firstPass through lastPass with the shader program.
+    //   The shader program must be registered with phRegisterShaderProgram.
+    //   In the block modes, the ring's frame must be begun.  Objects whose data
+    //   does not fit in the ring are not drawn (see NumObjectsSkipped).
+    // The shader program and the VAO are left bound, and applying textures is left turned off.
+    // All state changes go through GlStateCache.
+    void Render(unsigned int shaderProgram, int firstPass = 0, int lastPass = INT_MAX)
+        { RenderPackets(shaderProgram, firstPass, lastPass, false); }
+
+    // Render only the depth, for a depth pre-pass: no materials and no textures.
+    //   The depth-only shader program must match the data mode (see MySceneShaders.glsl).
+    void RenderDepth(unsigned int depthProgram, int firstPass = 0, int lastPass = INT_MAX)
+        { RenderPackets(depthProgram, firstPass, lastPass, true); }
+
+    // Statistics for the most recent call to BuildPackets()
+    int NumObjectsCulled() const { return numObjectsCulled; }       // Including the occluded objects
+    int NumObjectsOccluded() const { return numObjectsOccluded; }
+
+    // Statistics for the most recent call to Render()
+    int NumDrawCalls() const { return numDrawCalls; }
+    int NumStateChanges() const { return numStateChanges; }
+    int NumObjectsDrawn() const { return numObjectsDrawn; }
+    int NumTrianglesDrawn() const { return numTrianglesDrawn; }
+    int NumObjectsSkipped() const { return numObjectsSkipped; }     // Not drawn: the ring was full
+
+private:
+    static constexpr int PacketGrainSize = 64;      // Objects per worker task
+
+    std::vector<GlSceneObject> objects;
+    const GlStaticGeometry* geometry = nullptr;
+    DataMode dataMode = ModelviewUniform;
+    GlUniformRing* dataRing = nullptr;
+    std::vector<int> drawDataOffsets;               // Offset in the ring of each packet's modelview matrix
+    bool LoadDrawData(int firstPass, int lastPass); // Write the modelview matrices into the ring
+    void RenderPackets(unsigned int shaderProgram, int firstPass, int lastPass, bool depthOnly);
+    void RenderObjectData(unsigned int shaderProgram, int firstPass, int lastPass, bool depthOnly);
+
+    // One record of the phObjectArray block (std140 layout)
+    struct ObjectRecord {
+        float modelview[16];
+        int materialID[4];          // Only the first entry is used
+    };
+
+    // Small numbers for the textures, materials and model matrices, for the sort keys
+    std::vector<unsigned int> keyTextures;
+    std::vector<const phMaterial*> keyMaterials;
+    std::vector<const LinearMapR4*> keyTransforms;
+    std::vector<unsigned long long> objectKeys;     // Sort key of each object, with no depth
+    std::vector<int> objectMaterialIDs;             // phMaterialRegistry ID of each object's material
+    GlCullBoxes objectBoxes;                        // Bounding box of each object, in world coordinates
+    void UpdateObjectBox(int i);
+    unsigned long long MakeSortKey(const GlSceneObject& object);
+    static unsigned long long DepthKey(const float modelview[16], const GlMeshBounds& bounds);
+    static constexpr unsigned long long StateKeyMask = 0x00000fffff000000ull;   // The material and transform bits
+
+    // The packets: one slot per object (filled by the workers), then the visible ones, sorted
+    std::vector<GlDrawPacket> packetSlots;
+    std::vector<unsigned char> packetVisible;
+    std::vector<GlDrawPacket> packets;
+    int numObjectsCulled = 0;
+    int numObjectsOccluded = 0;
+    std::vector<int> chunkNumOccluded;              // Objects occluded in each worker chunk
+    RadixSorter packetSorter;
+    std::vector<unsigned long long> sortKeys;       // The visible packets' keys and slots, for sorting
+    std::vector<int> sortSlots;
+
+    // The current batch: mesh ranges waiting to be drawn with the same state
+    std::vector<int> batchCounts;
+    std::vector<const void*> batchOffsets;
+    std::vector<int> batchBaseVertices;
+    long long batchElements = 0;     // Total indices in the current batch
+    void AddToBatch(const GlMeshRange& range);
+    void FlushBatch();
+
+    int numObjectsDrawn = 0;
+    int numTrianglesDrawn = 0;
+    int numObjectsSkipped = 0;
+
+    int numDrawCalls = 0;
+    int numStateChanges = 0;
+};
+
+#endif  // GL_SCENE_RENDERER_H
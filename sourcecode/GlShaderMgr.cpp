@@ -25,6 +25,7 @@
 #include <GLFW/glfw3.h> 
 
 #include "GlShaderMgr.h"
+#include "CpuProfiler.h"
 
 #include <fstream>
 #include <string>
@@ -76,6 +77,7 @@ bool GlShaderMgr::LoadShaderSource(int numFiles, const char* filenamePtr[])
 
 bool GlShaderMgr::LoadShaderSource(const char* filename)
 {
+    CpuProfileZone zone("GlShaderMgr::LoadShaderSource");
     std::ifstream inFile;
     inFile.open(filename);
     if (inFile.fail()) {
@@ -250,6 +252,7 @@ unsigned int GlShaderMgr::CompileShader(const char* shaderCodeName1, const char*
 
 unsigned int GlShaderMgr::CompileShader(int numcodeBlocks, const char* shaderCodeNames[])
 {
+    CpuProfileZone zone("GlShaderMgr::CompileShader");
     ShaderType typeSoFar = code_block;
     int* stringLengths = new int[numcodeBlocks];
     char** codeBlockPtrs = new char*[numcodeBlocks];
@@ -329,6 +332,7 @@ unsigned int GlShaderMgr::CompileShader(int numcodeBlocks, const char* shaderCod
 // Returns 0 if a link error occurs.
 unsigned int GlShaderMgr::LinkShaderProgram(int numShaders, const unsigned int shaderList[])
 {
+    CpuProfileZone zone("GlShaderMgr::LinkShaderProgram");
     if (check_ok_to_link(numShaders, shaderList) == 0) {
         return 0;       // Not OK to link these shaders!
     }
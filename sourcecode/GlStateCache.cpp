@@ -0,0 +1,213 @@
+//
+// GlStateCache.cpp
+//
+//   Skips OpenGL calls that would not change the OpenGL state.
+//   See GlStateCache.h.
+//
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "GlStateCache.h"
+#include <stdio.h>
+#include <string.h>
+#include "assert.h"
+
+unsigned int GlStateCache::curProgram = GlStateCache::Unknown;
+unsigned int GlStateCache::curVertexArray = GlStateCache::Unknown;
+unsigned int GlStateCache::curTextureUnit = GlStateCache::Unknown;
+unsigned int GlStateCache::curTextures[GlStateCache::MaxTextureUnits] = {
+    Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown };
+std::unordered_map<unsigned long long, GlStateCache::UniformValue> GlStateCache::uniformValues;
+long long GlStateCache::numCalls[GlStateCache::NumStateKinds];
+long long GlStateCache::numSkipped[GlStateCache::NumStateKinds];
+long long GlStateCache::numDrawCalls = 0;
+long long GlStateCache::numTriangles = 0;
+
+void GlStateCache::UseProgram(unsigned int program)
+{
+    if (program == curProgram) {
+        numSkipped[ProgramState]++;
+        return;
+    }
+    glUseProgram(program);
+    curProgram = program;
+    numCalls[ProgramState]++;
+}
+
+void GlStateCache::BindVertexArray(unsigned int vao)
+{
+    if (vao == curVertexArray) {
+        numSkipped[VertexArrayState]++;
+        return;
+    }
+    glBindVertexArray(vao);
+    curVertexArray = vao;
+    numCalls[VertexArrayState]++;
+}
+
+void GlStateCache::ActiveTexture(unsigned int textureUnit)
+{
+    unsigned int unit = textureUnit - GL_TEXTURE0;
+    assert(unit < MaxTextureUnits);
+    if (unit == curTextureUnit) {
+        numSkipped[ActiveTextureState]++;
+        return;
+    }
+    glActiveTexture(textureUnit);
+    curTextureUnit = unit;
+    numCalls[ActiveTextureState]++;
+}
+
+void GlStateCache::BindTexture2D(unsigned int texture)
+{
+    if (curTextureUnit != Unknown && texture == curTextures[curTextureUnit]) {
+        numSkipped[TextureState]++;
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (curTextureUnit != Unknown) {
+        curTextures[curTextureUnit] = texture;
+    }
+    numCalls[TextureState]++;
+}
+
+// Find the cached value of a uniform of the current program.
+//    Returns nullptr if the current program is not known.
+GlStateCache::UniformValue* GlStateCache::LookupUniform(unsigned int location, bool* isNew)
+{
+    if (curProgram == Unknown) {
+        return nullptr;
+    }
+    unsigned long long key = ((unsigned long long)curProgram << 32) | location;
+    auto it = uniformValues.find(key);
+    *isNew = (it == uniformValues.end());
+    if (*isNew) {
+        it = uniformValues.emplace(key, UniformValue()).first;
+    }
+    return &it->second;
+}
+
+void GlStateCache::Uniform1i(unsigned int location, int value)
+{
+    if (location == (unsigned int)-1) {
+        return;
+    }
+    bool isNew;
+    UniformValue* cached = LookupUniform(location, &isNew);
+    if (cached != nullptr && !isNew && memcmp(cached->data(), &value, sizeof(int)) == 0) {
+        numSkipped[UniformState]++;
+        return;
+    }
+    glUniform1i(location, value);
+    if (cached != nullptr) {
+        memcpy(cached->data(), &value, sizeof(int));
+    }
+    numCalls[UniformState]++;
+}
+
+void GlStateCache::Uniform1f(unsigned int location, float value)
+{
+    if (location == (unsigned int)-1) {
+        return;
+    }
+    bool isNew;
+    UniformValue* cached = LookupUniform(location, &isNew);
+    if (cached != nullptr && !isNew && memcmp(cached->data(), &value, sizeof(float)) == 0) {
+        numSkipped[UniformState]++;
+        return;
+    }
+    glUniform1f(location, value);
+    if (cached != nullptr) {
+        (*cached)[0] = value;
+    }
+    numCalls[UniformState]++;
+}
+
+void GlStateCache::UniformMatrix4fv(unsigned int location, const float* matEntries)
+{
+    if (location == (unsigned int)-1) {
+        return;
+    }
+    bool isNew;
+    UniformValue* cached = LookupUniform(location, &isNew);
+    if (cached != nullptr && !isNew && memcmp(cached->data(), matEntries, 16 * sizeof(float)) == 0) {
+        numSkipped[UniformState]++;
+        return;
+    }
+    glUniformMatrix4fv(location, 1, false, matEntries);
+    if (cached != nullptr) {
+        memcpy(cached->data(), matEntries, 16 * sizeof(float));
+    }
+    numCalls[UniformState]++;
+}
+
+void GlStateCache::Invalidate()
+{
+    curProgram = Unknown;
+    curVertexArray = Unknown;
+    curTextureUnit = Unknown;
+    for (int i = 0; i < MaxTextureUnits; i++) {
+        curTextures[i] = Unknown;
+    }
+    uniformValues.clear();
+}
+
+void GlStateCache::InvalidateVertexArray()
+{
+    curVertexArray = Unknown;
+}
+
+void GlStateCache::InvalidateUniforms(unsigned int program)
+{
+    for (auto it = uniformValues.begin(); it != uniformValues.end(); ) {
+        if ((unsigned int)(it->first >> 32) == program) {
+            it = uniformValues.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void GlStateCache::ResetStatistics()
+{
+    for (int i = 0; i < NumStateKinds; i++) {
+        numCalls[i] = 0;
+        numSkipped[i] = 0;
+    }
+    numDrawCalls = 0;
+    numTriangles = 0;
+}
+
+void GlStateCache::CountDraw(unsigned int drawMode, long long numElements, int numInstances)
+{
+    numDrawCalls++;
+    switch (drawMode) {
+    case GL_TRIANGLES:
+        numTriangles += numInstances * (numElements / 3);
+        break;
+    case GL_TRIANGLE_STRIP:
+    case GL_TRIANGLE_FAN:
+        numTriangles += numElements > 2 ? numInstances * (numElements - 2) : 0;
+        break;
+    default:
+        break;
+    }
+}
+
+void GlStateCache::PrintStatistics()
+{
+    static const char* kindNames[NumStateKinds] = {
+        "Program", "Vertex array", "Active texture", "Texture", "Uniform" };
+    printf("GL state cache:      calls    skipped\n");
+    for (int i = 0; i < NumStateKinds; i++) {
+        printf("  %-14s %10lld %10lld\n", kindNames[i], numCalls[i], numSkipped[i]);
+    }
+    printf("  Draw calls %lld, triangles %lld\n", numDrawCalls, numTriangles);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+//
+// GlStateCache.h  ---  Header file for GlStateCache.cpp
+//
+//   Remembers the current shader program, VAO, active texture unit, the 2D texture
+//   bound to each texture unit, and the values of small uniforms (ints, floats
+//   and 4x4 matrices) of each shader program.
+//   Each routine makes the OpenGL call only when the value changes,
+//   and counts the calls it made and the calls it skipped.
+//
+//   All changes to this state must go through GlStateCache, or the cache
+//   must be told with one of the Invalidate routines.
+//
+
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+#include <array>
+#include <unordered_map>
+
+class GlStateCache {
+
+public:
+    // These have the same arguments as the OpenGL routines.
+    static void UseProgram(unsigned int program);
+    static void BindVertexArray(unsigned int vao);
+    static void ActiveTexture(unsigned int textureUnit);    // GL_TEXTURE0, GL_TEXTURE1, ...
+    static void BindTexture2D(unsigned int texture);        // Binds to GL_TEXTURE_2D of the active unit
+
+    // Uniforms of the current shader program.  A location of -1 is ignored.
+    static void Uniform1i(unsigned int location, int value);
+    static void Uniform1f(unsigned int location, float value);
+    static void UniformMatrix4fv(unsigned int location, const float* matEntries);   // One matrix, by columns
+
+    static unsigned int GetProgram() { return curProgram; }
+    static unsigned int GetVertexArray() { return curVertexArray; }
+
+    // Forget the cached state, e.g., after OpenGL calls that bypass the cache.
+    static void Invalidate();
+    static void InvalidateVertexArray();
+    static void InvalidateUniforms(unsigned int program);   // E.g., after the program is relinked
+
+    // Statistics: the number of calls made to OpenGL and the number skipped.
+    enum StateKind { ProgramState, VertexArrayState, ActiveTextureState, TextureState, UniformState, NumStateKinds };
+    static long long NumCalls(StateKind kind) { return numCalls[kind]; }
+    static long long NumSkipped(StateKind kind) { return numSkipped[kind]; }
+    static void ResetStatistics();
+    static void PrintStatistics();
+
+    // Draw statistics: the code that issues a draw call counts it here.
+    //   numElements is the index count (summed over a multi-draw).
+    static void CountDraw(unsigned int drawMode, long long numElements, int numInstances = 1);
+    static long long NumDrawCalls() { return numDrawCalls; }
+    static long long NumTriangles() { return numTriangles; }
+
+protected:
+    static constexpr int MaxTextureUnits = 32;
+    static constexpr unsigned int Unknown = 0xffffffff;    // The state is not known
+
+    static unsigned int curProgram;
+    static unsigned int curVertexArray;
+    static unsigned int curTextureUnit;                    // 0, 1, 2, ... (not GL_TEXTURE0+i)
+    static unsigned int curTextures[MaxTextureUnits];
+
+    // Uniform values, by program and location.  Ints and floats are stored in the first entry.
+    typedef std::array<float, 16> UniformValue;
+    static std::unordered_map<unsigned long long, UniformValue> uniformValues;
+    static UniformValue* LookupUniform(unsigned int location, bool* isNew);
+
+    static long long numCalls[NumStateKinds];
+    static long long numSkipped[NumStateKinds];
+    static long long numDrawCalls;
+    static long long numTriangles;
+};
+
+#endif // GL_STATE_CACHE_H
@@ -0,0 +1,175 @@
+//
+// GlStaticGeometry.cpp
+//
+//   Packs many small static meshes into a single VBO and a single EBO.
+//   See GlStaticGeometry.h for the layout.
+//
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "GlStaticGeometry.h"
+#include "GlStateCache.h"
+#include "GlDebugOutput.h"
+#include "assert.h"
+#include <math.h>
+
+int GlStaticGeometry::AddMesh(unsigned int drawMode, const float* verts, int numVerts,
+                              const unsigned int* elts, int numElts)
+{
+    GlMeshRange range;
+    range.firstIndex = (int)elementData.size();
+    range.numIndices = 0;
+    range.baseVertex = GetNumVertices();
+    range.numVertices = 0;
+    meshes.push_back(range);
+    meshBounds.push_back(GlMeshBounds());
+
+    int mesh = (int)meshes.size() - 1;
+    AppendToMesh(mesh, drawMode, verts, numVerts, elts, numElts);
+    return mesh;
+}
+
+void GlStaticGeometry::AppendToMesh(int mesh, unsigned int drawMode, const float* verts, int numVerts,
+                                    const unsigned int* elts, int numElts)
+{
+    assert(theVAO == 0 && "Meshes must be added before InitializeAttribLocations!");
+    assert(mesh == (int)meshes.size() - 1 && "Only the most recent mesh can be appended to");
+
+    GlMeshRange& range = meshes[mesh];
+    unsigned int first = range.numVertices;     // The part's vertex 0 in the mesh
+    range.numVertices += numVerts;
+    vertexData.insert(vertexData.end(), verts, verts + numVerts * FloatsPerVertex);
+
+    // Convert to GL_TRIANGLES.
+    // In a triangle strip every second triangle is reversed to keep the winding order.
+    switch (drawMode) {
+    case GL_TRIANGLES:
+        for (int i = 0; i + 2 < numElts; i += 3) {
+            AddTriangle(first + elts[i], first + elts[i + 1], first + elts[i + 2]);
+        }
+        break;
+    case GL_TRIANGLE_STRIP:
+        for (int i = 0; i + 2 < numElts; i++) {
+            if ((i & 1) == 0) {
+                AddTriangle(first + elts[i], first + elts[i + 1], first + elts[i + 2]);
+            }
+            else {
+                AddTriangle(first + elts[i + 1], first + elts[i], first + elts[i + 2]);
+            }
+        }
+        break;
+    case GL_TRIANGLE_FAN:
+        for (int i = 1; i + 1 < numElts; i++) {
+            AddTriangle(first + elts[0], first + elts[i], first + elts[i + 1]);
+        }
+        break;
+    default:
+        assert(false && "Unsupported draw mode");
+    }
+    range.numIndices = (int)elementData.size() - range.firstIndex;
+    UpdateBounds(mesh);
+}
+
+// The bounding sphere is centered on the center of the mesh's bounding box.
+void GlStaticGeometry::UpdateBounds(int mesh)
+{
+    const GlMeshRange& range = meshes[mesh];
+    const float* firstVert = &vertexData[(size_t)range.baseVertex * FloatsPerVertex];
+    float boxMin[3], boxMax[3];
+    for (int k = 0; k < 3; k++) {
+        boxMin[k] = boxMax[k] = range.numVertices > 0 ? firstVert[k] : 0.0f;
+    }
+    for (int i = 0; i < range.numVertices; i++) {
+        const float* pos = firstVert + i * FloatsPerVertex;
+        for (int k = 0; k < 3; k++) {
+            boxMin[k] = pos[k] < boxMin[k] ? pos[k] : boxMin[k];
+            boxMax[k] = pos[k] > boxMax[k] ? pos[k] : boxMax[k];
+        }
+    }
+    GlMeshBounds& bounds = meshBounds[mesh];
+    for (int k = 0; k < 3; k++) {
+        bounds.center[k] = 0.5f * (boxMin[k] + boxMax[k]);
+        bounds.boxMin[k] = boxMin[k];
+        bounds.boxMax[k] = boxMax[k];
+    }
+    float radiusSq = 0.0f;
+    for (int i = 0; i < range.numVertices; i++) {
+        const float* pos = firstVert + i * FloatsPerVertex;
+        float dx = pos[0] - bounds.center[0], dy = pos[1] - bounds.center[1], dz = pos[2] - bounds.center[2];
+        float distSq = dx * dx + dy * dy + dz * dz;
+        radiusSq = distSq > radiusSq ? distSq : radiusSq;
+    }
+    bounds.radius = sqrtf(radiusSq);
+}
+
+void GlStaticGeometry::AddTriangle(unsigned int a, unsigned int b, unsigned int c)
+{
+    if (a == b || b == c || a == c) {
+        return;         // Skip degenerate triangles
+    }
+    elementData.push_back(a);
+    elementData.push_back(b);
+    elementData.push_back(c);
+}
+
+void GlStaticGeometry::InitializeAttribLocations(
+    unsigned int pos_loc, unsigned int normal_loc, unsigned int texcoords_loc)
+{
+    // Generate Vertex Array Object and Buffer Objects, not already done.
+    if (theVAO == 0) {
+        glGenVertexArrays(1, &theVAO);
+        glGenBuffers(1, &theVBO);
+        glGenBuffers(1, &theEBO);
+    }
+
+    posLoc = pos_loc;
+    normalLoc = normal_loc;
+    texcoordsLoc = texcoords_loc;
+
+    GlStateCache::BindVertexArray(theVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, theVBO);
+    glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(float), vertexData.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, theEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, elementData.size() * sizeof(unsigned int), elementData.data(), GL_STATIC_DRAW);
+    // The objects exist once they have been bound, and can be labeled.
+    GlDebugOutput::LabelObject(GL_VERTEX_ARRAY, theVAO, "GlStaticGeometry VAO");
+    GlDebugOutput::LabelObject(GL_BUFFER, theVBO, "GlStaticGeometry VBO");
+    GlDebugOutput::LabelObject(GL_BUFFER, theEBO, "GlStaticGeometry EBO");
+    BindBuffersToVAO();
+
+    // Good practice to unbind things: helps with debugging if nothing else
+    GlStateCache::BindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void GlStaticGeometry::BindBuffersToVAO() const
+{
+    assert(theVBO != 0 && "InitializeAttribLocations must be called first");
+    glBindBuffer(GL_ARRAY_BUFFER, theVBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, theEBO);
+
+    const int stride = FloatsPerVertex * sizeof(float);
+    glVertexAttribPointer(posLoc, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);	            // Vertex positions in the VBO
+    glEnableVertexAttribArray(posLoc);
+    if (normalLoc != UINT_MAX) {
+        glVertexAttribPointer(normalLoc, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));	  // Vertex normals
+        glEnableVertexAttribArray(normalLoc);
+    }
+    if (texcoordsLoc != UINT_MAX) {
+        glVertexAttribPointer(texcoordsLoc, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));  // Texture coordinates
+        glEnableVertexAttribArray(texcoordsLoc);
+    }
+}
+
+GlStaticGeometry::~GlStaticGeometry()
+{
+    if (theVAO != 0) {
+        glDeleteVertexArrays(1, &theVAO);
+        glDeleteBuffers(1, &theVBO);
+        glDeleteBuffers(1, &theEBO);
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+//
+// GlStaticGeometry.h  ---  Header file for GlStaticGeometry.cpp
+//
+//   Packs many small static meshes into a single VBO and a single EBO,
+//   sharing a single VAO.
+//   Each mesh is converted to GL_TRIANGLES when it is added (triangle strips
+//   and triangle fans are expanded, keeping their winding order), so meshes
+//   can be drawn together with one glMultiDrawElementsBaseVertex call.
+//   The mesh's element indices are relative to its first vertex: each mesh is
+//   described by its first index, number of indices and base vertex.
+//
+//   Vertex layout: position (3 floats), normal (3 floats), texture coordinates (2 floats).
+//
+
+#ifndef GL_STATIC_GEOMETRY_H
+#define GL_STATIC_GEOMETRY_H
+
+#include <limits.h>
+#include <stddef.h>
+#include <vector>
+
+// GlMeshRange
+//     The location of one mesh in the shared VBO and EBO.
+struct GlMeshRange {
+    int firstIndex;         // First index in the EBO (counted in indices, not bytes)
+    int numIndices;         // Number of indices, a multiple of three (GL_TRIANGLES)
+    int baseVertex;         // Added to each index to get the vertex in the VBO
+    int numVertices;        // Number of vertices in the VBO for this mesh
+};
+
+// GlMeshBounds
+//     The bounding box and a bounding sphere of one mesh, in the mesh's own (model) coordinates.
+struct GlMeshBounds {
+    float center[3];
+    float radius;
+    float boxMin[3];
+    float boxMax[3];
+};
+
+class GlStaticGeometry
+{
+public:
+    static constexpr int FloatsPerVertex = 8;   // Position, normal, texture coordinates
+
+    GlStaticGeometry() {}
+    ~GlStaticGeometry();
+
+    // Disable all copy and assignment operators (the object owns OpenGL buffers).
+    GlStaticGeometry(const GlStaticGeometry&) = delete;
+    GlStaticGeometry& operator=(const GlStaticGeometry&) = delete;
+
+    // Add a mesh.  Returns the index of the mesh.
+    //   drawMode is GL_TRIANGLES, GL_TRIANGLE_STRIP or GL_TRIANGLE_FAN;
+    //   the elements index the mesh's own vertices (starting at 0).
+    // Meshes must be added before InitializeAttribLocations() is called.
+    int AddMesh(unsigned int drawMode, const float* verts, int numVerts,
+                const unsigned int* elts, int numElts);
+    template<size_t NV, size_t NE>
+    int AddMesh(unsigned int drawMode, const float (&verts)[NV], const unsigned int (&elts)[NE]) {
+        static_assert(NV % FloatsPerVertex == 0, "Vertices need 8 floats each");
+        return AddMesh(drawMode, verts, (int)(NV / FloatsPerVertex), elts, (int)NE);
+    }
+
+    // Append more vertices and triangles to the most recently added mesh.
+    //   This builds one mesh out of several parts (e.g., the faces of a crate).
+    //   The elements index the part's own vertices (starting at 0).
+    void AppendToMesh(int mesh, unsigned int drawMode, const float* verts, int numVerts,
+                      const unsigned int* elts, int numElts);
+    template<size_t NV, size_t NE>
+    void AppendToMesh(int mesh, unsigned int drawMode, const float (&verts)[NV], const unsigned int (&elts)[NE]) {
+        static_assert(NV % FloatsPerVertex == 0, "Vertices need 8 floats each");
+        AppendToMesh(mesh, drawMode, verts, (int)(NV / FloatsPerVertex), elts, (int)NE);
+    }
+
+    // Allocate the VAO, VBO and EBO, load all the meshes into them and
+    //    set up the vertex attribute locations for the shader programs.
+    void InitializeAttribLocations(
+        unsigned int pos_loc, unsigned int normal_loc = UINT_MAX, unsigned int texcoords_loc = UINT_MAX);
+
+    // Attach the VBO and EBO to the currently bound VAO, with the same vertex
+    //    attributes as GetVAO().  Used for VAOs with extra attributes (e.g., per-instance data).
+    void BindBuffersToVAO() const;
+
+    int GetNumMeshes() const { return (int)meshes.size(); }
+    const GlMeshRange& GetMesh(int i) const { return meshes[i]; }
+    const GlMeshBounds& GetMeshBounds(int i) const { return meshBounds[i]; }
+
+    unsigned int GetVAO() const { return theVAO; }
+    unsigned int GetVBO() const { return theVBO; }
+    unsigned int GetEBO() const { return theEBO; }
+
+    // The vertex and element data are kept after loading (for CPU side use)
+    const std::vector<float>& GetVertexData() const { return vertexData; }
+    const std::vector<unsigned int>& GetElementData() const { return elementData; }
+    int GetNumVertices() const { return (int)(vertexData.size() / FloatsPerVertex); }
+    int GetNumTriangles() const { return (int)(elementData.size() / 3); }
+
+private:
+    std::vector<GlMeshRange> meshes;
+    std::vector<GlMeshBounds> meshBounds;
+    std::vector<float> vertexData;
+    std::vector<unsigned int> elementData;
+
+    unsigned int theVAO = 0;        // Vertex Array Object
+    unsigned int theVBO = 0;        // Vertex Buffer Object
+    unsigned int theEBO = 0;        // Element Buffer Object
+    unsigned int posLoc = UINT_MAX;
+    unsigned int normalLoc = UINT_MAX;
+    unsigned int texcoordsLoc = UINT_MAX;
+
+    void AddTriangle(unsigned int a, unsigned int b, unsigned int c);
+    void UpdateBounds(int mesh);
+};
+
+#endif  // GL_STATIC_GEOMETRY_H
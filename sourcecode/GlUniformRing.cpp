@@ -0,0 +1,142 @@
+//
+// GlUniformRing.cpp
+//
+//   A fenced ring of uniform buffer memory, persistently mapped if possible.
+//   See GlUniformRing.h.
+//
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "GlUniformRing.h"
+#include "GlDebugOutput.h"
+#include <stdio.h>
+#include <string.h>
+
+bool GlUniformRing::Create(int regionBytes)
+{
+    Destroy();
+    int uboAlign = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlign);
+    alignment = uboAlign > 0 ? uboAlign : 256;
+    regionSize = alignment * ((regionBytes + alignment - 1) / alignment);
+    GLsizeiptr totalSize = (GLsizeiptr)regionSize * NumRegions;
+
+    glGenBuffers(1, &theBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, theBuffer);
+    GlDebugOutput::LabelObject(GL_BUFFER, theBuffer, "GlUniformRing");
+    persistent = false;
+    if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, totalSize, nullptr, flags);
+        mappedData = (unsigned char*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, totalSize, flags);
+        persistent = (mappedData != nullptr);
+        if (!persistent) {
+            // The storage is immutable: start again with a new buffer.
+            glDeleteBuffers(1, &theBuffer);
+            glGenBuffers(1, &theBuffer);
+            glBindBuffer(GL_UNIFORM_BUFFER, theBuffer);
+        }
+    }
+    if (!persistent) {
+        glBufferData(GL_UNIFORM_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+        stagedData.resize(regionSize);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    curRegion = 0;
+    curHead = flushedHead = 0;
+    numFenceWaits = numFailures = 0;
+    printf("Uniform ring: %d x %d bytes, %s.\n", NumRegions, regionSize,
+           persistent ? "persistently mapped" : "staged (no glBufferStorage)");
+    return true;
+}
+
+void GlUniformRing::Destroy()
+{
+    if (theBuffer == 0) {
+        return;
+    }
+    for (int i = 0; i < NumRegions; i++) {
+        if (fences[i] != nullptr) {
+            glDeleteSync((GLsync)fences[i]);
+            fences[i] = nullptr;
+        }
+    }
+    if (persistent) {
+        glBindBuffer(GL_UNIFORM_BUFFER, theBuffer);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &theBuffer);
+    theBuffer = 0;
+    mappedData = nullptr;
+    stagedData.clear();
+}
+
+void GlUniformRing::BeginFrame()
+{
+    if (theBuffer == 0) {
+        return;
+    }
+    curRegion = (curRegion + 1) % NumRegions;
+    curHead = flushedHead = 0;
+    GLsync fence = (GLsync)fences[curRegion];
+    if (fence == nullptr) {
+        return;
+    }
+    // Normally the fence signaled frames ago.  Otherwise the GPU is behind: wait for it.
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        numFenceWaits++;
+        status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) {
+            printf("Uniform ring: the GPU did not finish with a region.\n");
+        }
+    }
+    glDeleteSync(fence);
+    fences[curRegion] = nullptr;
+}
+
+void GlUniformRing::EndFrame()
+{
+    if (theBuffer == 0) {
+        return;
+    }
+    Flush();
+    fences[curRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void* GlUniformRing::Allocate(int numBytes, int* offset)
+{
+    if (theBuffer == 0) {
+        return nullptr;
+    }
+    int start = alignment * ((curHead + alignment - 1) / alignment);
+    if (start + numBytes > regionSize) {
+        numFailures++;
+        return nullptr;
+    }
+    curHead = start + numBytes;
+    *offset = curRegion * regionSize + start;
+    return persistent ? mappedData + *offset : stagedData.data() + start;
+}
+
+void GlUniformRing::Flush()
+{
+    if (persistent || theBuffer == 0 || flushedHead == curHead) {
+        return;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, theBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, (GLintptr)curRegion * regionSize + flushedHead,
+                    curHead - flushedHead, stagedData.data() + flushedHead);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    flushedHead = curHead;
+}
+
+void GlUniformRing::BindRange(unsigned int bindingIndex, int offset, int numBytes) const
+{
+    glBindBufferRange(GL_UNIFORM_BUFFER, bindingIndex, theBuffer, offset, numBytes);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+//
+// GlUniformRing.h  ---  Header file for GlUniformRing.cpp
+//
+//   A ring of uniform buffer memory for data that changes every frame or every
+//   draw: the lights, and the modelview matrices.  The buffer is split into
+//   NumRegions regions, one per frame in flight.  Each frame allocates from its
+//   own region, and a fence placed at the end of the frame guards the region
+//   until the GPU is done with it.  The data is bound with glBindBufferRange.
+//
+//   With OpenGL 4.4 (or ARB_buffer_storage) the buffer is made with
+//   glBufferStorage and stays mapped (persistent and coherent), so the data is
+//   written straight into the buffer with no copies by the driver.  Otherwise
+//   the data is staged in memory and Flush() uploads it with glBufferSubData
+//   into the region, which the fence has made idle.
+//
+//   Per frame:   BeginFrame(),  Allocate() ...,  Flush() before drawing with
+//                the data,  EndFrame() after the last draw that uses it.
+//
+
+#ifndef GL_UNIFORM_RING_H
+#define GL_UNIFORM_RING_H
+
+#include <vector>
+
+class GlUniformRing {
+
+public:
+    static constexpr int NumRegions = 3;            // Frames in flight
+
+    GlUniformRing() {}
+    ~GlUniformRing() { Destroy(); }
+
+    // Disable all copy and assignment operators (the object owns the buffer).
+    GlUniformRing(const GlUniformRing&) = delete;
+    GlUniformRing& operator=(const GlUniformRing&) = delete;
+
+    // Create the buffer, with regionBytes bytes for each frame.  Needs an OpenGL context.
+    bool Create(int regionBytes);
+    void Destroy();
+
+    void BeginFrame();      // Move to the next region, waiting for the GPU only if it still uses it
+    void EndFrame();        // Fence the region
+
+    // Space for numBytes bytes in this frame's region, aligned for glBindBufferRange.
+    //   Returns nullptr if the region is full (the caller must fall back to other means).
+    //   The offset for glBindBufferRange is returned in *offset.
+    void* Allocate(int numBytes, int* offset);
+    void Flush();           // Make the data allocated so far visible to the GPU (no-op when persistent)
+
+    void BindRange(unsigned int bindingIndex, int offset, int numBytes) const;
+
+    bool IsCreated() const { return theBuffer != 0; }
+    bool IsPersistent() const { return persistent; }
+    unsigned int GetBuffer() const { return theBuffer; }
+    long long NumFenceWaits() const { return numFenceWaits; }
+    long long NumAllocationFailures() const { return numFailures; }
+
+private:
+    unsigned int theBuffer = 0;
+    bool persistent = false;
+    unsigned char* mappedData = nullptr;        // The whole buffer, when persistent
+    std::vector<unsigned char> stagedData;      // One region, when not persistent
+    int regionSize = 0;
+    int alignment = 256;                        // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+
+    int curRegion = 0;
+    int curHead = 0;                            // Bytes allocated in the current region
+    int flushedHead = 0;                        // Bytes uploaded by Flush (when not persistent)
+    void* fences[NumRegions] = { nullptr };     // GLsync
+
+    long long numFenceWaits = 0;
+    long long numFailures = 0;
+};
+
+#endif // GL_UNIFORM_RING_H
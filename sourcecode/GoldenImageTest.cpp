@@ -0,0 +1,203 @@
+//
+// GoldenImageTest.cpp
+//
+//   Image regression tests with performance gates.  See GoldenImageTest.h.
+//
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "GoldenImageTest.h"
+#include "BenchRender.h"
+#include "TextureProj.h"
+#include "GlDebugOutput.h"
+#include "CpuProfiler.h"
+#include "HeadlessContext.h"
+#include "GlOffscreenTarget.h"
+#include "RgbImage.h"
+#include "MathMisc.h"
+#include <stdio.h>
+#include <string>
+
+int GoldenImageTest::colorTolerance = GoldenImageTest::DefaultTolerance;
+double GoldenImageTest::maxBadFraction = GoldenImageTest::DefaultMaxBadFraction;
+
+namespace {
+    // The views: the starting view, and views that look at each part of the map.
+    const GoldenView goldenViews[] = {
+        { "default",    0.25,  0.0,        0.0,   0.0  },
+        { "overhead",   1.20,  0.0,       10.0,   0.25 },
+        { "side",       0.15,  PIhalves,  -5.0,   0.5  },
+        { "back_far",   0.50,  PI,        25.0,   0.75 },
+        { "close",      0.35, -0.6,      -12.0,   0.1  },
+    };
+    const int numGoldenViews = sizeof(goldenViews) / sizeof(goldenViews[0]);
+
+    std::string GoldenFilename(const char* directory, const char* name, const char* suffix)
+    {
+        return std::string(directory) + "/" + name + suffix + ".bmp";
+    }
+}
+
+bool GoldenImageTest::RenderView(const GoldenView& view, RgbImage& image)
+{
+    CpuProfileZone zone("Golden view");
+    mySetView(view.viewAzimuth, view.viewDirection, view.ZextraDistance);
+    mySetAnimationTime(view.animationTime);
+    myRenderScene();
+    GlDebugOutput::ReportMessages();
+    image.Reset();
+    return image.LoadFromOpenglBuffer();
+}
+
+long GoldenImageTest::CountBadPixels(const RgbImage& image, const RgbImage& golden, int tolerance,
+                                     int* maxDifference, RgbImage* diffImage)
+{
+    long numRows = image.GetNumRows();
+    long numCols = image.GetNumCols();
+    if (diffImage != nullptr) {
+        diffImage->AllocateImageData(numRows, numCols);
+    }
+    long numBad = 0;
+    int maxDiff = 0;
+    for (long row = 0; row < numRows; row++) {
+        for (long col = 0; col < numCols; col++) {
+            const unsigned char* a = image.GetRgbPixel(row, col);
+            const unsigned char* b = golden.GetRgbPixel(row, col);
+            int pixelDiff = 0;
+            for (int c = 0; c < 3; c++) {
+                int d = a[c] > b[c] ? a[c] - b[c] : b[c] - a[c];
+                pixelDiff = d > pixelDiff ? d : pixelDiff;
+            }
+            maxDiff = pixelDiff > maxDiff ? pixelDiff : maxDiff;
+            bool bad = pixelDiff > tolerance;
+            if (bad) {
+                numBad++;
+            }
+            if (diffImage != nullptr) {
+                if (bad) {
+                    diffImage->SetRgbPixelc(row, col, 255, 0, 0);
+                }
+                else {
+                    unsigned char gray = (unsigned char)((a[0] + a[1] + a[2]) / 9);
+                    diffImage->SetRgbPixelc(row, col, gray, gray, gray);
+                }
+            }
+        }
+    }
+    if (maxDifference != nullptr) {
+        *maxDifference = maxDiff;
+    }
+    return numBad;
+}
+
+int GoldenImageTest::CheckImages(const char* directory)
+{
+    int numFailed = 0;
+    for (int i = 0; i < numGoldenViews; i++) {
+        const GoldenView& view = goldenViews[i];
+        RgbImage image;
+        if (!RenderView(view, image)) {
+            printf("Golden: %-10s FAIL  unable to read back the frame.\n", view.name);
+            numFailed++;
+            continue;
+        }
+        std::string goldenFilename = GoldenFilename(directory, view.name, "");
+        RgbImage golden;
+        if (!golden.LoadBmpFile(goldenFilename.c_str())) {
+            printf("Golden: %-10s FAIL  no golden image %s (make it with --golden-update).\n", view.name, goldenFilename.c_str());
+            numFailed++;
+            continue;
+        }
+        if (golden.GetNumRows() != image.GetNumRows() || golden.GetNumCols() != image.GetNumCols()) {
+            printf("Golden: %-10s FAIL  golden image is %ld x %ld, rendered %ld x %ld.\n", view.name,
+                golden.GetNumCols(), golden.GetNumRows(), image.GetNumCols(), image.GetNumRows());
+            numFailed++;
+            continue;
+        }
+
+        RgbImage diffImage;
+        int maxDiff;
+        long numBad = CountBadPixels(image, golden, colorTolerance, &maxDiff, &diffImage);
+        long numPixels = image.GetNumRows() * image.GetNumCols();
+        bool pass = numBad <= (long)(maxBadFraction * numPixels);
+        printf("Golden: %-10s %s  %ld of %ld pixels over tolerance %d (max difference %d).\n",
+            view.name, pass ? "pass" : "FAIL", numBad, numPixels, colorTolerance, maxDiff);
+        if (!pass) {
+            numFailed++;
+            image.WriteBmpFile(GoldenFilename(directory, view.name, "_actual").c_str());
+            diffImage.WriteBmpFile(GoldenFilename(directory, view.name, "_diff").c_str());
+        }
+    }
+    return numFailed;
+}
+
+bool GoldenImageTest::UpdateImages(const char* directory)
+{
+    bool ok = true;
+    for (int i = 0; i < numGoldenViews; i++) {
+        RgbImage image;
+        std::string goldenFilename = GoldenFilename(directory, goldenViews[i].name, "");
+        if (RenderView(goldenViews[i], image) && image.WriteBmpFile(goldenFilename.c_str())) {
+            printf("Golden: saved %s.\n", goldenFilename.c_str());
+        }
+        else {
+            printf("Golden: unable to save %s.\n", goldenFilename.c_str());
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool GoldenImageTest::CheckFrameBudget(double budgetMs, int numFrames)
+{
+    std::vector<BenchResult> results;
+    if (!BenchRender::Run(numFrames, results)) {
+        printf("Frame budget: FAIL  nothing rendered.\n");
+        return false;
+    }
+    BenchRender::PrintResults(results);
+    bool pass = true;
+    for (const BenchResult& r : results) {
+        if (r.p95Ms > budgetMs) {
+            printf("Frame budget: FAIL  meshRes %d: p95 frame time %.3f ms is over the budget of %.3f ms.\n",
+                r.meshRes, r.p95Ms, budgetMs);
+            pass = false;
+        }
+    }
+    if (pass) {
+        printf("Frame budget: pass  p95 frame times are within %.3f ms.\n", budgetMs);
+    }
+    return pass;
+}
+
+int runGoldenTests(int width, int height, const char* directory, bool update,
+                   double budgetMs, int budgetFrames, const char* traceFilename)
+{
+    long long startupBegin = CpuProfiler::NowMicroseconds();
+    HeadlessContext headlessContext;
+    GlOffscreenTarget offscreenTarget;
+    if (!setupHeadless(headlessContext, offscreenTarget, width, height)) {
+        return -1;
+    }
+    CpuProfiler::RecordZone("Startup", startupBegin, CpuProfiler::NowMicroseconds());
+    spinMode = false;           // Each view sets the animation time itself
+
+    int numFailed = 0;
+    if (update) {
+        numFailed = GoldenImageTest::UpdateImages(directory) ? 0 : 1;
+    }
+    else {
+        numFailed = GoldenImageTest::CheckImages(directory);
+        printf("Golden: %d of %d views failed.\n", numFailed, numGoldenViews);
+    }
+    if (budgetMs > 0.0 && !GoldenImageTest::CheckFrameBudget(budgetMs, budgetFrames)) {
+        numFailed++;
+    }
+    if (traceFilename != nullptr) {
+        CpuProfiler::DumpChromeTrace(traceFilename);
+    }
+    return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+//
+// GoldenImageTest.h  ---  Header file for GoldenImageTest.cpp
+//
+//   Image regression tests with performance gates, run headless with --golden.
+//   The scene is rendered offscreen from a fixed set of views (the view and the
+//   animation time are both fixed), read back with RgbImage::LoadFromOpenglBuffer,
+//   and compared against golden bitmaps NAME.bmp in a directory.
+//   A pixel fails if any of its color components differs from the golden image
+//   by more than the tolerance; a view fails if more than a fraction of its
+//   pixels fail.  Failing views save NAME_actual.bmp and NAME_diff.bmp.
+//
+//   With --golden-update, the golden bitmaps are written instead.  Golden images
+//   depend on the renderer, so make them on the machine (GPU or llvmpipe) that checks them.
+//
+//   The performance gate runs the BenchRender camera path and fails if the p95
+//   frame time at any mesh resolution is over the budget.
+//
+
+#ifndef GOLDEN_IMAGE_TEST_H
+#define GOLDEN_IMAGE_TEST_H
+
+class RgbImage;
+
+// A fixed view of the scene
+struct GoldenView {
+    const char* name;           // The golden bitmap is name.bmp
+    double viewAzimuth;
+    double viewDirection;
+    double ZextraDistance;
+    double animationTime;       // currentTime, 0 to 1
+};
+
+class GoldenImageTest {
+
+public:
+    static constexpr int DefaultTolerance = 2;          // Per color component, out of 255
+    static constexpr double DefaultMaxBadFraction = 0.0;
+    static constexpr int DefaultBudgetFrames = 120;
+
+    static void SetTolerance(int tolerance) { colorTolerance = tolerance; }
+    static void SetMaxBadFraction(double fraction) { maxBadFraction = fraction; }
+
+    // Render every view and compare it with its golden bitmap in the directory.
+    //   Returns the number of views that failed (or had no golden bitmap).
+    static int CheckImages(const char* directory);
+
+    // Render every view and save it as the golden bitmap in the directory.
+    static bool UpdateImages(const char* directory);
+
+    // Run the benchmark camera path.  Returns false if any p95 frame time is over budgetMs.
+    static bool CheckFrameBudget(double budgetMs, int numFrames);
+
+    // Count the pixels with a color component differing by more than tolerance.
+    //   If diffImage is not null, it is set to the image, dimmed, with the failing pixels in red.
+    //   The images must be the same size.
+    static long CountBadPixels(const RgbImage& image, const RgbImage& golden, int tolerance,
+                               int* maxDifference, RgbImage* diffImage);
+
+private:
+    static int colorTolerance;
+    static double maxBadFraction;
+
+    static bool RenderView(const GoldenView& view, RgbImage& image);
+};
+
+// The --golden and --golden-update entry point: set up headless rendering, run the tests.
+//   budgetMs <= 0 skips the performance gate.  Returns 0 if everything passed.
+int runGoldenTests(int width, int height, const char* directory, bool update,
+                   double budgetMs, int budgetFrames, const char* traceFilename);
+
+#endif // GOLDEN_IMAGE_TEST_H
@@ -0,0 +1,157 @@
+//
+// HeadlessContext.cpp
+//
+//   An OpenGL context with no window, made with EGL.
+//   See HeadlessContext.h.
+//
+
+// Use the static library (so glew32.dll is not needed):
+#define GLEW_STATIC
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "HeadlessContext.h"
+#include "GlDebugOutput.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__linux__) && !defined(HEADLESS_NO_EGL)
+#define HEADLESS_USE_EGL 1
+#else
+#define HEADLESS_USE_EGL 0
+#endif
+
+#if HEADLESS_USE_EGL
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+namespace {
+    // Is the extension in the space-separated list?
+    bool HasExtension(const char* extensions, const char* name)
+    {
+        if (extensions == nullptr) {
+            return false;
+        }
+        size_t len = strlen(name);
+        for (const char* p = strstr(extensions, name); p != nullptr; p = strstr(p + len, name)) {
+            if ((p == extensions || p[-1] == ' ') && (p[len] == ' ' || p[len] == 0)) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+bool HeadlessContext::Create()
+{
+    Destroy();
+
+    // The display: surfaceless if possible, so no X server or GPU device is needed.
+    EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (HasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay != nullptr) {
+            eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+    }
+    if (eglDisplay == EGL_NO_DISPLAY) {
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    EGLint major, minor;
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor)) {
+        printf("Headless: unable to initialize an EGL display.\n");
+        return false;
+    }
+    display = eglDisplay;
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        printf("Headless: EGL does not support desktop OpenGL.\n");
+        Destroy();
+        return false;
+    }
+
+    bool surfaceless = HasExtension(eglQueryString(eglDisplay, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+    const EGLint configAttribs[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(eglDisplay, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+        printf("Headless: no suitable EGL config.\n");
+        Destroy();
+        return false;
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+#if GL_DEBUG_CHECKS
+        EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+#endif
+        EGL_NONE };
+    EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttribs);
+    if (eglContext == EGL_NO_CONTEXT) {
+        printf("Headless: unable to create an OpenGL 3.3 core context (EGL error 0x%x).\n", eglGetError());
+        Destroy();
+        return false;
+    }
+    context = eglContext;
+
+    // All rendering goes to framebuffer objects, so the default framebuffer is not needed.
+    EGLSurface eglSurface = EGL_NO_SURFACE;
+    if (!surfaceless) {
+        const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        eglSurface = eglCreatePbufferSurface(eglDisplay, config, pbufferAttribs);
+        if (eglSurface == EGL_NO_SURFACE) {
+            printf("Headless: unable to create a pbuffer surface.\n");
+            Destroy();
+            return false;
+        }
+        surface = eglSurface;
+    }
+    if (!eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext)) {
+        printf("Headless: unable to make the EGL context current.\n");
+        Destroy();
+        return false;
+    }
+    printf("Headless: EGL %d.%d, %s.\n", major, minor, surfaceless ? "surfaceless" : "pbuffer");
+    return true;
+}
+
+void HeadlessContext::Destroy()
+{
+    if (display == nullptr) {
+        return;
+    }
+    eglMakeCurrent((EGLDisplay)display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (surface != nullptr) {
+        eglDestroySurface((EGLDisplay)display, (EGLSurface)surface);
+    }
+    if (context != nullptr) {
+        eglDestroyContext((EGLDisplay)display, (EGLContext)context);
+    }
+    eglTerminate((EGLDisplay)display);
+    display = nullptr;
+    context = nullptr;
+    surface = nullptr;
+}
+
+#else   // HEADLESS_USE_EGL
+
+bool HeadlessContext::Create()
+{
+    printf("Headless rendering needs EGL, which is not available in this build.\n");
+    return false;
+}
+
+void HeadlessContext::Destroy()
+{
+}
+
+#endif  // HEADLESS_USE_EGL
@@ -0,0 +1,42 @@
+#pragma once
+
+//
+// HeadlessContext.h  ---  Header file for HeadlessContext.cpp
+//
+//   An OpenGL 3.3 core context with no window and no display, made with EGL.
+//   Used to render offscreen (into a GlOffscreenTarget) on machines with no
+//   display, e.g., with Mesa's software rasterizers (llvmpipe).
+//
+//   The EGL display is surfaceless (EGL_MESA_platform_surfaceless) if available,
+//   otherwise the default display.  The context is made current with no surface
+//   (EGL_KHR_surfaceless_context) if possible, otherwise with a 1x1 pbuffer.
+//
+//   EGL is used on Linux.  Elsewhere, or when compiled with HEADLESS_NO_EGL,
+//   Create() always fails.
+//
+
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+class HeadlessContext {
+
+public:
+    HeadlessContext() {}
+    ~HeadlessContext() { Destroy(); }
+
+    // Disable all copy and assignment operators (the object owns the context).
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // Create the context and make it current.  Returns false (with a message) on failure.
+    //   GLEW must be initialized after this.
+    bool Create();
+    void Destroy();
+
+private:
+    void* display = nullptr;        // EGLDisplay
+    void* context = nullptr;        // EGLContext
+    void* surface = nullptr;        // EGLSurface: the pbuffer, or nullptr if surfaceless
+};
+
+#endif // HEADLESS_CONTEXT_H
@@ -0,0 +1,313 @@
+//
+// MapPvs.cpp
+//
+//   A potentially visible set for a static map, baked by ray sampling.
+//   See MapPvs.h.
+//
+
+#include "MapPvs.h"
+#include "GlStaticGeometry.h"
+#include "LinearR4.h"
+#include "WorkerPool.h"
+#include "CpuProfiler.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+namespace {
+    const char PvsFileMagic[4] = { 'P', 'V', 'S', '1' };
+
+    // A small deterministic random number generator (xorshift), one for each cell
+    struct PvsRandom {
+        unsigned int state;
+        explicit PvsRandom(unsigned int seed) : state(seed != 0 ? seed : 1) {}
+        float Next() {                  // Uniform in [0,1)
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return (state >> 8) * (1.0f / 16777216.0f);
+        }
+    };
+
+    void Sub3(const float* a, const float* b, float* out) {
+        out[0] = a[0] - b[0];
+        out[1] = a[1] - b[1];
+        out[2] = a[2] - b[2];
+    }
+    void Cross3(const float* a, const float* b, float* out) {
+        out[0] = a[1] * b[2] - a[2] * b[1];
+        out[1] = a[2] * b[0] - a[0] * b[2];
+        out[2] = a[0] * b[1] - a[1] * b[0];
+    }
+    float Dot3(const float* a, const float* b) {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+}
+
+void MapPvs::SetGrid(float theMinX, float theMinZ, float theMaxX, float theMaxZ,
+                     int theCellsX, int theCellsZ, float theEyeMin, float theEyeMax)
+{
+    minX = theMinX;
+    minZ = theMinZ;
+    maxX = theMaxX;
+    maxZ = theMaxZ;
+    cellsX = theCellsX;
+    cellsZ = theCellsZ;
+    eyeMin = theEyeMin;
+    eyeMax = theEyeMax;
+    ClearVisibility();
+}
+
+void MapPvs::ClearGeometry()
+{
+    blockers.Clear();
+    objects.clear();
+    ClearVisibility();
+}
+
+void MapPvs::ClearVisibility()
+{
+    rowBytes = ((int)objects.size() + 7) / 8;
+    visibility.clear();
+    hasVisibility = false;
+}
+
+void MapPvs::AddTriangles(std::vector<float>& verts, const GlStaticGeometry& geometry, int mesh, const LinearMapR4* m)
+{
+    const GlMeshRange& range = geometry.GetMesh(mesh);
+    const std::vector<float>& vertexData = geometry.GetVertexData();
+    const std::vector<unsigned int>& elementData = geometry.GetElementData();
+    for (int i = range.firstIndex; i < range.firstIndex + range.numIndices; i++) {
+        const float* pos = &vertexData[(size_t)(range.baseVertex + elementData[i]) * GlStaticGeometry::FloatsPerVertex];
+        if (m == nullptr) {
+            verts.insert(verts.end(), pos, pos + 3);
+        }
+        else {
+            verts.push_back((float)(m->m11 * pos[0] + m->m12 * pos[1] + m->m13 * pos[2] + m->m14));
+            verts.push_back((float)(m->m21 * pos[0] + m->m22 * pos[1] + m->m23 * pos[2] + m->m24));
+            verts.push_back((float)(m->m31 * pos[0] + m->m32 * pos[1] + m->m33 * pos[2] + m->m34));
+        }
+    }
+}
+
+void MapPvs::AddBlocker(const GlStaticGeometry& geometry, int mesh, const LinearMapR4* modelMatrix)
+{
+    blockers.AddMesh(geometry, mesh, modelMatrix);
+    ClearVisibility();
+}
+
+int MapPvs::AddObject(const GlStaticGeometry& geometry, int mesh, const LinearMapR4* modelMatrix)
+{
+    objects.emplace_back();
+    Object& obj = objects.back();
+    AddTriangles(obj.verts, geometry, mesh, modelMatrix);
+    int numTriangles = (int)(obj.verts.size() / 9);
+    float area = 0.0f;
+    for (int t = 0; t < numTriangles; t++) {
+        const float* v = &obj.verts[(size_t)9 * t];
+        float edge1[3], edge2[3], normal[3];
+        Sub3(v + 3, v, edge1);
+        Sub3(v + 6, v, edge2);
+        Cross3(edge1, edge2, normal);
+        area += 0.5f * sqrtf(Dot3(normal, normal));
+        obj.cumulativeArea.push_back(area);
+    }
+    for (int k = 0; k < 3; k++) {
+        obj.boxMin[k] = obj.boxMax[k] = obj.verts.empty() ? 0.0f : obj.verts[k];
+    }
+    for (size_t i = 0; i < obj.verts.size(); i += 3) {
+        for (int k = 0; k < 3; k++) {
+            obj.boxMin[k] = std::min(obj.boxMin[k], obj.verts[i + k]);
+            obj.boxMax[k] = std::max(obj.boxMax[k], obj.verts[i + k]);
+        }
+    }
+    ClearVisibility();
+    return (int)objects.size() - 1;
+}
+
+// **********************************************
+// Bake each cell on the workers.  Every cell writes only its own row.
+// **********************************************
+void MapPvs::Bake(int raysPerPair)
+{
+    CpuProfileZone zone("MapPvs::Bake");
+    ClearVisibility();
+    blockers.Build();
+    int numCells = GetNumCells();
+    visibility.assign((size_t)numCells * rowBytes, 0);
+    std::vector<long long> cellRays(numCells, 0);
+    WorkerPool::ParallelFor(numCells, 1, [&](int begin, int end) {
+        CpuProfileZone cellZone("PVS cell");
+        for (int cell = begin; cell < end; cell++) {
+            BakeCell(cell, raysPerPair, &cellRays[cell]);
+        }
+    });
+    numRaysTraced = 0;
+    for (long long numRays : cellRays) {
+        numRaysTraced += numRays;
+    }
+    CountVisible();
+    hasVisibility = true;
+}
+
+// An object is visible from the cell if a segment from a random eye point in
+//    the cell to a random point on one of its front facing triangles is not
+//    blocked.  The random points are seeded by the cell, so a bake can be repeated.
+void MapPvs::BakeCell(int cell, int raysPerPair, long long* numRays)
+{
+    int cx = cell % cellsX;
+    int cz = cell / cellsX;
+    float cellSizeX = (maxX - minX) / cellsX;
+    float cellSizeZ = (maxZ - minZ) / cellsZ;
+    float cellMin[3] = { minX + cx * cellSizeX, eyeMin, minZ + cz * cellSizeZ };
+    float cellMax[3] = { cellMin[0] + cellSizeX, eyeMax, cellMin[2] + cellSizeZ };
+    unsigned char* row = &visibility[(size_t)cell * rowBytes];
+    PvsRandom random(0x9e3779b9u * (unsigned int)(cell + 1));
+
+    for (int i = 0; i < (int)objects.size(); i++) {
+        const Object& obj = objects[i];
+        bool visible = true;
+        for (int k = 0; k < 3; k++) {
+            visible = visible && obj.boxMin[k] <= cellMax[k] && obj.boxMax[k] >= cellMin[k];
+        }
+        int numTriangles = (int)obj.cumulativeArea.size();
+        float totalArea = numTriangles > 0 ? obj.cumulativeArea.back() : 0.0f;
+        for (int r = 0; !visible && r < raysPerPair && totalArea > 0.0f; r++) {
+            float eye[3];
+            for (int k = 0; k < 3; k++) {
+                eye[k] = cellMin[k] + random.Next() * (cellMax[k] - cellMin[k]);
+            }
+            // A triangle chosen by area, and a uniform point in it
+            float pick = random.Next() * totalArea;
+            int t = (int)(std::upper_bound(obj.cumulativeArea.begin(), obj.cumulativeArea.end(), pick)
+                          - obj.cumulativeArea.begin());
+            t = std::min(t, numTriangles - 1);
+            const float* v = &obj.verts[(size_t)9 * t];
+            float edge1[3], edge2[3], normal[3], toEye[3];
+            Sub3(v + 3, v, edge1);
+            Sub3(v + 6, v, edge2);
+            Cross3(edge1, edge2, normal);
+            Sub3(eye, v, toEye);
+            float s = random.Next(), u = random.Next();
+            if (Dot3(normal, toEye) <= 0.0f) {
+                continue;               // Seen from behind: back faces are not drawn
+            }
+            if (s + u > 1.0f) {
+                s = 1.0f - s;
+                u = 1.0f - u;
+            }
+            float target[3];
+            for (int k = 0; k < 3; k++) {
+                target[k] = v[k] + s * edge1[k] + u * edge2[k];
+            }
+            (*numRays)++;
+            visible = !SegmentBlocked(eye, target);
+        }
+        if (visible) {
+            row[i >> 3] |= (unsigned char)(1 << (i & 7));
+        }
+    }
+}
+
+// Does a front facing blocker triangle cross the segment (not counting its ends)?
+//    The ends are trimmed by epsilon of the segment, so that the target's own
+//    wall, or a wall the eye touches, does not block it.
+bool MapPvs::SegmentBlocked(const float from[3], const float to[3]) const
+{
+    const float epsilon = 1.0e-4f;
+    float dir[3];
+    Sub3(to, from, dir);
+    BvhRay ray;
+    for (int k = 0; k < 3; k++) {
+        ray.origin[k] = from[k] + epsilon * dir[k];
+        ray.direction[k] = (1.0f - 2.0f * epsilon) * dir[k];
+    }
+    ray.tMax = 1.0f;
+    return blockers.Occluded(ray);
+}
+
+int MapPvs::FindCell(double x, double y, double z) const
+{
+    if (!hasVisibility || x < minX || x >= maxX || z < minZ || z >= maxZ || y < eyeMin || y > eyeMax) {
+        return -1;
+    }
+    int cx = std::min((int)((x - minX) / (maxX - minX) * cellsX), cellsX - 1);
+    int cz = std::min((int)((z - minZ) / (maxZ - minZ) * cellsZ), cellsZ - 1);
+    return cz * cellsX + cx;
+}
+
+void MapPvs::CountVisible()
+{
+    cellNumVisible.assign(GetNumCells(), 0);
+    for (int cell = 0; cell < GetNumCells(); cell++) {
+        const unsigned char* row = CellRow(cell);
+        for (int i = 0; i < (int)objects.size(); i++) {
+            cellNumVisible[cell] += (row[i >> 3] >> (i & 7)) & 1;
+        }
+    }
+}
+
+// **********************************************
+// The file: the magic "PVS1", the grid (cellsX, cellsZ, the number of objects
+//    as ints; minX, minZ, maxX, maxZ, eyeMin, eyeMax as floats), then the
+//    bit matrix.  Written in the machine's byte order.
+// **********************************************
+bool MapPvs::Save(const char* filename) const
+{
+    if (!hasVisibility) {
+        printf("PVS: nothing baked to save.\n");
+        return false;
+    }
+    FILE* outfile = fopen(filename, "wb");
+    if (outfile == nullptr) {
+        printf("PVS: unable to open %s for writing.\n", filename);
+        return false;
+    }
+    int header[3] = { cellsX, cellsZ, (int)objects.size() };
+    float bounds[6] = { minX, minZ, maxX, maxZ, eyeMin, eyeMax };
+    bool ok = fwrite(PvsFileMagic, 1, 4, outfile) == 4
+        && fwrite(header, sizeof(int), 3, outfile) == 3
+        && fwrite(bounds, sizeof(float), 6, outfile) == 6
+        && fwrite(visibility.data(), 1, visibility.size(), outfile) == visibility.size();
+    fclose(outfile);
+    if (!ok) {
+        printf("PVS: unable to write %s.\n", filename);
+    }
+    return ok;
+}
+
+bool MapPvs::Load(const char* filename)
+{
+    FILE* infile = fopen(filename, "rb");
+    if (infile == nullptr) {
+        printf("PVS: unable to open %s.\n", filename);
+        return false;
+    }
+    char magic[4];
+    int header[3];
+    float bounds[6];
+    bool ok = fread(magic, 1, 4, infile) == 4 && memcmp(magic, PvsFileMagic, 4) == 0
+        && fread(header, sizeof(int), 3, infile) == 3
+        && fread(bounds, sizeof(float), 6, infile) == 6
+        && header[0] > 0 && header[1] > 0;
+    if (ok && header[2] != (int)objects.size()) {
+        printf("PVS: %s was baked for %d objects, not %d.\n", filename, header[2], (int)objects.size());
+        fclose(infile);
+        return false;
+    }
+    if (ok) {
+        SetGrid(bounds[0], bounds[1], bounds[2], bounds[3], header[0], header[1], bounds[4], bounds[5]);
+        visibility.resize((size_t)GetNumCells() * rowBytes);
+        ok = fread(visibility.data(), 1, visibility.size(), infile) == visibility.size();
+    }
+    fclose(infile);
+    if (!ok) {
+        printf("PVS: %s is not a PVS file, or is cut short.\n", filename);
+        ClearVisibility();
+        return false;
+    }
+    CountVisible();
+    hasVisibility = true;
+    return true;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+//
+// MapPvs.h  ---  Header file for MapPvs.cpp
+//
+//   A potentially visible set (PVS) for a static map, baked offline.
+//   The walkable rectangle of the map is divided into a grid of cells; each
+//   cell is a column from eyeMin to eyeMax above it.  For each cell, one bit
+//   per object says whether the object can be seen from anywhere in the cell.
+//
+//   Baking (--bake-pvs) samples rays from random eye points in each cell to
+//   random points on each object's front facing triangles, against the
+//   blockers (the static walls).  An object is visible as soon as one ray
+//   reaches it; objects that reach into the cell are always visible.  The
+//   cells are baked on the worker threads (see WorkerPool.h), and the same
+//   bake always gives the same bits.  The blockers are kept in a TriangleBvh,
+//   so each ray visits only the walls near it.  Only front faces block rays,
+//   since the walls are one sided and back faces are culled.
+//
+//   At runtime, the camera's cell gives its row of bits in O(1), and the
+//   renderers skip the objects whose bits are clear (see BuildPackets in
+//   GlSceneRenderer.h and GlInstancedModules.h).  A camera outside all the
+//   cells gets no row, and everything is drawn as usual.
+//
+//   The file is a small header followed by the bit matrix: one row of
+//   (numObjects + 7) / 8 bytes per cell, the cells by rows of x.
+//
+
+#ifndef MAP_PVS_H
+#define MAP_PVS_H
+
+#include <stddef.h>
+#include <vector>
+#include "TriangleBvh.h"
+
+class LinearMapR4;
+class GlStaticGeometry;
+
+class MapPvs {
+
+public:
+    static constexpr int DefaultRaysPerPair = 2048;     // Rays from a cell to an object before it is called hidden
+
+    MapPvs() { blockers.SetFrontFacesOnly(true); }
+
+    // The cells: cellsX x cellsZ columns over the rectangle [minX,maxX] x [minZ,maxZ],
+    //    for eyes from height eyeMin to eyeMax.  Clears the visibility.
+    void SetGrid(float minX, float minZ, float maxX, float maxZ, int cellsX, int cellsZ, float eyeMin, float eyeMax);
+    int GetNumCells() const { return cellsX * cellsZ; }
+
+    // The geometry for baking, in world coordinates.  The triangles of the mesh
+    //    are placed by the model matrix (nullptr for the identity).
+    //    Objects are numbered in the order they are added (returns the object's number).
+    //    Clears the visibility.
+    void ClearGeometry();
+    void AddBlocker(const GlStaticGeometry& geometry, int mesh, const LinearMapR4* modelMatrix = nullptr);
+    int AddObject(const GlStaticGeometry& geometry, int mesh, const LinearMapR4* modelMatrix = nullptr);
+    int GetNumObjects() const { return (int)objects.size(); }
+
+    // Compute the visibility of every object from every cell.
+    void Bake(int raysPerPair = DefaultRaysPerPair);
+    long long NumRaysTraced() const { return numRaysTraced; }   // In the last Bake
+
+    // Save the visibility, or load a visibility baked for the same grid and objects.
+    bool Save(const char* filename) const;
+    bool Load(const char* filename);
+    bool HasVisibility() const { return hasVisibility; }
+
+    // The cell that contains the point (x,y,z), or -1 if none does
+    int FindCell(double x, double y, double z) const;
+    // Bit i of the row (byte i/8, bit i%8) is set if object i may be visible from the cell
+    const unsigned char* CellRow(int cell) const { return &visibility[(size_t)cell * rowBytes]; }
+    int NumVisible(int cell) const { return cellNumVisible[cell]; }    // The number of objects visible from the cell
+
+private:
+    float minX = 0.0f, minZ = 0.0f, maxX = 0.0f, maxZ = 0.0f;
+    int cellsX = 0, cellsZ = 0;
+    float eyeMin = 0.0f, eyeMax = 0.0f;
+
+    TriangleBvh blockers;                   // Built by Bake
+    // The objects' triangles: 9 floats each (three vertices), in world coordinates
+    struct Object {
+        std::vector<float> verts;
+        std::vector<float> cumulativeArea;  // Sum of the areas of the triangles up to and including each
+        float boxMin[3], boxMax[3];
+    };
+    std::vector<Object> objects;
+    static void AddTriangles(std::vector<float>& verts, const GlStaticGeometry& geometry, int mesh,
+                             const LinearMapR4* modelMatrix);
+
+    int rowBytes = 0;
+    std::vector<unsigned char> visibility;  // rowBytes per cell
+    std::vector<int> cellNumVisible;        // The bits set in each cell's row
+    bool hasVisibility = false;
+    long long numRaysTraced = 0;
+    void ClearVisibility();
+    void CountVisible();
+
+    void BakeCell(int cell, int raysPerPair, long long* numRays);
+    bool SegmentBlocked(const float from[3], const float to[3]) const;
+};
+
+#endif // MAP_PVS_H
@@ -24,6 +24,21 @@
 #include "GlGeomCylinder.h"
 #include "GlGeomSphere.h"
 #include "GlGeomTorus.h"
+#include "GlStaticGeometry.h"
+#include "GlSceneRenderer.h"
+#include "GlInstancedModules.h"
+#include "GlFrustum.h"
+#include "SoftwareOcclusion.h"
+#include "MapPvs.h"
+#include "TriangleBvh.h"
+#include "GlStateCache.h"
+#include "GlDebugOutput.h"
+#include "GlGpuProfiler.h"
+#include "CpuProfiler.h"
+#include "WorkerPool.h"
+#include <math.h>
+#include <vector>
+#include <algorithm>
 
 // **********************************
 // Material to underlie a texture map.
@@ -57,7 +72,7 @@ GlGeomTorus texTorus(4, 4, 0.75);
 // General data helping with setting up VAO (Vertex Array Objects)
 //    and Vertex Buffer Objects.
 // ***********************
-const int NumObjects = 76;
+const int NumObjects = 19;
 const int iFloor = 0;
 const int iCircularSurf = 1;
 const int iWall = 2;            // RESERVED FOR USE BY 155A PROJECT
@@ -65,101 +80,123 @@ const int iWall2 = 3;
 const int iWall3 = 4;
 const int iWall4 = 5;
 
-const int iMiddle = 6;
-const int iMiddle2 = 7;
-const int iMiddle3 = 8;
-const int iMiddle4 = 9;
-const int icover = 10;
-
-const int iMiddle5 = 11;
-const int iMiddle6 = 12;
-const int iMiddle7 = 13;
-const int iMiddle8 = 14;
-const int icover2 = 15;
-
-const int iMiddle9 = 16;
-const int iMiddle10 = 17;
-const int iMiddle11 = 18;
-const int iMiddle12 = 19;
-const int icover3 = 20;
-
-const int iMiddle13 = 21;
-const int iMiddle14 = 22;
-const int iMiddle15 = 23;
-const int iMiddle16 = 24;
-const int icover4 = 25;
-
-const int iSideWall1 = 26;
-const int iSideWall2 = 27;
-const int iSideWall3 = 28;
-const int iSideCover1 = 29;
-
-const int iSideWall4 = 30;
-const int iSideWall5 = 31;
-const int iSideWall6 = 32;
-const int iSideCover2 = 33;
-
-const int iSideWall7 = 34;
-const int iSideWall8 = 35;
-const int iSideWall9 = 36;
-const int iSideCover3 = 37;
-
-const int iSideWall10 = 38;
-const int iSideWall11 = 39;
-const int iSideWall12 = 40;
-const int iSideCover4 = 41;
-
-const int iSideWall13 = 42;
-const int iSideWall14 = 43;
-const int iSideWall15 = 44;
-const int iSideCover5 = 45;
-
-const int iSideWall16 = 46;
-const int iSideWall17 = 47;
-const int iSideWall18 = 48;
-const int iSideCover6 = 49;
-
-const int iCorner1 = 50;
-const int iCorner2 = 51;
-const int iCorner3 = 52;
-const int iCorner4 = 53;
-
-const int im1 = 54;
-const int im2 = 55;
-const int im3 = 56;
-const int im4 = 57;
-const int im5 = 58;
-const int im6 = 59;
-
-const int try1 = 60;
-const int try2 = 61;
-const int try3 = 62;
-const int try4 = 63;
-
-const int try5 = 64;
-const int try6 = 65;
-const int try7 = 66;
-const int try8 = 67;
-
-const int try9 = 68;
-const int try10 = 69;
-const int try11 = 70;
-const int try12 = 71;
-
-const int try13 = 72;
-const int try14 = 73;
-const int try15 = 74;
-const int try16 = 75;
-
-unsigned int myVBO[NumObjects];  // a Vertex Buffer Object holds an array of data
-unsigned int myVAO[NumObjects];  // a Vertex Array Object - holds info about an array of vertex data;
-unsigned int myEBO[NumObjects];  // a Element Array Buffer Object - holds an array of elements (vertex indices)
+// Modules: each is modeled once and drawn once per instance (see myModules).
+const int iCrate = 6;           // iMiddle..iMiddle4 and try1..try4 (the other crates are copies)
+const int iSideBox = 7;         // iSideWall1..iSideWall3 and iSideCover1
+const int iSideRamp = 8;        // iSideWall7..iSideWall9 and iSideCover3
+
+const int iCorner1 = 9;
+const int iCorner2 = 10;
+const int iCorner3 = 11;
+const int iCorner4 = 12;
+
+const int im1 = 13;
+const int im2 = 14;
+const int im3 = 15;
+const int im4 = 16;
+const int im5 = 17;
+const int im6 = 18;
+
+// All the map objects are packed into one VBO and one EBO (with one VAO).
+// myMeshes[i] is the index of object i's mesh in myStaticGeometry, or -1 if it has no mesh.
+GlStaticGeometry myStaticGeometry;
+int myMeshes[NumObjects];
+
+// The map modeled each copy of a module on its own, and some copies differ from
+//    the module on a few faces: other texture coordinates, or the normal turned around.
+//    Such a copy is drawn from a mesh of its own, the module's mesh with these faces changed.
+//    Its positions are the module's, so its instance matrix still places it.
+struct MyCopyFace {
+    int object;                 // The module: iCrate, iSideBox or iSideRamp
+    int copy;                   // The copy, in the order of the module's instances
+    int firstVertex;            // The face's vertices, in the order they were added to the module's mesh
+    int numVertices;
+    bool flipNormal;
+    const float* texCoords;     // Two per vertex, or nullptr to keep the module's
+};
+
+const float myQuadTurned[] = { 1.0f, 1.0f,  1.0f, 0.0f,  0.0f, 1.0f,  0.0f, 0.0f };
+const float myQuadFlipped[] = { 0.0f, 0.0f,  0.0f, 1.0f,  1.0f, 0.0f,  1.0f, 1.0f };
+const float myCrateTop1[] = { 0.0f, 0.14f,  0.14f, 0.0f,  0.86f, 0.0f,  1.0f, 0.14f,  1.0f, 1.0f,  0.14f, 1.0f,  0.0f, 0.86f };
+const float myCrateTop2[] = { 1.0f, 0.86f,  0.86f, 1.0f,  0.14f, 1.0f,  0.0f, 0.93f,  0.0f, 0.0f,  0.93f, 0.0f,  1.0f, 0.14f };
+const float myCrateTop3[] = { 0.14f, 1.0f,  0.0f, 0.86f,  0.0f, 0.14f,  0.07f, 0.0f,  1.0f, 0.0f,  1.0f, 0.93f,  0.86f, 1.0f };
+
+const MyCopyFace myCopyFaces[] = {
+    { iCrate, 1, 28, 7, false, myCrateTop1 },           // try4
+    { iCrate, 2, 4, 4, false, myQuadTurned },           // try1
+    { iCrate, 2, 12, 4, false, myQuadTurned },          // try2
+    { iCrate, 2, 28, 7, false, myCrateTop2 },
+    { iCrate, 3, 4, 4, false, myQuadTurned },
+    { iCrate, 3, 12, 4, false, myQuadTurned },
+    { iCrate, 3, 28, 7, false, myCrateTop3 },
+
+    { iSideBox, 1, 0, 4, true, nullptr },               // sidewall1
+    { iSideBox, 1, 4, 4, true, nullptr },               // sidewall2
+    { iSideBox, 1, 12, 4, false, myQuadTurned },        // isideCover1
+    { iSideBox, 2, 0, 4, true, nullptr },
+    { iSideBox, 2, 4, 4, true, nullptr },
+    { iSideBox, 2, 8, 4, true, myQuadTurned },          // sidewall3
+    { iSideBox, 3, 8, 4, true, myQuadTurned },
+    { iSideBox, 3, 12, 4, false, myQuadTurned },
+
+    { iSideRamp, 1, 8, 4, false, myQuadTurned },        // sidewall9
+    { iSideRamp, 1, 12, 4, false, myQuadFlipped },      // sidecover3
+};
+
+// The meshes of the modules' copies ([0] is the module's own mesh, as is any copy that does not differ).
+const int NumCrateCopies = 4;
+const int NumSideBoxCopies = 4;
+const int NumSideRampCopies = 2;
+int myCrateCopyMeshes[NumCrateCopies];
+int mySideBoxCopyMeshes[NumSideBoxCopies];
+int mySideRampCopyMeshes[NumSideRampCopies];
+
+// Add the meshes for the copies of a module that differ from it.  Call after the module's mesh is complete.
+void MySetupCopyMeshes(int object, int numCopies, int* copyMeshes)
+{
+    const GlMeshRange& range = myStaticGeometry.GetMesh(myMeshes[object]);
+    const int stride = GlStaticGeometry::FloatsPerVertex;
+    for (int copy = 0; copy < numCopies; copy++) {
+        copyMeshes[copy] = myMeshes[object];
+        std::vector<float> verts;
+        for (const MyCopyFace& face : myCopyFaces) {
+            if (face.object != object || face.copy != copy) {
+                continue;
+            }
+            if (verts.empty()) {
+                const float* moduleVerts = myStaticGeometry.GetVertexData().data() + range.baseVertex * stride;
+                verts.assign(moduleVerts, moduleVerts + range.numVertices * stride);
+            }
+            assert(face.firstVertex + face.numVertices <= range.numVertices);
+            for (int i = 0; i < face.numVertices; i++) {
+                float* v = &verts[(face.firstVertex + i) * stride];
+                if (face.flipNormal) {
+                    v[3] = -v[3];
+                    v[4] = -v[4];
+                    v[5] = -v[5];
+                }
+                if (face.texCoords != nullptr) {
+                    v[6] = face.texCoords[2 * i];
+                    v[7] = face.texCoords[2 * i + 1];
+                }
+            }
+        }
+        if (!verts.empty()) {
+            // The module's triangles, which are relative to its first vertex (copied: AddMesh may grow the data)
+            const unsigned int* moduleElts = myStaticGeometry.GetElementData().data() + range.firstIndex;
+            std::vector<unsigned int> elts(moduleElts, moduleElts + range.numIndices);
+            copyMeshes[copy] = myStaticGeometry.AddMesh(GL_TRIANGLES, verts.data(), range.numVertices,
+                                                        elts.data(), range.numIndices);
+        }
+    }
+}
 
 // ********************************************
 // This sets up for texture maps. It is called only once
 // ********************************************
 void SetupForTextures()
 {
+    CpuProfileZone zone("SetupForTextures");
     // This material goes under the textures.
     // IF YOU WISH, YOU MAY DEFINE MORE THAN ONE OF THESE FOR DIFFERENT GEOMETRIES
     materialUnderTexture.SpecularColor.Set(0.9, 0.9, 0.9);
@@ -172,12 +209,13 @@ void SetupForTextures()
 	// ***********************************************
     RgbImage texMap;
 
-    glUseProgram(shaderProgramBitmap);
-    glActiveTexture(GL_TEXTURE0);
+    GlStateCache::UseProgram(shaderProgramBitmap);
+    GlStateCache::ActiveTexture(GL_TEXTURE0);
     glGenTextures(NumTextures, TextureNames);
     for (int i = 0; i < NumTextures; i++) {
         texMap.LoadBmpFile(TextureFiles[i]);            // Read i-th texture from the i-th file.
-        glBindTexture(GL_TEXTURE_2D, TextureNames[i]);  // Bind (select) the i-th OpenGL texture
+        GlStateCache::BindTexture2D(TextureNames[i]);  // Bind (select) the i-th OpenGL texture
+        GlDebugOutput::LabelObject(GL_TEXTURE, TextureNames[i], TextureFiles[i]);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -202,9 +240,23 @@ void SetupForTextures()
     }
 
     // Make sure that the shaderProgramBitmap uses the GL_TEXTURE_0 texture.
-    glUseProgram(shaderProgramBitmap);
-    glUniform1i(glGetUniformLocation(shaderProgramBitmap, "theTextureMap"), 0);
-    glActiveTexture(GL_TEXTURE0);
+    GlStateCache::UseProgram(shaderProgramBitmap);
+    GlStateCache::Uniform1i(glGetUniformLocation(shaderProgramBitmap, "theTextureMap"), 0);
+    if (shaderProgramInstanced != 0) {
+        GlStateCache::UseProgram(shaderProgramInstanced);
+        GlStateCache::Uniform1i(glGetUniformLocation(shaderProgramInstanced, "theTextureMap"), 0);
+    }
+    if (shaderProgramDrawData != 0) {
+        GlStateCache::UseProgram(shaderProgramDrawData);
+        GlStateCache::Uniform1i(glGetUniformLocation(shaderProgramDrawData, "theTextureMap"), 0);
+    }
+    if (shaderProgramObjectData != 0) {
+        GlStateCache::UseProgram(shaderProgramObjectData);
+        GlStateCache::Uniform1i(glGetUniformLocation(shaderProgramObjectData, "theTextureMap"), 0);
+    }
+    GlStateCache::ActiveTexture(GL_TEXTURE0);
+
+    MySetupSceneTable();      // The meshes and the textures are ready: build the scene table.
 
 
 }
@@ -225,19 +277,15 @@ void MySetupSurfaces() {
     texCylinder.InitializeAttribLocations(vertPos_loc, vertNormal_loc, vertTexCoords_loc);
     texTorus.InitializeAttribLocations(vertPos_loc, vertNormal_loc, vertTexCoords_loc);
 
-    // Initialize the VAO's, VBO's and EBO's for the ground plane, the back wall
-    // and the surface of rotation. Gives them the "vertPos" location,
-    // and the "vertNormal"  and the "vertTexCoords" locations in the shader program.
-    // No data is loaded into the VBO's or EBO's for the circular surface until the "Remesh"
-    //   routines is called
-
-    glGenVertexArrays(NumObjects, &myVAO[0]);
-    glGenBuffers(NumObjects, &myVBO[0]);
-    glGenBuffers(NumObjects, &myEBO[0]);
+    // Each map object is added as a mesh to myStaticGeometry.
+    // At the end, all meshes are loaded into a single VAO, VBO and EBO, with the
+    //    "vertPos" location, and the "vertNormal" and the "vertTexCoords" locations
+    //    in the shader program.
+    for (int i = 0; i < NumObjects; i++) {
+        myMeshes[i] = -1;
+    }
 
     // For the Floor:
-    // Allocate the needed Vertex Array Objects (VAO's),
-    //      Vertex Buffer Objects (VBO's) and Element Array Buffer Objects (EBO's)
     // Since the floor has only four vertices.  Each vertex stores its
     //    position, its normal (0,1,0) and its (s,t)-coordinates.
     // YOU DO NOT NEED TO REMESH THE FLOOR (OR THE BACK WALL) SINCE WE USE PHONG INTERPOLATION
@@ -249,17 +297,7 @@ void MySetupSurfaces() {
         -7.5f, 0.0f,  7.5f,      0.0f, 1.0f, 0.0f,          0.0f, 0.0f,         // Front left
     };
     unsigned int floorElts[] = { 0, 3, 1, 2 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iFloor]);
-    glBindVertexArray(myVAO[iFloor]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(floorVerts), floorVerts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									// Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3*sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									// Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									// Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iFloor]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(floorElts), floorElts, GL_STATIC_DRAW);
+    myMeshes[iFloor] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, floorVerts, floorElts);
 
    
     float wallVerts[] = {
@@ -271,17 +309,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int wallElts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iWall]);
-    glBindVertexArray(myVAO[iWall]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(wallVerts), wallVerts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iWall]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(wallElts), wallElts, GL_STATIC_DRAW);
+    myMeshes[iWall] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, wallVerts, wallElts);
 
     float wall2Verts[] = {
         // Position              // Normal                  // Texture coordinates
@@ -292,18 +320,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int wall2Elts[] = { 2, 3, 0, 1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iWall2]);
-    glBindVertexArray(myVAO[iWall2]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(wall2Verts), wall2Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iWall2]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(wall2Elts), wall2Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myMeshes[iWall2] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, wall2Verts, wall2Elts);
 
     float wall3Verts[] = {
         // Position              // Normal                  // Texture coordinates
@@ -314,18 +331,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int wall3Elts[] = { 2, 3, 0, 1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iWall3]);
-    glBindVertexArray(myVAO[iWall3]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(wall3Verts), wall3Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iWall3]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(wall3Elts), wall3Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myMeshes[iWall3] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, wall3Verts, wall3Elts);
 
     float wall4Verts[] = {
         // Position              // Normal                  // Texture coordinates
@@ -336,19 +342,10 @@ void MySetupSurfaces() {
     };
 
     unsigned int wall4Elts[] = { 2, 3, 0, 1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iWall4]);
-    glBindVertexArray(myVAO[iWall4]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(wall4Verts), wall4Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iWall4]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(wall4Elts), wall4Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myMeshes[iWall4] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, wall4Verts, wall4Elts);
 
+    // The crate module: the four sides, the three beveled edges and the top of one crate.
+    // The four crates in the map are instances of it (see MySetupCrateField()).
     float middleVerts[] = {
         // Position              // Normal                  // Texture coordinates
         -4.5f, 3.0f, -4.5f,     -1.0f, 0.0f, 0.0f,          0.0f, 1.0f,        // upper left
@@ -359,18 +356,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int middleElts[] = { 0, 1, 2, 3};
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle]);
-    glBindVertexArray(myVAO[iMiddle]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middleVerts), middleVerts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middleElts), middleElts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myMeshes[iCrate] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, middleVerts, middleElts);
 
     float try1Verts[] = {
         // Position              // Normal                  // Texture coordinates
@@ -382,18 +368,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int try1Elts[] = { 2,3,0,1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try1]);
-    glBindVertexArray(myVAO[try1]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try1Verts), try1Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try1Elts), try1Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myStaticGeometry.AppendToMesh(myMeshes[iCrate], GL_TRIANGLE_STRIP, try1Verts, try1Elts);
 
     float middle2Verts[] = {
         // Position              // Normal                  // Texture coordinates
@@ -405,18 +380,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int middle2Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle2]);
-    glBindVertexArray(myVAO[iMiddle2]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middle2Verts), middle2Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle2]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middle2Elts), middle2Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myStaticGeometry.AppendToMesh(myMeshes[iCrate], GL_TRIANGLE_STRIP, middle2Verts, middle2Elts);
 
     float try2Verts[] = {
         // Position              // Normal                  // Texture coordinates
@@ -428,18 +392,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int try2Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try2]);
-    glBindVertexArray(myVAO[try2]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try2Verts), try2Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try2]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try2Elts), try2Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myStaticGeometry.AppendToMesh(myMeshes[iCrate], GL_TRIANGLE_STRIP, try2Verts, try2Elts);
 
 
     float middle3Verts[] = {
@@ -452,18 +405,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int middle3Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle3]);
-    glBindVertexArray(myVAO[iMiddle3]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middle3Verts), middle3Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle3]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middle3Elts), middle3Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myStaticGeometry.AppendToMesh(myMeshes[iCrate], GL_TRIANGLE_STRIP, middle3Verts, middle3Elts);
 
     float try3Verts[] = {
         // Position              // Normal                  // Texture coordinates
@@ -475,18 +417,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int try3Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try3]);
-    glBindVertexArray(myVAO[try3]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try3Verts), try3Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try3]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try3Elts), try3Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myStaticGeometry.AppendToMesh(myMeshes[iCrate], GL_TRIANGLE_STRIP, try3Verts, try3Elts);
 
 
     float middle4Verts[] = {
@@ -499,18 +430,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int middle4Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle4]);
-    glBindVertexArray(myVAO[iMiddle4]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middle4Verts), middle4Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle4]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middle4Elts), middle4Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myStaticGeometry.AppendToMesh(myMeshes[iCrate], GL_TRIANGLE_STRIP, middle4Verts, middle4Elts);
 
     float try4Verts[] = {
         // Position              // Normal                  // Texture coordinates
@@ -525,633 +445,11 @@ void MySetupSurfaces() {
     };
 
     unsigned int try4Elts[] = { 0, 1, 2, 3, 4, 5, 6};
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try4]);
-    glBindVertexArray(myVAO[try4]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try4Verts), try4Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try4]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try4Elts), try4Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float middle5Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -4.5f + 5.25f, 3.0f, -4.0f,     -1.0f, 0.0f, 0.0f,          0.0f, 1.0f,        // upper left
-        -4.5f + 5.25f, 0.0f, -4.0f,     -1.0f, 0.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        -4.5f + 5.25f, 3.0f, -1.25f,    -1.0f, 0.0f, 0.0f,          1.0f, 1.0f,       // upper right
-        -4.5f + 5.25f, 0.0f, -1.25f,    -1.0f, 0.0f, 0.0f,          1.0f, 0.0f,         // lower right
-    };
-
-    unsigned int middle5Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle5]);
-    glBindVertexArray(myVAO[iMiddle5]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middle5Verts), middle5Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle5]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middle5Elts), middle5Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float try5Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        0.75f, 3.0f, -4.0f,     -2.0f, 0.0f, -1.0f,          0.0f, 1.0f,        // upper left
-        0.75f, 0.0f, -4.0f,     -2.0f, 0.0f, -1.0f,          0.0f, 0.0f,         // lower left
-
-        1.0f, 3.0f, -4.5f,    -2.0f, 0.0f, -1.0f,          1.0f, 1.0f,       // upper right
-        1.0f, 0.0f, -4.5f,    -2.0f, 0.0f, -1.0f,          1.0f, 0.0f,         // lower right
-    };
-
-    unsigned int try5Elts[] = { 2,3,0,1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try5]);
-    glBindVertexArray(myVAO[try5]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try5Verts), try5Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try5]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try5Elts), try5Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float middle6Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -4.5f + 5.75f, 3.0f, -0.75f,      0.0f, 0.0f, 1.0f,          0.0f, 1.0f,         // upper left
-        -4.5f + 5.75f, 0.0f, -0.75f,      0.0f, 0.0f, 1.0f,          0.0f, 0.0f,         // lower left
-
-        4.0f, 3.0f, -0.75f,     0.0f, 0.0f, 1.0f,          1.0f, 1.0f,        // upper right
-        4.0f, 0.0f, -0.75f,     0.0f, 0.0f, 1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int middle6Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle6]);
-    glBindVertexArray(myVAO[iMiddle6]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middle6Verts), middle6Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle6]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middle6Elts), middle6Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float try6Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        0.75f, 3.0f, -1.25f,      -1.0f, 0.0f, 1.0f,          0.0f, 1.0f,         // upper left
-        0.75f, 0.0f, -1.25f,      -1.0f, 0.0f, 1.0f,          0.0f, 0.0f,         // lower left
-
-        1.25f, 3.0f, -0.75f,     -1.0f, 0.0f, 1.0f,          1.0f, 1.0f,        // upper right
-        1.25f, 0.0f, -0.75f,     -1.0f, 0.0f, 1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int try6Elts[] = { 0,1,2,3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try6]);
-    glBindVertexArray(myVAO[try6]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try6Verts), try6Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try6]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try6Elts), try6Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-
-    float middle7Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -0.75f + 5.25f, 3.0f, -1.0f,      1.0f, 0.0f, 0.0f,          0.0f, 1.0f,         // upper left
-        -0.75f + 5.25f, 0.0f, -1.0f,      1.0f, 0.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        -0.75f + 5.25f, 3.0f, -4.5f,     1.0f, 0.0f, 0.0f,          1.0f, 1.0f,        // upper right
-        -0.75f + 5.25f, 0.0f, -4.5f,     1.0f, 0.0f, 0.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int middle7Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle7]);
-    glBindVertexArray(myVAO[iMiddle7]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middle7Verts), middle7Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle7]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middle7Elts), middle7Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float try7Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        4.0f, 3.0f, -0.75f,      1.0f, 0.0f, 2.0f,          0.0f, 1.0f,         // upper left
-        4.0f, 0.0f, -0.75f,      1.0f, 0.0f, 2.0f,          0.0f, 0.0f,         // lower left
-
-        4.5f, 3.0f, -1.0f,     1.0f, 0.0f, 2.0f,          1.0f, 1.0f,        // upper right
-        4.5f, 0.0f, -1.0f,     1.0f, 0.0f, 2.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int try7Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try7]);
-    glBindVertexArray(myVAO[try7]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try7Verts), try7Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try7]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try7Elts), try7Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float middle8Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -0.75f + 5.25f, 3.0f, -4.5f,       0.0f, 0.0f, -1.0f,          0.0f, 1.0f,         // upper left
-        -0.75f + 5.25f, 0.0f, -4.5f,       0.0f, 0.0f, -1.0f,          0.0f, 0.0f,         // lower left
-
-        -4.5f + 5.5f, 3.0f, -4.5f,        0.0f, 0.0f, -1.0f,          1.0f, 1.0f,        // upper right
-        -4.5f + 5.5f, 0.0f, -4.5f,        0.0f, 0.0f, -1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int middle8Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle8]);
-    glBindVertexArray(myVAO[iMiddle8]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middle8Verts), middle8Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle8]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middle8Elts), middle8Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-
-    float try8Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        4.0f, 3.0f, -0.75f,       0.0f, 1.0f, 0.0f,          0.86f,0.0f,
-        4.5f, 3.0f, -1.0f,        0.0f, 1.0f, 0.0f,          1.0f, 0.14f,         // upper left
-        4.5f, 3.0f, -4.5f,        0.0f, 1.0f, 0.0f,          1.0f, 1.0f,         // lower left
-        1.0f, 3.0f, -4.5f,        0.0f, 1.0f, 0.0f,          0.14f, 1.0f,        // upper right
-        0.75f, 3.0f, -4.0f,       0.0f, 1.0f, 0.0f,          0.0f, 0.86f,        // lower right
-        0.75, 3.0f, -1.25f,       0.0f, 1.0f, 0.0f,          0.0f, 0.14f,
-        1.25f, 3.0f, -0.75f,       0.0f, 1.0f, 0.0f,          0.14f, 0.0f,
-    };
-
-    unsigned int try8Elts[] = { 0, 1, 2, 3,4,5,6};
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try8]);
-    glBindVertexArray(myVAO[try8]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try8Verts), try8Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try8]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try8Elts), try8Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float middle9Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -4.5f, 3.0f, 1.0f,     -1.0f, 0.0f, 0.0f,          0.0f, 1.0f,        // upper left
-        -4.5f, 0.0f, 1.0f,     -1.0f, 0.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        -4.5f, 3.0f, -0.75f + 5.25f,    -1.0f, 0.0f, 0.0f,          1.0f, 1.0f,       // upper right
-        -4.5f, 0.0f, -0.75f + 5.25f,    -1.0f, 0.0f, 0.0f,          1.0f, 0.0f,         // lower right
-    };
-
-    unsigned int middle9Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle9]);
-    glBindVertexArray(myVAO[iMiddle9]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middle9Verts), middle9Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle9]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middle9Elts), middle9Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float try9Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -1.25f, 3.0f, 0.75f,         1.0f, 0.0f, -1.0f,          0.0f, 1.0f,         // upper left
-        -1.25f, 0.0f, 0.75f,        1.0f, 0.0f, -1.0f,          0.0f, 0.0f,         // lower left
-
-        -0.75f, 3.0f, 1.25f,        1.0f, 0.0f, -1.0f,          1.0f, 1.0f,        // upper right
-        -0.75f, 0.0f, 1.25f,       1.0f, 0.0f, -1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int try9Elts[] = { 2,3,0,1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try9]);
-    glBindVertexArray(myVAO[try9]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try9Verts), try9Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try9]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try9Elts), try9Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float middle10Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -4.5f, 3.0f, -0.75f + 5.25f,      0.0f, 0.0f, 1.0f,          0.0f, 1.0f,         // upper left
-        -4.5f, 0.0f, -0.75f + 5.25f,      0.0f, 0.0f, 1.0f,          0.0f, 0.0f,         // lower left
-
-        -1.0f, 3.0f, -0.75f + 5.25f,     0.0f, 0.0f, 1.0f,          1.0f, 1.0f,        // upper right
-        -1.0f, 0.0f, -0.75f + 5.25f,     0.0f, 0.0f, 1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int middle10Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle10]);
-    glBindVertexArray(myVAO[iMiddle10]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middle10Verts), middle10Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle10]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middle10Elts), middle10Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float try10Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -4.0f, 3.0f, 0.75f,        -1.0f, 0.0f, -2.0f,          0.0f, 1.0f,         // upper left
-        -4.0f, 0.0f, 0.75f,        -1.0f, 0.0f, -2.0f,          0.0f, 0.0f,         // lower left
-
-        -4.5f, 3.0f, 1.0f,        -1.0f, 0.0f, -2.0f,          1.0f, 1.0f,        // upper right
-        -4.5f, 0.0f, 1.0f,        -1.0f, 0.0f, -2.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int try10Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try10]);
-    glBindVertexArray(myVAO[try10]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try10Verts), try10Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try10]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try10Elts), try10Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-
-    float middle11Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -0.75f, 3.0f, -1.25 + 5.25f,      1.0f, 0.0f, 0.0f,          0.0f, 1.0f,         // upper left
-        -0.75f, 0.0f, -1.25f + 5.25f,      1.0f, 0.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        -0.75f, 3.0f, -4.5f + 5.75f,     1.0f, 0.0f, 0.0f,          1.0f, 1.0f,        // upper right
-        -0.75f, 0.0f, -4.5f + 5.75f,     1.0f, 0.0f, 0.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int middle11Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle11]);
-    glBindVertexArray(myVAO[iMiddle11]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middle11Verts), middle11Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle11]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middle11Elts), middle11Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float try11Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -1.0f, 3.0f, 4.5f,        2.0f, 0.0f, 1.0f,          0.0f, 1.0f,         // upper left
-        -1.0f, 0.0f, 4.5f,        2.0f, 0.0f, 1.0f,          0.0f, 0.0f,         // lower left
-
-        -0.75f, 3.0f, 4.0f,        2.0f, 0.0f, 1.0f,          1.0f, 1.0f,        // upper right
-        -0.75f, 0.0f, 4.0f,        2.0f, 0.0f, 1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int try11Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try11]);
-    glBindVertexArray(myVAO[try11]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try11Verts), try11Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try11]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try11Elts), try11Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float middle12Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -1.25f, 3.0f, -4.5 + 5.25f,       0.0f, 0.0f, -1.0f,          0.0f, 1.0f,         // upper left
-        -1.25f, 0.0f, -4.5f + 5.25f,       0.0f, 0.0f, -1.0f,          0.0f, 0.0f,         // lower left
-
-        -4.0f, 3.0f, -4.5f + 5.25f,        0.0f, 0.0f, -1.0f,          1.0f, 1.0f,        // upper right
-        -4.0f, 0.0f, -4.5f + 5.25f,        0.0f, 0.0f, -1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int middle12Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle12]);
-    glBindVertexArray(myVAO[iMiddle12]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middle12Verts), middle12Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle12]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middle12Elts), middle12Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float cover3Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -4.5f, 3.0f, -4.5f + 5.25f,         0.0f, 1.0f, 0.0f,          0.0f, 1.0f,         // upper left
-        -4.5f, 3.0f, -0.75f + 5.25f,        0.0f, 1.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        -0.75f, 3.0f, -4.5f + 5.25f,        0.0f, 1.0f, 0.0f,          1.0f, 1.0f,        // upper right
-        -0.75f, 3.0f, -0.75f +5.25f,       0.0f, 1.0f, 0.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int cover3Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[icover3]);
-    glBindVertexArray(myVAO[icover3]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cover3Verts), cover3Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[icover3]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cover3Elts), cover3Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float try12Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -1.0f, 3.0f, 4.5f,        0.0f, 1.0f, 0.0f,          0.93f, 0.0f,         // upper left
-        -0.75f, 3.0f, 4.0f,        0.0f, 1.0f, 0.0f,          1.0f, 0.14f,         // lower left
-
-        -0.75f, 3.0f, 1.25f,        0.0f, 1.0f, 0.0f,          1.0f, 0.86f,        // upper right
-        -1.25f, 3.0f, 0.75f,        0.0f, 1.0f, 0.0f,          0.86f, 1.0f,        // lower right
-        -4.0f, 3.0f, 0.75f,        0.0f, 1.0f, 0.0f,          0.14f, 1.0f,
-        -4.5f, 3.0f, 1.0f,        0.0f, 1.0f, 0.0f,          0.0f, 0.93f,
-        -4.5f, 3.0f, 4.5f,        0.0f, 1.0f, 0.0f,          0.0f, 0.0f,
-    };
-
-    unsigned int try12Elts[] = { 0, 1, 2, 3,4,5,6};
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try12]);
-    glBindVertexArray(myVAO[try12]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try12Verts), try12Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try12]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try12Elts), try12Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    
-
-
-    float middle13Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -4.5f + 5.25f, 3.0f, 1.25f,     -1.0f, 0.0f, 0.0f,          0.0f, 1.0f,        // upper left
-        -4.5f + 5.25f, 0.0f, 1.25f,     -1.0f, 0.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        -4.5f + 5.25f, 3.0f, 4.0f,    -1.0f, 0.0f, 0.0f,          1.0f, 1.0f,       // upper right
-        -4.5f + 5.25f, 0.0f, 4.0f,    -1.0f, 0.0f, 0.0f,          1.0f, 0.0f,         // lower right
-    };
-
-    unsigned int middle13Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle13]);
-    glBindVertexArray(myVAO[iMiddle13]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middle13Verts), middle13Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle13]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middle13Elts), middle13Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float try13Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        0.75f, 3.0f, 1.25f,        -1.0f, 0.0f, -1.0f,          0.0f, 1.0f,         // upper left
-        0.75f, 0.0f, 1.25f,        -1.0f, 0.0f, -1.0f,          0.0f, 0.0f,         // lower left
-
-        1.25f, 3.0f, 0.75f,        -1.0f, 0.0f, -1.0f,          1.0f, 1.0f,        // upper right
-        1.25f, 0.0f, 0.75f,        -1.0f, 0.0f, -1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int try13Elts[] = { 2,3,0,1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try13]);
-    glBindVertexArray(myVAO[try13]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try13Verts), try13Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try13]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try13Elts), try13Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float middle14Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        1.0f, 3.0f, -0.75f + 5.25f,      0.0f, 0.0f, 1.0f,          0.0f, 1.0f,         // upper left
-        1.0f, 0.0f, -0.75f + 5.25f,      0.0f, 0.0f, 1.0f,          0.0f, 0.0f,         // lower left
-
-        -0.75f + 5.25f, 3.0f, -0.75f + 5.25f,     0.0f, 0.0f, 1.0f,          1.0f, 1.0f,        // upper right
-        -0.75f + 5.25f, 0.0f, -0.75f + 5.25f,     0.0f, 0.0f, 1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int middle14Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle14]);
-    glBindVertexArray(myVAO[iMiddle14]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middle14Verts), middle14Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle14]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middle14Elts), middle14Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float try14Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        0.75f, 3.0f, 4.0f,        -2.0f, 0.0f, 1.0f,          0.0f, 1.0f,         // upper left
-        0.75f, 0.0f, 4.0f,        -2.0f, 0.0f, 1.0f,          0.0f, 0.0f,         // lower left
-
-        1.00f, 3.0f, 4.5f,        -2.0f, 0.0f, 1.0f,          1.0f, 1.0f,        // upper right
-        1.00f, 0.0f, 4.5f,        -2.0f, 0.0f, 1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int try14Elts[] = { 0,1,2,3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try14]);
-    glBindVertexArray(myVAO[try14]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try14Verts), try14Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try14]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try14Elts), try14Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-
-    float middle15Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -0.75f + 5.25f, 3.0f, -0.75f + 5.25f,      1.0f, 0.0f, 0.0f,          0.0f, 1.0f,         // upper left
-        -0.75f + 5.25f, 0.0f, -0.75f + 5.25f,      1.0f, 0.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        -0.75f + 5.25f, 3.0f, 1.0f,     1.0f, 0.0f, 0.0f,          1.0f, 1.0f,        // upper right
-        -0.75f + 5.25f, 0.0f, 1.0f,     1.0f, 0.0f, 0.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int middle15Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle15]);
-    glBindVertexArray(myVAO[iMiddle15]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middle15Verts), middle15Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle15]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middle15Elts), middle15Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float try15Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        4.5f, 3.0f, 1.0f,        1.0f, 0.0f, -2.0f,          0.0f, 1.0f,         // upper left
-        4.5f, 0.0f, 1.0f,        1.0f, 0.0f, -2.0f,          0.0f, 0.0f,         // lower left
-
-        4.0f, 3.0f, 0.75f,        1.0f, 0.0f, -2.0f,          1.0f, 1.0f,        // upper right
-        4.0f, 0.0f, 0.75f,        1.0f, 0.0f, -2.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int try15Elts[] = { 0,1,2,3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try15]);
-    glBindVertexArray(myVAO[try15]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try15Verts), try15Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try15]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try15Elts), try15Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float middle16Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        4.0f, 3.0f, -4.5 + 5.25f,       0.0f, 0.0f, -1.0f,          0.0f, 1.0f,         // upper left
-        4.0f, 0.0f, -4.5f + 5.25f,       0.0f, 0.0f, -1.0f,          0.0f, 0.0f,         // lower left
-
-        1.25f, 3.0f, -4.5f + 5.25f,        0.0f, 0.0f, -1.0f,          1.0f, 1.0f,        // upper right
-        1.25f, 0.0f, -4.5f + 5.25f,        0.0f, 0.0f, -1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int middle16Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iMiddle16]);
-    glBindVertexArray(myVAO[iMiddle16]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(middle16Verts), middle16Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iMiddle16]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(middle16Elts), middle16Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float cover4Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -4.5f + 5.25f, 3.0f, -4.5f + 5.25f,         0.0f, 1.0f, 0.0f,          0.0f, 1.0f,         // upper left
-        -4.5f + 5.25f, 3.0f, -0.75f + 5.25f,        0.0f, 1.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        -0.75f + 5.25f, 3.0f, -4.5f + 5.25f,        0.0f, 1.0f, 0.0f,          1.0f, 1.0f,        // upper right
-        -0.75f + 5.25f, 3.0f, -0.75f + 5.25f,       0.0f, 1.0f, 0.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int cover4Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[icover4]);
-    glBindVertexArray(myVAO[icover4]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cover4Verts), cover4Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[icover4]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cover4Elts), cover4Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float try16Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        1.0f, 3.0f, 4.5f,         0.0f, 1.0f, 0.0f,          0.07f, 0.0f,         // upper left
-        4.5f, 3.0f, 4.5f,        0.0f, 1.0f, 0.0f,          1.0f, 0.0f,         // lower left
-
-        4.5f, 3.0f, 1.0f,        0.0f, 1.0f, 0.0f,          1.0f, 0.93f,        // upper right
-        4.0f, 3.0f, 0.75f,       0.0f, 1.0f, 0.0f,          0.86f, 1.0f, 
-        1.25f, 3.0f, 0.75f,       0.0f, 1.0f, 0.0f,          0.14f, 1.0f,
-        0.75f, 3.0f, 1.25f,       0.0f, 1.0f, 0.0f,          0.0f, 0.86f,
-        0.75f, 3.0f, 4.0f,       0.0f, 1.0f, 0.0f,          0.0f, 0.14f,
-    };
-
-    unsigned int try16Elts[] = { 0, 1, 2, 3,4,5,6 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[try16]);
-    glBindVertexArray(myVAO[try16]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(try16Verts), try16Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[try16]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(try16Elts), try16Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myStaticGeometry.AppendToMesh(myMeshes[iCrate], GL_TRIANGLE_FAN, try4Verts, try4Elts);
 
 
+    // The side box module: the two sides, the end and the cover of the low box next to a crate.
+    // The map has four instances of it.
     float sidewall1Verts[] = {
         // Position              // Normal                  // Texture coordinates
         -4.5f, 1.0f, -4.5f,       0.0f, 0.0f, -1.0f,          0.0f, 1.0f,         // upper left
@@ -1162,18 +460,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int sidewall1Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall1]);
-    glBindVertexArray(myVAO[iSideWall1]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall1Verts), sidewall1Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall1Elts), sidewall1Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myMeshes[iSideBox] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, sidewall1Verts, sidewall1Elts);
 
     float sidewall2Verts[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1185,18 +472,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int sidewall2Elts[] = { 2, 3, 0, 1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall2]);
-    glBindVertexArray(myVAO[iSideWall2]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall2Verts), sidewall2Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall2]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall2Elts), sidewall2Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myStaticGeometry.AppendToMesh(myMeshes[iSideBox], GL_TRIANGLE_STRIP, sidewall2Verts, sidewall2Elts);
 
     float sidewall3Verts[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1208,18 +484,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int sidewall3Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall3]);
-    glBindVertexArray(myVAO[iSideWall3]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall3Verts), sidewall3Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall3]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall3Elts), sidewall3Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myStaticGeometry.AppendToMesh(myMeshes[iSideBox], GL_TRIANGLE_STRIP, sidewall3Verts, sidewall3Elts);
 
     float isideCover1Verts[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1231,117 +496,10 @@ void MySetupSurfaces() {
     };
 
     unsigned int isideCover1Elts[] = { 2, 0, 3, 1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideCover1]);
-    glBindVertexArray(myVAO[iSideCover1]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(isideCover1Verts), isideCover1Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideCover1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(isideCover1Elts), isideCover1Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-
-
-
-
-    float sidewall4Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -4.5f, 1.0f, 4.5f,       0.0f, 0.0f, -1.0f,          0.0f, 1.0f,         // upper left
-        -4.5f, 0.0f, 4.5f,       0.0f, 0.0f,-1.0f,          0.0f, 0.0f,         // lower left
-
-        -6.0f, 1.0f, 4.5f,        0.0f, 0.0f, -1.0f,          1.0f, 1.0f,        // upper right
-        -6.0f, 0.0f, 4.5f,       0.0f, 0.0f, -1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int sidewall4Elts[] = { 2, 3, 0, 1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall4]);
-    glBindVertexArray(myVAO[iSideWall4]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall4Verts), sidewall4Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall4]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall4Elts), sidewall4Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float sidewall5Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -4.5f, 1.0f, 4.0f,       0.0f, 0.0f, 1.0f,          0.0f, 1.0f,         // upper left
-        -4.5f, 0.0f, 4.0f,       0.0f, 0.0f, 1.0f,          0.0f, 0.0f,         // lower left
-
-        -6.0f, 1.0f, 4.0f,        0.0f, 0.0f, 1.0f,          1.0f, 1.0f,        // upper right
-        -6.0f, 0.0f, 4.0f,       0.0f, 0.0f, 1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int sidewall5Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall5]);
-    glBindVertexArray(myVAO[iSideWall5]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall5Verts), sidewall5Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall5]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall5Elts), sidewall5Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-
-    float sidewall6Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -6.0f, 1.0f, 4.0f,       -1.0f, 0.0f, 0.0f,          0.0f, 1.0f,         // upper left
-        -6.0f, 0.0f, 4.0f,       -1.0f, 0.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        -6.0f, 1.0f, 4.5f,        -1.0f, 0.0f, 0.0f,          1.0f, 1.0f,        // upper right
-        -6.0f, 0.0f, 4.5f,       -1.0f, 0.0f, 0.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int sidewall6Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall6]);
-    glBindVertexArray(myVAO[iSideWall6]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall6Verts), sidewall6Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall6]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall6Elts), sidewall6Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-
-    float isideCover2Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        -4.5f, 1.0f, 4.5f,       0.0f, 1.0f, 0.0f,          0.0f, 1.0f,         // upper left
-        -6.0f, 1.0f, 4.5f,       0.0f, 1.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        -4.5f, 1.0f, 4.0f,       0.0f, 1.0f, 0.0f,          1.0f, 1.0f,        // upper right
-        -6.0f, 1.0f, 4.0f,       0.0f, 1.0f, 0.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int isideCover2Elts[] = { 3,1,2,0 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideCover2]);
-    glBindVertexArray(myVAO[iSideCover2]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(isideCover2Verts), isideCover2Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideCover2]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(isideCover2Elts), isideCover2Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myStaticGeometry.AppendToMesh(myMeshes[iSideBox], GL_TRIANGLE_STRIP, isideCover1Verts, isideCover1Elts);
 
+    // The side ramp module: the two sides, the end and the sloped cover of a ramp.
+    // The map has two instances of it.
     float sidewall7Verts[] = {
         // Position              // Normal                  // Texture coordinates
         -6.0f, 0.8f, -0.25f,       0.0f, 0.0f, -1.0f,          0.0f, 1.0f,         // upper left
@@ -1352,18 +510,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int sidewall7Elts[] = { 0, 1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall7]);
-    glBindVertexArray(myVAO[iSideWall7]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall7Verts), sidewall7Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall7]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall7Elts), sidewall7Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myMeshes[iSideRamp] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, sidewall7Verts, sidewall7Elts);
 
     float sidewall8Verts[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1375,18 +522,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int sidewall8Elts[] = { 2,3, 0, 1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall8]);
-    glBindVertexArray(myVAO[iSideWall8]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall8Verts), sidewall8Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall8]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall8Elts), sidewall8Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myStaticGeometry.AppendToMesh(myMeshes[iSideRamp], GL_TRIANGLE_STRIP, sidewall8Verts, sidewall8Elts);
 
     float sidewall9Verts[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1398,18 +534,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int sidewall9Elts[] = { 2,3,0,1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall9]);
-    glBindVertexArray(myVAO[iSideWall9]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall9Verts), sidewall9Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall9]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall9Elts), sidewall9Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myStaticGeometry.AppendToMesh(myMeshes[iSideRamp], GL_TRIANGLE_STRIP, sidewall9Verts, sidewall9Elts);
 
     float sidecover3Verts[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1421,303 +546,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int sidecover3Elts[] = { 0,1, 2, 3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideCover3]);
-    glBindVertexArray(myVAO[iSideCover3]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidecover3Verts),sidecover3Verts , GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideCover3]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidecover3Elts), sidecover3Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-    
-
-
-    float sidewall10Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        4.5f, 1.0f, -4.5f,       0.0f, 0.0f, -1.0f,          0.0f, 1.0f,         // upper left
-        4.5f, 0.0f, -4.5f,       0.0f, 0.0f,-1.0f,          0.0f, 0.0f,         // lower left
-
-        6.0f, 1.0f, -4.5f,        0.0f, 0.0f, -1.0f,          1.0f, 1.0f,        // upper right
-        6.0f, 0.0f, -4.5f,       0.0f, 0.0f, -1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int sidewall10Elts[] = { 2,3,0,1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall10]);
-    glBindVertexArray(myVAO[iSideWall10]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall10Verts), sidewall10Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall10]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall10Elts), sidewall10Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float sidewall11Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        4.5f, 1.0f, -4.0f,       0.0f, 0.0f, 1.0f,          0.0f, 1.0f,         // upper left
-        4.5f, 0.0f, -4.0f,       0.0f, 0.0f, 1.0f,          0.0f, 0.0f,         // lower left
-
-        6.0f, 1.0f, -4.0f,        0.0f, 0.0f, 1.0f,          1.0f, 1.0f,        // upper right
-        6.0f, 0.0f, -4.0f,       0.0f, 0.0f,  1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int sidewall11Elts[] = { 0,1,2,3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall11]);
-    glBindVertexArray(myVAO[iSideWall11]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall11Verts), sidewall11Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall11]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall11Elts), sidewall11Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-
-    float sidewall12Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        6.0f, 1.0f, -4.5f,       -1.0f, 0.0f, 0.0f,          0.0f, 1.0f,         // upper left
-        6.0f, 0.0f, -4.5f,       -1.0f, 0.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        6.0f, 1.0f, -4.0f,       -1.0f, 0.0f, 0.0f,          1.0f, 1.0f,        // upper right
-        6.0f, 0.0f, -4.0f,       -1.0f, 0.0f, 0.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int sidewall12Elts[] = { 2,3,0,1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall12]);
-    glBindVertexArray(myVAO[iSideWall12]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall12Verts), sidewall12Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall12]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall12Elts), sidewall12Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float isideCover4Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        4.5f, 1.0f, -4.5f,       0.0f, 1.0f, 0.0f,          0.0f, 1.0f,         // upper left
-        6.0f, 1.0f, -4.5f,       0.0f, 1.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        4.5f, 1.0f, -4.0f,       0.0f, 1.0f, 0.0f,          1.0f, 1.0f,        // upper right
-        6.0f, 1.0f, -4.0f,       0.0f, 1.0f, 0.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int isideCover4Elts[] = { 3,1,2,0 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideCover4]);
-    glBindVertexArray(myVAO[iSideCover4]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(isideCover4Verts), isideCover4Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideCover4]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(isideCover4Elts), isideCover4Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-
-
-
-
-    float sidewall13Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        4.5f, 1.0f, 4.5f,       0.0f, 0.0f, -1.0f,          0.0f, 1.0f,         // upper left
-        4.5f, 0.0f, 4.5f,       0.0f, 0.0f,-1.0f,          0.0f, 0.0f,         // lower left
-
-        6.0f, 1.0f, 4.5f,        0.0f, 0.0f, -1.0f,          1.0f, 1.0f,        // upper right
-        6.0f, 0.0f, 4.5f,       0.0f, 0.0f, -1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int sidewall13Elts[] = { 0,1,2,3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall13]);
-    glBindVertexArray(myVAO[iSideWall13]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall13Verts), sidewall13Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall13]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall13Elts), sidewall13Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float sidewall14Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        4.5f, 1.0f, 4.0f,       0.0f, 0.0f, 1.0f,          0.0f, 1.0f,         // upper left
-        4.5f, 0.0f, 4.0f,       0.0f, 0.0f,1.0f,          0.0f, 0.0f,         // lower left
-
-        6.0f, 1.0f, 4.0f,        0.0f, 0.0f, 1.0f,          1.0f, 1.0f,        // upper right
-        6.0f, 0.0f, 4.0f,       0.0f, 0.0f, 1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int sidewall14Elts[] = { 2,3,0,1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall14]);
-    glBindVertexArray(myVAO[iSideWall14]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall14Verts), sidewall14Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall14]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall14Elts), sidewall14Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-
-    float sidewall15Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        6.0f, 1.0f, 4.0f,       -1.0f, 0.0f, 0.0f,          0.0f, 1.0f,         // upper left
-        6.0f, 0.0f, 4.0f,       -1.0f, 0.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        6.0f, 1.0f, 4.5f,        -1.0f, 0.0f, 0.0f,          1.0f, 1.0f,        // upper right
-        6.0f, 0.0f, 4.5f,       -1.0f, 0.0f, 0.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int sidewall15Elts[] = { 2,3,0,1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall15]);
-    glBindVertexArray(myVAO[iSideWall15]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall15Verts), sidewall15Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall15]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall15Elts), sidewall15Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-
-    float isideCover5Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        4.5f, 1.0f, 4.5f,       0.0f, 1.0f, 0.0f,          0.0f, 1.0f,         // upper left
-        6.0f, 1.0f, 4.5f,       0.0f, 1.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        4.5f, 1.0f, 4.0f,       0.0f, 1.0f, 0.0f,          1.0f, 1.0f,        // upper right
-        6.0f, 1.0f, 4.0f,       0.0f, 1.0f, 0.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int isideCover5Elts[] = { 2,0,3,1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideCover5]);
-    glBindVertexArray(myVAO[iSideCover5]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(isideCover5Verts), isideCover5Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideCover5]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(isideCover5Elts), isideCover5Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float sidewall16Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        6.0f, 0.8f, -0.25f,       0.0f, 0.0f, -1.0f,          0.0f, 1.0f,         // upper left
-        6.0f, 0.0f, -0.25f,       0.0f, 0.0f,-1.0f,          0.0f, 0.0f,         // lower left
-
-        7.5f, 1.0f, -0.25f,        0.0f, 0.0f, -1.0f,          1.0f, 1.0f,        // upper right
-        7.5f, 0.0f, -0.25f,       0.0f, 0.0f, -1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int sidewall16Elts[] = { 2,3,0,1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall16]);
-    glBindVertexArray(myVAO[iSideWall16]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall16Verts), sidewall16Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall16]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall16Elts), sidewall16Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float sidewall17Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        6.0f, 0.8f, 0.25f,       0.0f, 0.0f, 1.0f,          0.0f, 1.0f,         // upper left
-        6.0f, 0.0f, 0.25f,       0.0f, 0.0f,1.0f,          0.0f, 0.0f,         // lower left
-
-        7.5f, 1.0f, 0.25f,        0.0f, 0.0f, 1.0f,          1.0f, 1.0f,        // upper right
-        7.5f, 0.0f, 0.25f,       0.0f, 0.0f, 1.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int sidewall17Elts[] = { 0,1,2,3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall17]);
-    glBindVertexArray(myVAO[iSideWall17]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall17Verts), sidewall17Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall17]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall17Elts), sidewall17Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float sidewall18Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        6.0f, 0.8f, -0.25f,       -1.0f, 0.0f, 0.0f,          0.0f, 1.0f,         // upper left
-        6.0f, 0.0f, -0.25,       -1.0f, 0.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        6.0f, 0.8f, 0.25f,        -1.0f, 0.0f, 0.0f,          1.0f, 1.0f,        // upper right
-        6.0f, 0.0f, 0.25f,       -1.0f, 0.0f, 0.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int sidewall18Elts[] = { 0,1,2,3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideWall18]);
-    glBindVertexArray(myVAO[iSideWall18]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidewall18Verts), sidewall18Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideWall18]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidewall18Elts), sidewall18Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
-    float sidecover6Verts[] = {
-        // Position              // Normal                  // Texture coordinates
-        6.0f, 0.8f, 0.25f,       -0.2f, 1.0f, 0.0f,          0.0f, 1.0f,         // upper left
-        6.0f, 0.8f, -0.25f,       -0.2f, 1.0f, 0.0f,          0.0f, 0.0f,         // lower left
-
-        7.5f, 1.0f, 0.25f,        -0.2f, 1.0f, 0.0f,          1.0f, 1.0f,        // upper right
-        7.5f, 1.0f, -0.25f,       -0.2f, 1.0f, 0.0f,          1.0f, 0.0f,        // lower right
-    };
-
-    unsigned int sidecover6Elts[] = { 2,3,0,1};
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iSideCover6]);
-    glBindVertexArray(myVAO[iSideCover6]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sidecover6Verts), sidecover6Verts, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iSideCover6]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(sidecover6Elts), sidecover6Elts, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myStaticGeometry.AppendToMesh(myMeshes[iSideRamp], GL_TRIANGLE_STRIP, sidecover3Verts, sidecover3Elts);
 
     float cornerVertex[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1729,18 +558,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int cornerEle[] = { 2,3,0,1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iCorner1]);
-    glBindVertexArray(myVAO[iCorner1]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cornerVertex), cornerVertex, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iCorner1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cornerEle), cornerEle, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myMeshes[iCorner1] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, cornerVertex, cornerEle);
 
     float corner2Vertex[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1752,18 +570,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int corner2Ele[] = { 0,1,2,3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iCorner2]);
-    glBindVertexArray(myVAO[iCorner2]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(corner2Vertex), corner2Vertex, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iCorner2]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(corner2Ele), corner2Ele, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myMeshes[iCorner2] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, corner2Vertex, corner2Ele);
 
     float corner3Vertex[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1775,18 +582,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int corner3Ele[] = { 0,1,2,3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iCorner3]);
-    glBindVertexArray(myVAO[iCorner3]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(corner3Vertex), corner3Vertex, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iCorner3]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(corner3Ele), corner3Ele, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myMeshes[iCorner3] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, corner3Vertex, corner3Ele);
 
     float corner4Vertex[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1798,18 +594,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int corner4Ele[] = { 2,3,0,1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[iCorner4]);
-    glBindVertexArray(myVAO[iCorner4]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(corner4Vertex), corner4Vertex, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[iCorner4]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(corner4Ele), corner4Ele, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myMeshes[iCorner4] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, corner4Vertex, corner4Ele);
 
     float m1Vertex[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1821,18 +606,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int m1Ele[] = { 0,1,2,3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[im1]);
-    glBindVertexArray(myVAO[im1]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(m1Vertex), m1Vertex, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[im1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m1Ele), m1Ele, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myMeshes[im1] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, m1Vertex, m1Ele);
 
     float m2Vertex[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1844,18 +618,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int m2Ele[] = { 2,3,0,1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[im2]);
-    glBindVertexArray(myVAO[im2]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(m2Vertex), m2Vertex, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[im2]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m2Ele), m2Ele, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myMeshes[im2] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, m2Vertex, m2Ele);
 
     float m3Vertex[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1866,18 +629,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int m3Ele[] = { 0,1,2 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[im3]);
-    glBindVertexArray(myVAO[im3]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(m3Vertex), m3Vertex, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[im3]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m3Ele), m3Ele, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myMeshes[im3] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, m3Vertex, m3Ele);
 
     float m4Vertex[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1889,18 +641,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int m4Ele[] = { 2,3,0,1 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[im4]);
-    glBindVertexArray(myVAO[im4]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(m4Vertex), m4Vertex, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[im4]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m4Ele), m4Ele, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myMeshes[im4] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, m4Vertex, m4Ele);
 
     float m5Vertex[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1912,18 +653,7 @@ void MySetupSurfaces() {
     };
 
     unsigned int m5Ele[] = { 0,1,2,3 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[im5]);
-    glBindVertexArray(myVAO[im5]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(m5Vertex), m5Vertex, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[im5]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m5Ele), m5Ele, GL_STATIC_DRAW);
-    check_for_opengl_errors();
+    myMeshes[im5] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, m5Vertex, m5Ele);
 
     float m6Vertex[] = {
         // Position              // Normal                  // Texture coordinates
@@ -1934,25 +664,20 @@ void MySetupSurfaces() {
     };
 
     unsigned int m6Ele[] = { 0,1,2 };
-    glBindBuffer(GL_ARRAY_BUFFER, myVBO[im6]);
-    glBindVertexArray(myVAO[im6]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(m6Vertex), m6Vertex, GL_STATIC_DRAW);
-    glVertexAttribPointer(vertPos_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);	   // Vertex positions in the VBO
-    glEnableVertexAttribArray(vertPos_loc);									                   // Enable the stored vertices
-    glVertexAttribPointer(vertNormal_loc, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));	// Vertex normals in the VBO
-    glEnableVertexAttribArray(vertNormal_loc);									                                    // Enable the stored vertices
-    glVertexAttribPointer(vertTexCoords_loc, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));	// Vertex texture coordinates in the VBO
-    glEnableVertexAttribArray(vertTexCoords_loc);									                                // Enable the stored vertices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, myEBO[im6]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m6Ele), m6Ele, GL_STATIC_DRAW);
-    check_for_opengl_errors();
-
+    myMeshes[im6] = myStaticGeometry.AddMesh(GL_TRIANGLE_STRIP, m6Vertex, m6Ele);
 
+    MySetupCopyMeshes(iCrate, NumCrateCopies, myCrateCopyMeshes);
+    MySetupCopyMeshes(iSideBox, NumSideBoxCopies, mySideBoxCopyMeshes);
+    MySetupCopyMeshes(iSideRamp, NumSideRampCopies, mySideRampCopyMeshes);
 
+    // Load all the meshes into the single VAO, VBO and EBO.
+    myStaticGeometry.InitializeAttribLocations(vertPos_loc, vertNormal_loc, vertTexCoords_loc);
+    check_for_opengl_errors();
 }
 
 void MyRemeshGeometries() 
 {
+    CpuProfileZone zone("MyRemeshGeometries");
 // IT IS NOT NECESSARY TO REMESH EITHER THE FLOOR OR THE BACK WALL
 // YOU DO NOT NEED TO CHANGE THIS FOR PROJECT #6.
 
@@ -1960,901 +685,617 @@ void MyRemeshGeometries()
     texSphere.Remesh(meshRes, meshRes);
     texCylinder.Remesh(meshRes, meshRes, meshRes);
     texTorus.Remesh(meshRes, meshRes );
+    markFrameDirty();
 
     check_for_opengl_errors();      // Watch the console window for error messages!
 }
 
 // **********************************************
-// MODIFY THIS ROUTINE TO RENDER THE FLOOR, THE BACK WALL,
-//    AND THE SPHERES AND THE CYLINDER. -- WITH TEXTURES
+// The scene table for the map.
+// Each row gives an object, its render pass and its texture.
+// The rows are grouped so that objects sharing a texture are adjacent.
+// The crates, the side boxes and the side ramps are modules:
+//    they are not in the table, but are drawn as instances by myModules.
 // **********************************************
+const int passFloor = 0;
+const int passWalls = 1;
+const int passCrates = 2;
+
+struct MySceneRow {
+    int object;                 // Index into myMeshes[]
+    int pass;                   // passFloor, passWalls or passCrates
+    int texture;                // Index into TextureNames[]
+};
 
-void MyRenderGeometries() {
-
-    float matEntries[16];       // Temporary storage for floats
-    // ******
-    // Render the Floor - using a procedural texture map
-    // ******
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iFloor]);                // Select the floor VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    if (renderFloorOnly) {
-        return;
+const MySceneRow mySceneRows[] = {
+    { iFloor, passFloor, 4 },
+
+    { iWall, passWalls, 4 },
+    { iWall2, passWalls, 4 },
+    { iWall3, passWalls, 4 },
+    { iWall4, passWalls, 4 },
+    { iCorner1, passWalls, 4 },
+    { iCorner2, passWalls, 4 },
+    { iCorner3, passWalls, 4 },
+    { iCorner4, passWalls, 4 },
+    { im1, passWalls, 4 },
+    { im2, passWalls, 4 },
+    { im3, passWalls, 4 },
+    { im4, passWalls, 4 },
+    { im5, passWalls, 4 },
+    { im6, passWalls, 4 },
+};
+const int NumSceneRows = sizeof(mySceneRows) / sizeof(mySceneRows[0]);
+
+GlSceneRenderer myScene;
+unsigned int mySceneShaderProgram;      // The shader program for myScene's data mode (set by MySetupSceneTable)
+unsigned int mySceneDepthProgram;       // The matching depth-only program, for the depth pre-pass
+
+// The modules and their instances.  A copy with a mesh of its own (see MyCopyFace)
+//    is the only instance of its module.  The crate fields use myCrateModule.
+GlInstancedModules myModules;
+int myCrateModule;
+int myMapCrateModules[NumCrateCopies];
+int mySideBoxModules[NumSideBoxCopies];
+int mySideRampModules[NumSideRampCopies];
+
+// The occluders for software occlusion culling: the walls, the side boxes and the side ramps.
+SoftwareOcclusion myOcclusion;
+
+// The potentially visible set: its objects are the scene table's rows (in order),
+//    then the side boxes, the side ramps and the map's crates.  The occluders block its rays.
+const int PvsCellsPerSide = 16;
+MapPvs myPvs;
+int myPvsFirstCrate;            // The PVS object of the map's first crate
+
+// The map's triangles for ray queries: its objects are the same as the PVS objects.
+TriangleBvh myBvh;
+
+// The map's four crates are the modeled crate turned around the y-axis
+//    by 0, -90, 90 and 180 degrees.  (Cosine and sine of the angles.)
+const double myCrateTurns[4][2] = { { 1.0, 0.0 }, { 0.0, -1.0 }, { 0.0, 1.0 }, { -1.0, 0.0 } };
+
+// The modules for the copies of a module: the module itself, unless the copy has a mesh of its own.
+void MySetupCopyModules(int object, int numCopies, const int* copyMeshes, int module, int pass, int* copyModules)
+{
+    for (int copy = 0; copy < numCopies; copy++) {
+        copyModules[copy] = (copyMeshes[copy] == myMeshes[object]) ? module
+                            : myModules.AddModule(copyMeshes[copy], pass, &materialUnderTexture);
     }
+}
 
-    // **************
-    // Render the circular surface
-    /*selectShaderProgram(shaderProgramBitmap);
-    SamsRenderCircularSurf();*/
-
-    // ************ 
-    // Render the back wall
-    //  YOU MUST WRITE THIS. IT WILL BE SIMILAR TO THE FLOOR ABOVE. 
-    //  BUT USE A BITMAP (shaderProgramBitmap) INSTEAD OF A PROCEDURAL TEXTURE.
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iWall]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iWall2]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iWall3]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iWall4]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle2]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle3]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle4]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[icover]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle5]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle6]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle7]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle8]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try8]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_FAN, 7, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle9]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle10]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle11]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle12]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try12]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_FAN, 7, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle13]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle14]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle15]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iMiddle16]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try16]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_FAN, 7, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall1]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall2]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall3]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideCover1]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall4]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall5]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall6]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideCover2]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall7]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall8]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall9]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideCover3]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall10]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall11]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall12]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
-
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideCover4]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+// **********************************************
+// Fill the scene table from mySceneRows[], and place the module instances.
+// Called once, after the meshes and the textures have been set up.
+// **********************************************
+void MySetupSceneTable()
+{
+    myScene.Clear();
+    myScene.SetGeometry(&myStaticGeometry);
+    myOcclusion.ClearOccluders();
+    myPvs.ClearGeometry();
+    myBvh.Clear();
+    myPvs.SetGrid(-7.5f, -7.5f, 7.5f, 7.5f, PvsCellsPerSide, PvsCellsPerSide, 0.0f, 3.0f);    // The floor, up to the top of the walls
+    // The scene table is drawn with the most capable shader program available.
+    if (shaderProgramObjectData != 0) {
+        myScene.SetDataMode(GlSceneRenderer::ObjectDataArray, &uniformRing);
+        mySceneShaderProgram = shaderProgramObjectData;
+        mySceneDepthProgram = shaderProgramDepthObjectData;
+    }
+    else if (shaderProgramDrawData != 0) {
+        myScene.SetDataMode(GlSceneRenderer::DrawDataBlock, &uniformRing);
+        mySceneShaderProgram = shaderProgramDrawData;
+        mySceneDepthProgram = shaderProgramDepthDrawData;
+    }
+    else {
+        myScene.SetDataMode(GlSceneRenderer::ModelviewUniform);
+        mySceneShaderProgram = shaderProgramBitmap;
+        mySceneDepthProgram = shaderProgramDepth;
+    }
+    for (const MySceneRow& row : mySceneRows) {
+        assert(myMeshes[row.object] >= 0);
+        GlSceneObject obj;
+        obj.pass = row.pass;
+        obj.mesh = myMeshes[row.object];
+        obj.texture = TextureNames[row.texture];
+        obj.material = &materialUnderTexture;
+        obj.modelMatrix = nullptr;          // The map is modeled in world coordinates
+        myScene.AddObject(obj);
+        myPvs.AddObject(myStaticGeometry, obj.mesh);
+        myBvh.AddMesh(myStaticGeometry, obj.mesh);
+        if (row.pass == passWalls) {
+            myOcclusion.AddOccluder(myStaticGeometry, obj.mesh);
+            myPvs.AddBlocker(myStaticGeometry, obj.mesh);
+        }
+    }
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall13]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+    myModules.Clear();
+    myModules.SetGeometry(&myStaticGeometry);
+    myCrateModule = myModules.AddModule(myMeshes[iCrate], passCrates, &materialUnderTexture);
+    MySetupCopyModules(iCrate, NumCrateCopies, myCrateCopyMeshes, myCrateModule, passCrates, myMapCrateModules);
+    int sideBoxModule = myModules.AddModule(myMeshes[iSideBox], passWalls, &materialUnderTexture);
+    MySetupCopyModules(iSideBox, NumSideBoxCopies, mySideBoxCopyMeshes, sideBoxModule, passWalls, mySideBoxModules);
+    int sideRampModule = myModules.AddModule(myMeshes[iSideRamp], passWalls, &materialUnderTexture);
+    MySetupCopyModules(iSideRamp, NumSideRampCopies, mySideRampCopyMeshes, sideRampModule, passWalls, mySideRampModules);
+
+    // The side boxes: the modeled one, a copy moved 8.5 along the z-axis,
+    //    and both of these turned 180 degrees around the y-axis.
+    LinearMapR4 identity;
+    identity.SetIdentity();
+    LinearMapR4 halfTurn;
+    halfTurn.Set_glRotate(-1.0, 0.0, 0.0, 1.0, 0.0);
+    LinearMapR4 shiftZ;
+    shiftZ.Set_glTranslate(0.0, 0.0, 8.5);
+    const LinearMapR4 sideBoxMatrices[4] = { identity, shiftZ, halfTurn, halfTurn * shiftZ };
+    for (int i = 0; i < NumSideBoxCopies; i++) {
+        const LinearMapR4& sideBoxMatrix = sideBoxMatrices[i];
+        int pvsObject = myPvs.AddObject(myStaticGeometry, myMeshes[iSideBox], &sideBoxMatrix);
+        myBvh.AddMesh(myStaticGeometry, myMeshes[iSideBox], &sideBoxMatrix);
+        myModules.AddInstance(mySideBoxModules[i], sideBoxMatrix, TextureNames[5], -1, pvsObject);
+        myOcclusion.AddOccluder(myStaticGeometry, myMeshes[iSideBox], &sideBoxMatrix);
+        myPvs.AddBlocker(myStaticGeometry, myMeshes[iSideBox], &sideBoxMatrix);
+    }
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall14]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+    // The side ramps: the modeled one, and it turned 180 degrees.
+    const LinearMapR4 sideRampMatrices[2] = { identity, halfTurn };
+    for (int i = 0; i < NumSideRampCopies; i++) {
+        const LinearMapR4& sideRampMatrix = sideRampMatrices[i];
+        int pvsObject = myPvs.AddObject(myStaticGeometry, myMeshes[iSideRamp], &sideRampMatrix);
+        myBvh.AddMesh(myStaticGeometry, myMeshes[iSideRamp], &sideRampMatrix);
+        myModules.AddInstance(mySideRampModules[i], sideRampMatrix, TextureNames[5], -1, pvsObject);
+        myOcclusion.AddOccluder(myStaticGeometry, myMeshes[iSideRamp], &sideRampMatrix);
+        myPvs.AddBlocker(myStaticGeometry, myMeshes[iSideRamp], &sideRampMatrix);
+    }
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall15]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+    // The map's crates are in the PVS (the crate fields are not), but do not block its rays.
+    myPvsFirstCrate = myPvs.GetNumObjects();
+    for (int i = 0; i < NumCrateCopies; i++) {
+        LinearMapR4 crateMatrix;
+        crateMatrix.Set_glRotate(myCrateTurns[i][0], myCrateTurns[i][1], 0.0, 1.0, 0.0);
+        myPvs.AddObject(myStaticGeometry, myMeshes[iCrate], &crateMatrix);
+        myBvh.AddMesh(myStaticGeometry, myMeshes[iCrate], &crateMatrix);
+    }
+    myBvh.Build();
+    MySetupCrateField(0);
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideCover5]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
+    myModules.InitializeAttribLocations(instanceMatrix_loc);
     check_for_opengl_errors();
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall16]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+// **********************************************
+// Place the crates: either the map's four crates (fieldSize == 0),
+//    or, for stress tests, a fieldSize x fieldSize field of crates.
+// Every crate is an instance of the crate module, so the whole field
+//    is drawn with one instanced draw per texture.
+// For occlusion queries, each of the map's crates is its own occlusion group,
+//    and a field is grouped in tiles of CrateTileSize x CrateTileSize crates.
+// **********************************************
+const int CrateTileSize = 8;
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall17]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+void MySetupCrateField(int fieldSize)
+{
+    myModules.ClearInstances(myCrateModule);
+    for (int i = 1; i < NumCrateCopies; i++) {
+        if (myMapCrateModules[i] != myCrateModule) {
+            myModules.ClearInstances(myMapCrateModules[i]);
+        }
+    }
+    LinearMapR4 crateMatrix;
+    if (fieldSize <= 0) {
+        for (int i = 0; i < NumCrateCopies; i++) {
+            crateMatrix.Set_glRotate(myCrateTurns[i][0], myCrateTurns[i][1], 0.0, 1.0, 0.0);
+            myModules.AddInstance(myMapCrateModules[i], crateMatrix, TextureNames[4], i, myPvsFirstCrate + i);
+        }
+        return;
+    }
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideWall18]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+    // Crates are spaced 5.25 apart, as in the map.  The field is centered on the origin.
+    // The crates are turned and textured in a repeating pattern.
+    static const int fieldTextures[4] = { 4, 3, 2, 0 };
+    const double spacing = 5.25;
+    const double first = -0.5 * spacing * (fieldSize - 1);
+    const int tilesPerRow = (fieldSize + CrateTileSize - 1) / CrateTileSize;
+    for (int i = 0; i < fieldSize; i++) {
+        for (int j = 0; j < fieldSize; j++) {
+            crateMatrix.Set_glTranslate(first + i * spacing, 0.0, first + j * spacing);
+            crateMatrix.Mult_glRotate(((i + 2 * j) % 4) * PIhalves, 0.0, 1.0, 0.0);
+            crateMatrix.Mult_glTranslate(2.625, 0.0, 2.625);    // Move the modeled crate's center to the origin
+            int tile = (i / CrateTileSize) * tilesPerRow + j / CrateTileSize;
+            myModules.AddInstance(myCrateModule, crateMatrix, TextureNames[fieldTextures[(i + j) % 4]], tile);
+        }
+    }
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iSideCover6]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[5]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+// Counting the fragments drawn by MyRenderGeometries (for the depth pre-pass report).
+bool countFragments = false;
+unsigned int fragmentQueries[2] = { 0, 0 };     // GL_SAMPLES_PASSED: the depth pre-pass, the main passes
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iCorner1]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+void MySetCountFragments(bool count) {
+    if (count && fragmentQueries[0] == 0) {
+        glGenQueries(2, fragmentQueries);
+    }
+    countFragments = count;
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iCorner2]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+void MyGetFragmentCounts(long long* depthOnlyFragments, long long* shadedFragments) {
+    GLuint64 counts[2] = { 0, 0 };
+    for (int i = 0; i < 2; i++) {
+        if (fragmentQueries[i] != 0 && glIsQuery(fragmentQueries[i])) {
+            glGetQueryObjectui64v(fragmentQueries[i], GL_QUERY_RESULT, &counts[i]);
+        }
+    }
+    *depthOnlyFragments = (long long)counts[0];
+    *shadedFragments = (long long)counts[1];
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iCorner3]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+// The occlusion query counts, summed over the frames rendered with occlusion queries.
+long long occlusionGroupsHidden = 0;
+long long occlusionGroupsDrawn = 0;
+long long occlusionFrames = 0;
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[iCorner4]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+void MyGetOcclusionCounts(long long* groupsHidden, long long* groupsDrawn, long long* numFrames) {
+    *groupsHidden = occlusionGroupsHidden;
+    *groupsDrawn = occlusionGroupsDrawn;
+    *numFrames = occlusionFrames;
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[im1]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+// The PVS counts, summed over the frames rendered with pvsCulling.
+long long pvsFrames = 0;
+long long pvsCellFrames = 0;            // Frames with the camera in a cell
+long long pvsVisibleObjects = 0;        // Summed over those frames
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[im2]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+// The software occlusion counts, summed over the frames rendered with softwareOcclusion.
+long long softOccludedObjects = 0;
+long long softOccludedInstances = 0;
+long long softOcclusionFrames = 0;
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[im3]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+void MyGetSoftwareOcclusionCounts(long long* objectsOccluded, long long* instancesOccluded, long long* numFrames) {
+    *objectsOccluded = softOccludedObjects;
+    *instancesOccluded = softOccludedInstances;
+    *numFrames = softOcclusionFrames;
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[im4]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+int MyNumOccluderTriangles() {
+    return myOcclusion.GetNumOccluderTriangles();
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[im5]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+void MyResetOcclusionCounts() {
+    occlusionGroupsHidden = occlusionGroupsDrawn = occlusionFrames = 0;
+    softOccludedObjects = softOccludedInstances = softOcclusionFrames = 0;
+    pvsFrames = pvsCellFrames = pvsVisibleObjects = 0;
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[im6]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+// The potentially visible set: baking and loading.
+bool MyBakePvs(const char* filename, int raysPerPair) {
+    long long bakeBegin = CpuProfiler::NowMicroseconds();
+    myPvs.Bake(raysPerPair);
+    double bakeSeconds = 1.0e-6 * (CpuProfiler::NowMicroseconds() - bakeBegin);
+    long long visibleSum = 0;
+    for (int cell = 0; cell < myPvs.GetNumCells(); cell++) {
+        visibleSum += myPvs.NumVisible(cell);
+    }
+    printf("PVS: baked %d cells x %d objects in %.2f s (%lld rays); %.1f objects visible per cell.\n",
+           myPvs.GetNumCells(), myPvs.GetNumObjects(), bakeSeconds, myPvs.NumRaysTraced(),
+           (double)visibleSum / myPvs.GetNumCells());
+    if (!myPvs.Save(filename)) {
+        return false;
+    }
+    printf("PVS: saved to %s.\n", filename);
+    return true;
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try1]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+bool MyLoadPvs(const char* filename) {
+    if (!myPvs.Load(filename)) {
+        return false;
+    }
+    printf("PVS: loaded %d cells x %d objects from %s.\n", myPvs.GetNumCells(), myPvs.GetNumObjects(), filename);
+    return true;
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try2]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+void MyGetPvsCounts(long long* cellFrames, long long* visibleObjects, int* numObjects, long long* numFrames) {
+    *cellFrames = pvsCellFrames;
+    *visibleObjects = pvsVisibleObjects;
+    *numObjects = myPvs.GetNumObjects();
+    *numFrames = pvsFrames;
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try3]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+// The PVS row for the camera's cell, or nullptr if the camera is in no cell.
+//    The camera is at the inverse of the (rigid) view matrix applied to the origin.
+const unsigned char* MyPvsRowForView() {
+    const LinearMapR4& m = viewMatrix;
+    double eyeX = -(m.m11 * m.m14 + m.m21 * m.m24 + m.m31 * m.m34);
+    double eyeY = -(m.m12 * m.m14 + m.m22 * m.m24 + m.m32 * m.m34);
+    double eyeZ = -(m.m13 * m.m14 + m.m23 * m.m24 + m.m33 * m.m34);
+    int cell = myPvs.FindCell(eyeX, eyeY, eyeZ);
+    pvsFrames++;
+    if (cell < 0) {
+        return nullptr;
+    }
+    pvsCellFrames++;
+    pvsVisibleObjects += myPvs.NumVisible(cell);
+    return myPvs.CellRow(cell);
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try4]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_FAN, 7, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+// **********************************************
+// Ray queries against the map (see TriangleBvh.h)
+// **********************************************
+const TriangleBvh& MyMapBvh() {
+    return myBvh;
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try5]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+// The ray from the eye through the point (ndcX,ndcY) in normalized device coordinates:
+//    from the near plane to the far plane, so t is 0 to 1 across the view volume.
+void MyViewRay(const LinearMapR4& inverseProjView, double ndcX, double ndcY, BvhRay* ray) {
+    VectorR4 nearPoint = inverseProjView * VectorR4(ndcX, ndcY, -1.0, 1.0);
+    VectorR4 farPoint = inverseProjView * VectorR4(ndcX, ndcY, 1.0, 1.0);
+    double nearCoords[3] = { nearPoint.x / nearPoint.w, nearPoint.y / nearPoint.w, nearPoint.z / nearPoint.w };
+    double farCoords[3] = { farPoint.x / farPoint.w, farPoint.y / farPoint.w, farPoint.z / farPoint.w };
+    for (int k = 0; k < 3; k++) {
+        ray->origin[k] = (float)nearCoords[k];
+        ray->direction[k] = (float)(farCoords[k] - nearCoords[k]);
+    }
+    ray->tMax = 1.0f;
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try6]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+int MyPickObject(double ndcX, double ndcY, double hitPoint[3]) {
+    BvhRay ray;
+    MyViewRay((theProjectionMatrix * viewMatrix).Inverse(), ndcX, ndcY, &ray);
+    BvhHit hit;
+    if (!myBvh.Intersect(ray, &hit)) {
+        return -1;
+    }
+    for (int k = 0; k < 3; k++) {
+        hitPoint[k] = ray.origin[k] + hit.t * ray.direction[k];
+    }
+    return hit.object;
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try7]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+// Time one kind of query over the rays: one ray at a time, one packet at a time, and
+//    in packets on the worker threads.  Returns the number of results that differ from
+//    the rays traced one at a time.
+int MyTimeRayQuery(const char* name, bool closest, const std::vector<BvhRay>& rays) {
+    int numRays = (int)rays.size();
+    std::vector<BvhHit> hits[3];
+    std::vector<unsigned char> occluded[3];
+    double mraysPerSecond[3];
+    for (int mode = 0; mode < 3; mode++) {
+        hits[mode].resize(numRays);
+        occluded[mode].resize(numRays);
+        long long begin = CpuProfiler::NowMicroseconds();
+        if (mode == 0) {
+            for (int i = 0; i < numRays; i++) {
+                if (closest) {
+                    myBvh.Intersect(rays[i], &hits[0][i]);
+                }
+                else {
+                    occluded[0][i] = myBvh.Occluded(rays[i]) ? 1 : 0;
+                }
+            }
+        }
+        else if (mode == 1) {
+            for (int i = 0; i < numRays; i += TriangleBvh::PacketSize) {
+                int n = std::min(TriangleBvh::PacketSize, numRays - i);
+                if (closest) {
+                    myBvh.IntersectPacket(&rays[i], n, &hits[1][i]);
+                }
+                else {
+                    myBvh.OccludedPacket(&rays[i], n, &occluded[1][i]);
+                }
+            }
+        }
+        else if (closest) {
+            myBvh.IntersectRays(rays.data(), numRays, hits[2].data());
+        }
+        else {
+            myBvh.OccludedRays(rays.data(), numRays, occluded[2].data());
+        }
+        long long elapsed = std::max(1LL, CpuProfiler::NowMicroseconds() - begin);
+        mraysPerSecond[mode] = (double)numRays / elapsed;
+    }
+    int numDiffer = 0;
+    int numHit = 0;
+    for (int i = 0; i < numRays; i++) {
+        const BvhHit& h = hits[0][i];
+        numHit += closest ? (h.triangle >= 0) : occluded[0][i];
+        for (int mode = 1; mode < 3; mode++) {
+            if (closest) {
+                const BvhHit& hm = hits[mode][i];
+                // Ties between triangles (on a shared edge) may go either way
+                if (hm.triangle != h.triangle && (hm.triangle < 0 || h.triangle < 0 || fabsf(hm.t - h.t) > 1.0e-5f * (1.0f + h.t))) {
+                    numDiffer++;
+                }
+            }
+            else if (occluded[mode][i] != occluded[0][i]) {
+                numDiffer++;
+            }
+        }
+    }
+    printf("  %-14s %-8s %8.1f %8.1f %8.1f %7.1f%%\n", name, closest ? "closest" : "any",
+           mraysPerSecond[0], mraysPerSecond[1], mraysPerSecond[2], 100.0 * numHit / std::max(1, numRays));
+    return numDiffer;
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try9]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+// **********************************************
+// Time the ray queries against the map, with numRays rays of each kind:
+//    camera rays through a grid of pixels of the current view (each packet a
+//    square of 2x2 pixels), random rays from points in the map, and lines of
+//    sight between random points in the map.  Returns false if the packets'
+//    results differ from the single rays'.
+// **********************************************
+bool MyBenchRays(int numRays) {
+    printf("Rays: %d triangles, %d objects, %d BVH nodes (depth %d); %d worker threads.\n",
+           myBvh.GetNumTriangles(), myBvh.GetNumObjects(), myBvh.GetNumNodes(), myBvh.GetDepth(),
+           WorkerPool::GetNumWorkers());
+    unsigned int randomState = 12345;          // xorshift, so every run traces the same rays
+    auto random = [&randomState]() {
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 17;
+        randomState ^= randomState << 5;
+        return (randomState >> 8) * (1.0f / 16777216.0f);
+    };
+    auto randomMapPoint = [&random](float* point) {     // Over the floor, up to the top of the walls
+        point[0] = -7.5f + 15.0f * random();
+        point[1] = 0.05f + 2.95f * random();
+        point[2] = -7.5f + 15.0f * random();
+    };
+
+    // Camera rays: a grid twice as wide as high, by squares of 2x2 pixels
+    int gridHeight = std::max(2, 2 * (int)sqrt(numRays / 8.0));
+    int gridWidth = 2 * gridHeight;
+    std::vector<BvhRay> cameraRays;
+    cameraRays.reserve((size_t)gridWidth * gridHeight);
+    LinearMapR4 inverseProjView = (theProjectionMatrix * viewMatrix).Inverse();
+    for (int y = 0; y < gridHeight; y += 2) {
+        for (int x = 0; x < gridWidth; x += 2) {
+            for (int i = 0; i < 4; i++) {
+                double ndcX = 2.0 * (x + (i & 1) + 0.5) / gridWidth - 1.0;
+                double ndcY = 2.0 * (y + (i >> 1) + 0.5) / gridHeight - 1.0;
+                cameraRays.emplace_back();
+                MyViewRay(inverseProjView, ndcX, ndcY, &cameraRays.back());
+            }
+        }
+    }
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try10]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+    std::vector<BvhRay> randomRays(numRays);
+    for (BvhRay& ray : randomRays) {
+        randomMapPoint(ray.origin);
+        float length;
+        do {
+            for (int k = 0; k < 3; k++) {
+                ray.direction[k] = 2.0f * random() - 1.0f;
+            }
+            length = sqrtf(ray.direction[0] * ray.direction[0] + ray.direction[1] * ray.direction[1] + ray.direction[2] * ray.direction[2]);
+        } while (length > 1.0f || length < 0.01f);
+        for (int k = 0; k < 3; k++) {
+            ray.direction[k] /= length;
+        }
+        ray.tMax = 1.0e30f;
+    }
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try11]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+    std::vector<BvhRay> sightRays(numRays);
+    for (BvhRay& ray : sightRays) {
+        float target[3];
+        randomMapPoint(ray.origin);
+        randomMapPoint(target);
+        for (int k = 0; k < 3; k++) {
+            ray.direction[k] = target[k] - ray.origin[k];
+        }
+        ray.tMax = 1.0f;
+    }
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try13]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+    printf("  Rays           Query     Mrays/s: one   packet    batch     hit\n");
+    int numDiffer = 0;
+    numDiffer += MyTimeRayQuery("camera", true, cameraRays);
+    numDiffer += MyTimeRayQuery("camera", false, cameraRays);
+    numDiffer += MyTimeRayQuery("random", true, randomRays);
+    numDiffer += MyTimeRayQuery("random", false, randomRays);
+    numDiffer += MyTimeRayQuery("line of sight", false, sightRays);
+    if (numDiffer != 0) {
+        printf("Rays: %d packet results differ from the single rays'!\n", numDiffer);
+        return false;
+    }
+    printf("Rays: the packets' results match the single rays'.\n");
+    return true;
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try14]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+// GL_EQUAL needs the shading programs to compute exactly the depth-only programs' positions:
+//    only the programs in MySceneShaders.glsl declare gl_Position invariant.  shaderProgramBitmap
+//    (the fallback for the scene table and for the modules) does not, so it may lose pixels.
+bool MyDepthPrepassAvailable() {
+    return mySceneShaderProgram != shaderProgramBitmap && mySceneDepthProgram != 0
+        && shaderProgramInstanced != 0 && shaderProgramDepthInstanced != 0;
+}
 
-    selectShaderProgram(shaderProgramBitmap);
-    glBindVertexArray(myVAO[try15]);                // Select the wall VAO (Vertex Array Object)
-    materialUnderTexture.LoadIntoShaders();         // Use the bright underlying color
-    viewMatrix.DumpByColumns(matEntries);           // Apply the model view matrix
-    glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
-    glBindTexture(GL_TEXTURE_2D, TextureNames[4]);
-    glUniform1i(applyTextureLocation, true);           // Enable applying the texture!
-    // Draw the floor as a single triangle strip
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_INT, (void*)0);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture!
-    check_for_opengl_errors();
+// **********************************************
+// Render the floor, the walls and the crates -- with textures.
+// Each pass is timed on the GPU: the pass's scene table rows are drawn
+// first, then its module instances.
+// Without the instanced shader program, each instance is drawn on its own.
+// With depthPrepass, all passes first write only the depth; the passes are
+// then drawn with GL_EQUAL and no depth writes, so each pixel is shaded once.
+// With occlusionQueries (and no depth pre-pass), the crates are occlusion
+// tested against the floor and the walls, which are drawn before them.
+// With softwareOcclusion, objects hidden behind the walls are culled on the
+// CPU before the packets are built.
+// With pvsCulling and a PVS loaded, the camera's cell selects the objects
+// that can be visible at all.
+// **********************************************
+void MyRenderGeometries() {
+    CpuProfileZone zone("MyRenderGeometries");
+    static const char* passNames[] = { "Floor", "Walls", "Crates" };
+    int lastPass = renderFloorOnly ? passFloor : passCrates;
+
+    // Culling, modelview matrices and sorting are done once for all passes, on the worker threads.
+    GlFrustum frustum(theProjectionMatrix * viewMatrix);
+    const GlFrustum* cullFrustum = frustumCulling ? &frustum : nullptr;
+    bool prepass = depthPrepass && MyDepthPrepassAvailable();
+    // The box tests would fail against GL_EQUAL: the pre-pass already keeps hidden crates from being shaded.
+    // Counting fragments also uses an occlusion query, and only one can be active.
+    myModules.SetOcclusionQueries(occlusionQueries && !prepass && !countFragments && shaderProgramDepth != 0);
+    const SoftwareOcclusion* occlusion = nullptr;
+    if (softwareOcclusion) {
+        myOcclusion.Render(theProjectionMatrix * viewMatrix);
+        occlusion = &myOcclusion;
+    }
+    const unsigned char* pvsRow = (pvsCulling && myPvs.HasVisibility()) ? MyPvsRowForView() : nullptr;
+    myScene.BuildPackets(viewMatrix, cullFrustum, occlusion, pvsRow);
+    myModules.BuildPackets(viewMatrix, cullFrustum, shaderProgramInstanced != 0, occlusion, pvsRow);
+    if (softwareOcclusion) {
+        softOccludedObjects += myScene.NumObjectsOccluded();
+        softOccludedInstances += myModules.NumInstancesOccluded();
+        softOcclusionFrames++;
+    }
+    if (prepass) {
+        GlGpuProfiler::BeginPass("Depth pre-pass");
+        GlDebugOutput::PushGroup("Depth pre-pass");
+        if (countFragments) {
+            glBeginQuery(GL_SAMPLES_PASSED, fragmentQueries[0]);
+        }
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        myScene.RenderDepth(mySceneDepthProgram, passFloor, lastPass);
+        myModules.RenderDepth(shaderProgramInstanced != 0 ? shaderProgramDepthInstanced : shaderProgramDepth,
+                              passFloor, lastPass);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        if (countFragments) {
+            glEndQuery(GL_SAMPLES_PASSED);
+        }
+        glDepthFunc(GL_EQUAL);          // Only the nearest surface passes
+        glDepthMask(GL_FALSE);
+        GlDebugOutput::PopGroup();
+        GlGpuProfiler::EndPass();
+    }
+    else if (countFragments) {
+        glBeginQuery(GL_SAMPLES_PASSED, fragmentQueries[0]);    // Counts nothing
+        glEndQuery(GL_SAMPLES_PASSED);
+    }
 
+    if (countFragments) {
+        glBeginQuery(GL_SAMPLES_PASSED, fragmentQueries[1]);
+    }
+    for (int pass = passFloor; pass <= lastPass; pass++) {
+        GlGpuProfiler::BeginPass(passNames[pass]);
+        GlDebugOutput::PushGroup(passNames[pass]);
+        myScene.Render(mySceneShaderProgram, pass, pass);
+        if (myModules.GetOcclusionQueries()) {
+            myModules.RenderOcclusionQueries(shaderProgramDepth, frustum, pass, pass);
+            occlusionGroupsHidden += myModules.NumGroupsHidden();
+            occlusionGroupsDrawn += myModules.NumGroupsDrawn();
+        }
+        if (shaderProgramInstanced != 0) {
+            myModules.RenderInstanced(shaderProgramInstanced, pass, pass);
+        }
+        else {
+            myModules.RenderOneByOne(shaderProgramBitmap, pass, pass);
+        }
+        GlDebugOutput::PopGroup();
+        GlGpuProfiler::EndPass();
+    }
+    if (countFragments) {
+        glEndQuery(GL_SAMPLES_PASSED);
+    }
+    occlusionFrames += myModules.GetOcclusionQueries() ? 1 : 0;
+    if (prepass) {
+        glDepthFunc(GL_LEQUAL);
+        glDepthMask(GL_TRUE);
+    }
 }
@@ -15,10 +15,40 @@
 //
 void MySetupSurfaces();                // Called once, before rendering begins.
 void SetupForTextures();               // Loads textures, sets Phong material
+void MySetupSceneTable();              // Builds the scene table (called by SetupForTextures)
+void MySetupCrateField(int fieldSize); // The map's crates (0), or a fieldSize x fieldSize field of crates
 void MyRemeshGeometries();             // Called when mesh changes, must update resolutions.
 void SamsRemeshCircularSurf();      // Update resolution of the surface of rotation.
 
-void MyRenderGeometries();            // Called to render the two surfaces
+void MyRenderGeometries();            // Renders the scene table and the module instances
+                                      //    (after a depth-only pass, if depthPrepass is set)
+bool MyDepthPrepassAvailable();       // True if all the passes are drawn with invariant shader programs (and depth-only ones)
+
+// The crates' occlusion groups found hidden (tested with their boxes) and drawn, summed over the frames.
+void MyGetOcclusionCounts(long long* groupsHidden, long long* groupsDrawn, long long* numFrames);
+// The objects and module instances culled by software occlusion, summed over the frames.
+void MyGetSoftwareOcclusionCounts(long long* objectsOccluded, long long* instancesOccluded, long long* numFrames);
+int MyNumOccluderTriangles();
+void MyResetOcclusionCounts();          // Resets the occlusion counts and the PVS counts
+
+// The potentially visible set of the map (see MapPvs.h).  Set up by MySetupSceneTable.
+bool MyBakePvs(const char* filename, int raysPerPair);     // Bake it and save it to the file
+bool MyLoadPvs(const char* filename);
+// The frames with the camera in a PVS cell, and the objects potentially visible summed over them
+void MyGetPvsCounts(long long* cellFrames, long long* visibleObjects, int* numObjects, long long* numFrames);
+
+// The map's triangles in a bounding volume hierarchy, for ray queries (see TriangleBvh.h):
+//    hitscan traces, picking and lines of sight.  Its objects are numbered as in the PVS.
+//    Set up by MySetupSceneTable.
+class TriangleBvh;
+const TriangleBvh& MyMapBvh();
+// The object seen at (ndcX,ndcY) in normalized device coordinates, and the point hit; -1 if none.
+int MyPickObject(double ndcX, double ndcY, double hitPoint[3]);
+bool MyBenchRays(int numRays);          // Times the ray queries, and checks the packets against the single rays
+
+// Counting the fragments (samples) drawn by MyRenderGeometries, with GL_SAMPLES_PASSED queries.
+void MySetCountFragments(bool countFragments);
+void MyGetFragmentCounts(long long* depthOnlyFragments, long long* shadedFragments);   // Waits for the last frame
 void SamsRenderCircularSurf();      // Renders the meshed circular surface
 
 
@@ -0,0 +1,248 @@
+// *******************************
+// MySceneShaders.glsl
+//
+// Extra shaders for rendering the map.
+//   Loaded with GlShaderMgr::LoadShaderSource(), after EduPhong.glsl.
+//   The vertex shaders here have the same outputs as vertexShader_PhongPhong
+//   in EduPhong.glsl, so they are linked with fragmentShader_PhongPhong.
+//   The depth-only shaders at the end are for the depth pre-pass.  Each
+//   computes gl_Position with the same expression as its main-pass shader.
+// *******************************
+
+// ***************************
+// Instanced vertex shader for Phong lighting with Phong shading.
+//   The model matrix is a per-instance vertex attribute (locations 9-12);
+//   the modelviewMatrix uniform holds only the view matrix.
+// ***************************
+#beginglsl vertexshader vertexShader_PhongPhongInstanced
+#version 330 core
+layout (location = 0) in vec3 vertPos;           // Position in attribute location 0
+layout (location = 1) in vec3 vertNormal;        // Surface normal in attribute location 1
+layout (location = 2) in vec2 vertTexCoords;     // Texture coordinates in attribute location 2
+layout (location = 3) in vec3 EmissiveColor;     // Surface material properties
+layout (location = 4) in vec3 AmbientColor;
+layout (location = 5) in vec3 DiffuseColor;
+layout (location = 6) in vec3 SpecularColor;
+layout (location = 7) in float SpecularExponent;
+layout (location = 8) in float UseFresnel;
+layout (location = 9) in mat4 instanceMatrix;    // Model matrix of the instance (locations 9-12)
+
+out vec3 mvPos;             // Vertex position in modelview coordinates
+out vec3 mvNormalFront;     // Normal vector to vertex in modelview coordinates
+out vec3 matEmissive;
+out vec3 matAmbient;
+out vec3 matDiffuse;
+out vec3 matSpecular;
+out float matSpecExponent;
+out vec2 theTexCoords;
+out float useFresnel;
+invariant gl_Position;      // The same depth as the depth pre-pass (for GL_EQUAL)
+
+uniform mat4 projectionMatrix;      // The projection matrix
+uniform mat4 modelviewMatrix;       // The view matrix (the model matrix comes from the instance)
+
+void main()
+{
+    mat4 mvMatrix = modelviewMatrix * instanceMatrix;
+    vec4 mvPos4 = mvMatrix * vec4(vertPos.x, vertPos.y, vertPos.z, 1.0);
+    gl_Position = projectionMatrix * mvPos4;
+    mvPos = vec3(mvPos4.x, mvPos4.y, mvPos4.z) / mvPos4.w;
+    mvNormalFront = normalize(inverse(transpose(mat3(mvMatrix))) * vertNormal);    // Unit normal from the surface
+    matEmissive = EmissiveColor;
+    matAmbient = AmbientColor;
+    matDiffuse = DiffuseColor;
+    matSpecular = SpecularColor;
+    matSpecExponent = SpecularExponent;
+    theTexCoords = vertTexCoords;
+    useFresnel = UseFresnel;
+}
+#endglsl
+
+// ***************************
+// Vertex shader for Phong lighting with Phong shading, with the modelview
+//   matrix in a uniform block.  GlSceneRenderer binds a range of its uniform
+//   ring to the block for each draw, in place of the modelviewMatrix uniform.
+// ***************************
+#beginglsl vertexshader vertexShader_PhongPhongDrawData
+#version 330 core
+layout (location = 0) in vec3 vertPos;           // Position in attribute location 0
+layout (location = 1) in vec3 vertNormal;        // Surface normal in attribute location 1
+layout (location = 2) in vec2 vertTexCoords;     // Texture coordinates in attribute location 2
+layout (location = 3) in vec3 EmissiveColor;     // Surface material properties
+layout (location = 4) in vec3 AmbientColor;
+layout (location = 5) in vec3 DiffuseColor;
+layout (location = 6) in vec3 SpecularColor;
+layout (location = 7) in float SpecularExponent;
+layout (location = 8) in float UseFresnel;
+
+out vec3 mvPos;             // Vertex position in modelview coordinates
+out vec3 mvNormalFront;     // Normal vector to vertex in modelview coordinates
+out vec3 matEmissive;
+out vec3 matAmbient;
+out vec3 matDiffuse;
+out vec3 matSpecular;
+out float matSpecExponent;
+out vec2 theTexCoords;
+out float useFresnel;
+invariant gl_Position;      // The same depth as the depth pre-pass (for GL_EQUAL)
+
+uniform mat4 projectionMatrix;      // The projection matrix
+layout (std140) uniform phDrawData {
+    mat4 modelviewMatrix;           // The modelview matrix of the draw
+};
+
+void main()
+{
+    vec4 mvPos4 = modelviewMatrix * vec4(vertPos.x, vertPos.y, vertPos.z, 1.0);
+    gl_Position = projectionMatrix * mvPos4;
+    mvPos = vec3(mvPos4.x, mvPos4.y, mvPos4.z) / mvPos4.w;
+    mvNormalFront = normalize(inverse(transpose(mat3(modelviewMatrix))) * vertNormal);    // Unit normal from the surface
+    matEmissive = EmissiveColor;
+    matAmbient = AmbientColor;
+    matDiffuse = DiffuseColor;
+    matSpecular = SpecularColor;
+    matSpecExponent = SpecularExponent;
+    theTexCoords = vertTexCoords;
+    useFresnel = UseFresnel;
+}
+#endglsl
+
+// ***************************
+// Vertex shader for Phong lighting with Phong shading, with the modelview
+//   matrix and the material ID of each object in an array of object records.
+//   GlSceneRenderer draws up to 128 objects with one multi-draw, and binds
+//   the batch's records; gl_DrawIDARB is the object's index in the batch.
+//   The materials are looked up in the table of phMaterialRegistry; the
+//   material vertex attributes (locations 3-8) are not used.
+// ***************************
+#beginglsl vertexshader vertexShader_PhongPhongObjectData
+#version 330 core
+#extension GL_ARB_shader_draw_parameters : require
+layout (location = 0) in vec3 vertPos;           // Position in attribute location 0
+layout (location = 1) in vec3 vertNormal;        // Surface normal in attribute location 1
+layout (location = 2) in vec2 vertTexCoords;     // Texture coordinates in attribute location 2
+
+out vec3 mvPos;             // Vertex position in modelview coordinates
+out vec3 mvNormalFront;     // Normal vector to vertex in modelview coordinates
+out vec3 matEmissive;
+out vec3 matAmbient;
+out vec3 matDiffuse;
+out vec3 matSpecular;
+out float matSpecExponent;
+out vec2 theTexCoords;
+out float useFresnel;
+invariant gl_Position;      // The same depth as the depth pre-pass (for GL_EQUAL)
+
+uniform mat4 projectionMatrix;      // The projection matrix
+
+struct phObjectData {
+    mat4 modelviewMatrix;
+    ivec4 materialID;               // Only x is used
+};
+layout (std140) uniform phObjectArray {
+    phObjectData objects[128];      // Must match GlSceneRenderer::MaxObjectsPerDraw
+};
+
+struct phMaterialData {
+    vec4 emissiveColor;             // Alpha: specular exponent
+    vec4 ambientColor;              // Alpha: 1.0 to use the Fresnel factor, else 0.0
+    vec4 diffuseColor;
+    vec4 specularColor;
+};
+layout (std140) uniform phMaterialTable {
+    phMaterialData materials[64];   // Must match phMaxNumMaterials
+};
+
+void main()
+{
+    mat4 mvMatrix = objects[gl_DrawIDARB].modelviewMatrix;
+    vec4 mvPos4 = mvMatrix * vec4(vertPos.x, vertPos.y, vertPos.z, 1.0);
+    gl_Position = projectionMatrix * mvPos4;
+    mvPos = vec3(mvPos4.x, mvPos4.y, mvPos4.z) / mvPos4.w;
+    mvNormalFront = normalize(inverse(transpose(mat3(mvMatrix))) * vertNormal);    // Unit normal from the surface
+    phMaterialData material = materials[objects[gl_DrawIDARB].materialID.x];
+    matEmissive = material.emissiveColor.rgb;
+    matAmbient = material.ambientColor.rgb;
+    matDiffuse = material.diffuseColor.rgb;
+    matSpecular = material.specularColor.rgb;
+    matSpecExponent = material.emissiveColor.a;
+    theTexCoords = vertTexCoords;
+    useFresnel = material.ambientColor.a;
+}
+#endglsl
+
+// ***************************
+// Depth-only shaders for the depth pre-pass.
+//   Only gl_Position is computed; the fragment shader does nothing.
+//   One vertex shader for each way the modelview matrix is supplied.
+// ***************************
+#beginglsl vertexshader vertexShader_DepthOnly
+#version 330 core
+layout (location = 0) in vec3 vertPos;
+invariant gl_Position;
+uniform mat4 projectionMatrix;
+uniform mat4 modelviewMatrix;
+void main()
+{
+    vec4 mvPos4 = modelviewMatrix * vec4(vertPos, 1.0);
+    gl_Position = projectionMatrix * mvPos4;
+}
+#endglsl
+
+#beginglsl vertexshader vertexShader_DepthOnlyInstanced
+#version 330 core
+layout (location = 0) in vec3 vertPos;
+layout (location = 9) in mat4 instanceMatrix;    // Model matrix of the instance (locations 9-12)
+invariant gl_Position;
+uniform mat4 projectionMatrix;
+uniform mat4 modelviewMatrix;       // The view matrix
+void main()
+{
+    mat4 mvMatrix = modelviewMatrix * instanceMatrix;
+    vec4 mvPos4 = mvMatrix * vec4(vertPos.x, vertPos.y, vertPos.z, 1.0);
+    gl_Position = projectionMatrix * mvPos4;
+}
+#endglsl
+
+#beginglsl vertexshader vertexShader_DepthOnlyDrawData
+#version 330 core
+layout (location = 0) in vec3 vertPos;
+invariant gl_Position;
+uniform mat4 projectionMatrix;
+layout (std140) uniform phDrawData {
+    mat4 modelviewMatrix;
+};
+void main()
+{
+    vec4 mvPos4 = modelviewMatrix * vec4(vertPos.x, vertPos.y, vertPos.z, 1.0);
+    gl_Position = projectionMatrix * mvPos4;
+}
+#endglsl
+
+#beginglsl vertexshader vertexShader_DepthOnlyObjectData
+#version 330 core
+#extension GL_ARB_shader_draw_parameters : require
+layout (location = 0) in vec3 vertPos;
+invariant gl_Position;
+uniform mat4 projectionMatrix;
+struct phObjectData {
+    mat4 modelviewMatrix;
+    ivec4 materialID;
+};
+layout (std140) uniform phObjectArray {
+    phObjectData objects[128];      // Must match GlSceneRenderer::MaxObjectsPerDraw
+};
+void main()
+{
+    mat4 mvMatrix = objects[gl_DrawIDARB].modelviewMatrix;
+    vec4 mvPos4 = mvMatrix * vec4(vertPos.x, vertPos.y, vertPos.z, 1.0);
+    gl_Position = projectionMatrix * mvPos4;
+}
+#endglsl
+
+#beginglsl fragmentshader fragmentShader_DepthOnly
+#version 330 core
+void main()
+{
+}
+#endglsl
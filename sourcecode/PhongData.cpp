@@ -8,7 +8,10 @@
 #include "LinearR4.h"
 #include "GlGeomSphere.h"
 #include "GlShaderMgr.h"
+#include "GlStateCache.h"
+#include "CpuProfiler.h"
 #include "TextureProj.h"
+#include "GlFrustum.h"
 
 extern phGlobal globalPhongData;
 
@@ -79,6 +82,8 @@ void MySetupLights()
 
 void LoadAllLights() 
 {
+    CpuProfileZone zone("LoadAllLights");
+    markFrameDirty();
     myLights[0].SetPosition(viewMatrix, myLightPositions[0]);
     myLights[0].LoadIntoShaders(0); 
 
@@ -129,17 +134,23 @@ void MySetupMaterials()
 // Purely emissive spheres showing placement of the light[0]
 // Use the light's diffuse color as the emissive color
 // Use the light's position as the sphere's position
+// Spheres outside the view frustum are skipped.
 void MyRenderSpheresForLights() {
    float matEntries[16];	// Holds 16 floats (since cannot load doubles into a shader that uses floats)
    phMaterial myEmissiveMaterial;
+   GlFrustum frustum(theProjectionMatrix * viewMatrix);
 
    for (int i = 0; i < 3; i++) {
+        const float center[3] = { (float)myLightPositions[i].x, (float)myLightPositions[i].y, (float)myLightPositions[i].z };
+        if (frustumCulling && !frustum.SphereVisible(center, 0.2f)) {
+            continue;
+        }
         if (myLights[i].IsEnabled) {
             LinearMapR4 modelviewMat = viewMatrix;
             modelviewMat.Mult_glTranslate(myLightPositions[i].x, myLightPositions[i].y,myLightPositions[i].z);
             modelviewMat.Mult_glScale(0.2);
             modelviewMat.DumpByColumns(matEntries);
-            glUniformMatrix4fv(modelviewMatLocation, 1, false, matEntries);
+            GlStateCache::UniformMatrix4fv(modelviewMatLocation, matEntries);
             myEmissiveMaterial.EmissiveColor = myLights[i].DiffuseColor;
             myEmissiveMaterial.LoadIntoShaders();
             myLightSphere.Render();
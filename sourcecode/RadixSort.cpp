@@ -0,0 +1,81 @@
+//
+// RadixSort.cpp
+//
+//   LSD radix sort of 64-bit keys with int values.  See RadixSort.h.
+//
+
+#include "RadixSort.h"
+#include "assert.h"
+#include <string.h>
+
+void RadixSorter::Sort(std::vector<unsigned long long>& keys, std::vector<int>& values)
+{
+    assert(keys.size() == values.size());
+    int n = (int)keys.size();
+    numPassesDone = 0;
+    if (n <= SmallSortSize) {
+        InsertionSort(keys.data(), values.data(), n);
+        return;
+    }
+
+    // Count all eight digits in one sweep over the keys.
+    unsigned int counts[8][256];
+    memset(counts, 0, sizeof(counts));
+    for (int i = 0; i < n; i++) {
+        unsigned long long key = keys[i];
+        for (int d = 0; d < 8; d++) {
+            counts[d][(key >> (8 * d)) & 0xff]++;
+        }
+    }
+
+    scratchKeys.resize(n);
+    scratchValues.resize(n);
+    unsigned long long* srcKeys = keys.data();
+    int* srcValues = values.data();
+    unsigned long long* dstKeys = scratchKeys.data();
+    int* dstValues = scratchValues.data();
+    for (int d = 0; d < 8; d++) {
+        int shift = 8 * d;
+        if (counts[d][(srcKeys[0] >> shift) & 0xff] == (unsigned int)n) {
+            continue;       // Every key has the same digit: this pass would not move anything
+        }
+        unsigned int offsets[256];
+        unsigned int sum = 0;
+        for (int b = 0; b < 256; b++) {
+            offsets[b] = sum;
+            sum += counts[d][b];
+        }
+        for (int i = 0; i < n; i++) {
+            unsigned int pos = offsets[(srcKeys[i] >> shift) & 0xff]++;
+            dstKeys[pos] = srcKeys[i];
+            dstValues[pos] = srcValues[i];
+        }
+        unsigned long long* tempKeys = srcKeys;
+        srcKeys = dstKeys;
+        dstKeys = tempKeys;
+        int* tempValues = srcValues;
+        srcValues = dstValues;
+        dstValues = tempValues;
+        numPassesDone++;
+    }
+    if (srcKeys != keys.data()) {
+        keys.swap(scratchKeys);
+        values.swap(scratchValues);
+    }
+}
+
+void RadixSorter::InsertionSort(unsigned long long* keys, int* values, int n)
+{
+    for (int i = 1; i < n; i++) {
+        unsigned long long key = keys[i];
+        int value = values[i];
+        int j = i - 1;
+        while (j >= 0 && keys[j] > key) {
+            keys[j + 1] = keys[j];
+            values[j + 1] = values[j];
+            j--;
+        }
+        keys[j + 1] = key;
+        values[j + 1] = value;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+//
+// RadixSort.h  ---  Header file for RadixSort.cpp
+//
+//   A least-significant-digit radix sort of 64-bit keys, each with an int
+//   value (e.g., the index of a draw packet).  Eight passes of 8 bits each;
+//   a pass is skipped when all keys have the same digit, so keys that differ
+//   only in a few bytes cost only a few passes.  The sort is stable.
+//
+//   The sorter keeps its scratch arrays between calls, so sorting every
+//   frame does not allocate memory.
+//
+
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <vector>
+
+class RadixSorter {
+
+public:
+    RadixSorter() {}
+
+    // Sort the pairs (keys[i], values[i]) by key.  Both arrays must have the same size.
+    void Sort(std::vector<unsigned long long>& keys, std::vector<int>& values);
+
+    int NumPassesDone() const { return numPassesDone; }    // In the most recent Sort (0 to 8)
+
+private:
+    static constexpr int SmallSortSize = 32;    // Fewer items are sorted by insertion
+
+    std::vector<unsigned long long> scratchKeys;
+    std::vector<int> scratchValues;
+    int numPassesDone = 0;
+
+    static void InsertionSort(unsigned long long* keys, int* values, int n);
+};
+
+#endif // RADIX_SORT_H
@@ -0,0 +1,324 @@
+//
+// SoftwareOcclusion.cpp
+//
+//   Occlusion culling on the CPU, with a small rasterized depth buffer.
+//   See SoftwareOcclusion.h.
+//
+
+#include "SoftwareOcclusion.h"
+#include "GlStaticGeometry.h"
+#include "GlFrustum.h"
+#include "LinearR4.h"
+#include "WorkerPool.h"
+#include "CpuProfiler.h"
+#include <math.h>
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SOFTWARE_OCCLUSION_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+SoftwareOcclusion::SoftwareOcclusion()
+{
+    static_assert(Width % TileSize == 0 && Height % TileSize == 0, "The buffer must be whole tiles");
+    static_assert(TileSize % 4 == 0, "Rows are rasterized four pixels at a time");
+    depthBuffer.assign((size_t)Width * Height, 0.0f);
+    tileDepth.assign((size_t)TilesWide * TilesHigh, 0.0f);
+}
+
+void SoftwareOcclusion::ClearOccluders()
+{
+    occluderVerts.clear();
+    rendered = false;
+}
+
+void SoftwareOcclusion::AddOccluder(const GlStaticGeometry& geometry, int mesh, const LinearMapR4* m)
+{
+    const GlMeshRange& range = geometry.GetMesh(mesh);
+    const std::vector<float>& vertexData = geometry.GetVertexData();
+    const std::vector<unsigned int>& elementData = geometry.GetElementData();
+    for (int i = range.firstIndex; i < range.firstIndex + range.numIndices; i++) {
+        const float* pos = &vertexData[(size_t)(range.baseVertex + elementData[i]) * GlStaticGeometry::FloatsPerVertex];
+        if (m == nullptr) {
+            occluderVerts.insert(occluderVerts.end(), pos, pos + 3);
+        }
+        else {
+            occluderVerts.push_back((float)(m->m11 * pos[0] + m->m12 * pos[1] + m->m13 * pos[2] + m->m14));
+            occluderVerts.push_back((float)(m->m21 * pos[0] + m->m22 * pos[1] + m->m23 * pos[2] + m->m24));
+            occluderVerts.push_back((float)(m->m31 * pos[0] + m->m32 * pos[1] + m->m33 * pos[2] + m->m34));
+        }
+    }
+}
+
+// **********************************************
+// Transform the occluders to clip coordinates, clip them by the near plane
+//    and set up their triangles on this thread; then rasterize the bands of
+//    tiles on the workers.  Each band clears and owns its own rows.
+// **********************************************
+void SoftwareOcclusion::Render(const LinearMapR4& m)
+{
+    CpuProfileZone zone("SoftwareOcclusion::Render");
+    const double rows[4][4] = {
+        { m.m11, m.m12, m.m13, m.m14 },
+        { m.m21, m.m22, m.m23, m.m24 },
+        { m.m31, m.m32, m.m33, m.m34 },
+        { m.m41, m.m42, m.m43, m.m44 } };
+    for (int r = 0; r < 4; r++) {
+        for (int c = 0; c < 4; c++) {
+            projView[r][c] = rows[r][c];
+        }
+    }
+
+    screenTriangles.clear();
+    int numTriangles = GetNumOccluderTriangles();
+    for (int t = 0; t < numTriangles; t++) {
+        double clip[3][4];
+        double nearDist[3];             // Distance inside the near plane, z + w
+        int numInside = 0;
+        for (int v = 0; v < 3; v++) {
+            const float* pos = &occluderVerts[(size_t)(9 * t + 3 * v)];
+            for (int r = 0; r < 4; r++) {
+                clip[v][r] = projView[r][0] * pos[0] + projView[r][1] * pos[1] + projView[r][2] * pos[2] + projView[r][3];
+            }
+            nearDist[v] = clip[v][2] + clip[v][3];
+            numInside += (nearDist[v] > 0.0);
+        }
+        if (numInside == 3) {
+            AddScreenTriangle(clip);
+            continue;
+        }
+        if (numInside == 0) {
+            continue;
+        }
+        // Clip by the near plane: the polygon has three or four vertices, drawn as a fan.
+        double poly[4][4];
+        int numPoly = 0;
+        for (int v = 0; v < 3; v++) {
+            int next = (v + 1) % 3;
+            if (nearDist[v] > 0.0) {
+                std::copy(clip[v], clip[v] + 4, poly[numPoly++]);
+            }
+            if ((nearDist[v] > 0.0) != (nearDist[next] > 0.0)) {
+                double s = nearDist[v] / (nearDist[v] - nearDist[next]);
+                for (int k = 0; k < 4; k++) {
+                    poly[numPoly][k] = clip[v][k] + s * (clip[next][k] - clip[v][k]);
+                }
+                numPoly++;
+            }
+        }
+        for (int v = 2; v < numPoly; v++) {
+            double fan[3][4];
+            std::copy(poly[0], poly[0] + 4, fan[0]);
+            std::copy(poly[v - 1], poly[v - 1] + 4, fan[1]);
+            std::copy(poly[v], poly[v] + 4, fan[2]);
+            AddScreenTriangle(fan);
+        }
+    }
+
+    WorkerPool::ParallelFor(TilesHigh, 1, [&](int begin, int end) {
+        CpuProfileZone chunkZone("Occluder band");
+        for (int band = begin; band < end; band++) {
+            RasterizeBand(band);
+        }
+    });
+    rendered = true;
+}
+
+// Pixels are inside when their centers are (edges included, so neighboring
+//    triangles leave no cracks); the depth is moved back by half a pixel's
+//    change in depth, so it is the farthest depth of the triangle in the pixel.
+void SoftwareOcclusion::AddScreenTriangle(const double clip[3][4])
+{
+    double sx[3], sy[3], invW[3];
+    for (int v = 0; v < 3; v++) {
+        invW[v] = 1.0 / clip[v][3];
+        sx[v] = (0.5 * clip[v][0] * invW[v] + 0.5) * Width;
+        sy[v] = (0.5 * clip[v][1] * invW[v] + 0.5) * Height;
+    }
+    double area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sy[1] - sy[0]) * (sx[2] - sx[0]);
+    if (area < 1.0e-6) {
+        return;         // Edge on, or back facing: the walls are one sided, and back faces are culled
+    }
+
+    ScreenTriangle tri;
+    double depthP = 0.0, depthQ = 0.0, depthR = 0.0;
+    for (int i = 0; i < 3; i++) {
+        int a = i, b = (i + 1) % 3, opposite = (i + 2) % 3;
+        double edgeA = sy[a] - sy[b];
+        double edgeB = sx[b] - sx[a];
+        double edgeC = sx[a] * sy[b] - sy[a] * sx[b];
+        depthP += edgeA * invW[opposite];
+        depthQ += edgeB * invW[opposite];
+        depthR += edgeC * invW[opposite];
+        tri.edgeA[i] = (float)edgeA;
+        tri.edgeB[i] = (float)edgeB;
+        tri.edgeC[i] = (float)edgeC;
+    }
+    depthP /= area;
+    depthQ /= area;
+    depthR /= area;
+    tri.depthP = (float)depthP;
+    tri.depthQ = (float)depthQ;
+    tri.depthR = (float)(depthR - 0.5 * (fabs(depthP) + fabs(depthQ)));
+
+    double minX = std::min(sx[0], std::min(sx[1], sx[2]));
+    double maxX = std::max(sx[0], std::max(sx[1], sx[2]));
+    double minY = std::min(sy[0], std::min(sy[1], sy[2]));
+    double maxY = std::max(sy[0], std::max(sy[1], sy[2]));
+    tri.minX = (int)floor(std::max(minX, 0.0));
+    tri.maxX = (int)std::min(floor(maxX), (double)(Width - 1));
+    tri.minY = (int)floor(std::max(minY, 0.0));
+    tri.maxY = (int)std::min(floor(maxY), (double)(Height - 1));
+    if (tri.minX > tri.maxX || tri.minY > tri.maxY) {
+        return;
+    }
+    screenTriangles.push_back(tri);
+}
+
+void SoftwareOcclusion::RasterizeBand(int band)
+{
+    const int firstRow = band * TileSize;
+    const int lastRow = firstRow + TileSize - 1;
+    std::fill(depthBuffer.begin() + (size_t)firstRow * Width, depthBuffer.begin() + (size_t)(lastRow + 1) * Width, 0.0f);
+
+    for (const ScreenTriangle& tri : screenTriangles) {
+        if (tri.maxY < firstRow || tri.minY > lastRow) {
+            continue;
+        }
+        int startY = std::max(tri.minY, firstRow);
+        int endY = std::min(tri.maxY, lastRow);
+        int startX = tri.minX & ~3;         // Four pixels at a time, aligned with the rows
+        for (int y = startY; y <= endY; y++) {
+            float* row = &depthBuffer[(size_t)y * Width];
+            float cy = y + 0.5f;
+            float cx = startX + 0.5f;
+            float e0 = tri.edgeA[0] * cx + tri.edgeB[0] * cy + tri.edgeC[0];
+            float e1 = tri.edgeA[1] * cx + tri.edgeB[1] * cy + tri.edgeC[1];
+            float e2 = tri.edgeA[2] * cx + tri.edgeB[2] * cy + tri.edgeC[2];
+            float depth = tri.depthP * cx + tri.depthQ * cy + tri.depthR;
+#ifdef SOFTWARE_OCCLUSION_USE_SSE
+            const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+            const __m128 zero = _mm_setzero_ps();
+            __m128 edge0 = _mm_add_ps(_mm_set1_ps(e0), _mm_mul_ps(_mm_set1_ps(tri.edgeA[0]), lanes));
+            __m128 edge1 = _mm_add_ps(_mm_set1_ps(e1), _mm_mul_ps(_mm_set1_ps(tri.edgeA[1]), lanes));
+            __m128 edge2 = _mm_add_ps(_mm_set1_ps(e2), _mm_mul_ps(_mm_set1_ps(tri.edgeA[2]), lanes));
+            __m128 depths = _mm_add_ps(_mm_set1_ps(depth), _mm_mul_ps(_mm_set1_ps(tri.depthP), lanes));
+            const __m128 step0 = _mm_set1_ps(4.0f * tri.edgeA[0]);
+            const __m128 step1 = _mm_set1_ps(4.0f * tri.edgeA[1]);
+            const __m128 step2 = _mm_set1_ps(4.0f * tri.edgeA[2]);
+            const __m128 depthStep = _mm_set1_ps(4.0f * tri.depthP);
+            for (int x = startX; x <= tri.maxX; x += 4) {
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)),
+                                           _mm_cmpge_ps(edge2, zero));
+                // Outside pixels get 0, which never replaces a depth (all depths are >= 0)
+                __m128 nearest = _mm_max_ps(_mm_loadu_ps(row + x), _mm_and_ps(inside, depths));
+                _mm_storeu_ps(row + x, nearest);
+                edge0 = _mm_add_ps(edge0, step0);
+                edge1 = _mm_add_ps(edge1, step1);
+                edge2 = _mm_add_ps(edge2, step2);
+                depths = _mm_add_ps(depths, depthStep);
+            }
+#else
+            for (int x = startX; x <= tri.maxX; x++) {
+                if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f && depth > row[x]) {
+                    row[x] = depth;
+                }
+                e0 += tri.edgeA[0];
+                e1 += tri.edgeA[1];
+                e2 += tri.edgeA[2];
+                depth += tri.depthP;
+            }
+#endif
+        }
+    }
+
+    for (int tx = 0; tx < TilesWide; tx++) {
+        float farthest = depthBuffer[(size_t)firstRow * Width + tx * TileSize];
+        for (int y = firstRow; y <= lastRow; y++) {
+            const float* row = &depthBuffer[(size_t)y * Width + tx * TileSize];
+            for (int x = 0; x < TileSize; x++) {
+                farthest = std::min(farthest, row[x]);
+            }
+        }
+        tileDepth[(size_t)band * TilesWide + tx] = farthest;
+    }
+}
+
+// The box's nearest depth is at one of its corners.  A box that reaches the
+//    near plane, or is off the screen, is left for the frustum culling.
+bool SoftwareOcclusion::BoxVisible(const float center[3], const float extent[3]) const
+{
+    if (!rendered) {
+        return true;
+    }
+    double minX = Width, maxX = 0.0, minY = Height, maxY = 0.0;
+    double nearest = 0.0;
+    for (int k = 0; k < 8; k++) {
+        double corner[3] = {
+            center[0] + ((k & 1) ? extent[0] : -extent[0]),
+            center[1] + ((k & 2) ? extent[1] : -extent[1]),
+            center[2] + ((k & 4) ? extent[2] : -extent[2]) };
+        double clip[4];
+        for (int r = 0; r < 4; r++) {
+            clip[r] = projView[r][0] * corner[0] + projView[r][1] * corner[1] + projView[r][2] * corner[2] + projView[r][3];
+        }
+        if (clip[2] + clip[3] <= 0.0 || clip[3] <= 0.0) {
+            return true;
+        }
+        double invW = 1.0 / clip[3];
+        double sx = (0.5 * clip[0] * invW + 0.5) * Width;
+        double sy = (0.5 * clip[1] * invW + 0.5) * Height;
+        minX = std::min(minX, sx);
+        maxX = std::max(maxX, sx);
+        minY = std::min(minY, sy);
+        maxY = std::max(maxY, sy);
+        nearest = std::max(nearest, invW);
+    }
+    // The pixels the box touches, and a border of one pixel for the occluders' edges
+    int x0 = (int)floor(std::max(minX - 1.0, 0.0));
+    int x1 = (int)std::min(floor(maxX + 1.0), (double)(Width - 1));
+    int y0 = (int)floor(std::max(minY - 1.0, 0.0));
+    int y1 = (int)std::min(floor(maxY + 1.0), (double)(Height - 1));
+    if (x0 > x1 || y0 > y1) {
+        return true;
+    }
+
+    // Moved slightly nearer, so an occluder can never hide the box it lies on (e.g., a wall's own box)
+    float boxDepth = (float)(nearest * 1.0001);
+    for (int ty = y0 / TileSize; ty <= y1 / TileSize; ty++) {
+        for (int tx = x0 / TileSize; tx <= x1 / TileSize; tx++) {
+            if (tileDepth[(size_t)ty * TilesWide + tx] > boxDepth) {
+                continue;           // The whole tile is nearer than the box
+            }
+            int rowStart = std::max(y0, ty * TileSize), rowEnd = std::min(y1, ty * TileSize + TileSize - 1);
+            int colStart = std::max(x0, tx * TileSize), colEnd = std::min(x1, tx * TileSize + TileSize - 1);
+            for (int y = rowStart; y <= rowEnd; y++) {
+                const float* row = &depthBuffer[(size_t)y * Width];
+                for (int x = colStart; x <= colEnd; x++) {
+                    if (row[x] <= boxDepth) {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+int SoftwareOcclusion::BoxesVisible(const GlCullBoxes& boxes, int begin, int end, unsigned char* visible) const
+{
+    int numHidden = 0;
+    for (int i = begin; i < end; i++) {
+        if (!visible[i]) {
+            continue;
+        }
+        const float center[3] = { boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i] };
+        const float extent[3] = { boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i] };
+        if (!BoxVisible(center, extent)) {
+            visible[i] = 0;
+            numHidden++;
+        }
+    }
+    return numHidden;
+}
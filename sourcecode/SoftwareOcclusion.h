@@ -0,0 +1,101 @@
+#pragma once
+
+//
+// SoftwareOcclusion.h  ---  Header file for SoftwareOcclusion.cpp
+//
+//   Occlusion culling on the CPU.  The large occluders (the walls and the
+//   covers) are rasterized into a small depth buffer, and each object's
+//   bounding box is then tested against it: an object is hidden if every
+//   pixel its box could cover already holds a nearer occluder.
+//
+//   The depth buffer holds 1/w (w is the distance along the view direction),
+//   which is linear across the screen; larger values are nearer.  The buffer
+//   is split into tiles, and each tile also keeps its farthest depth, so most
+//   boxes are decided a tile at a time.
+//
+//   Both steps lean toward keeping objects: an occluder covers the pixels
+//   whose centers are inside its front facing triangles (so triangles that
+//   share an edge leave no cracks), at the farthest depth of the triangle in
+//   the pixel; a box covers every pixel it touches plus a border of one
+//   pixel, at the depth of its nearest corner.
+//
+//   Render rasterizes the occluders on the worker threads (see WorkerPool.h),
+//   one band of tiles per task and four pixels at a time with SSE when it is
+//   available.  It makes no OpenGL calls and needs no readback from the GPU.
+//
+//   Why these choices:
+//     1/w does not depend on the near and far planes, and a float keeps the
+//     same relative precision for it at every distance; OpenGL's z/w spends
+//     most of its precision near the near plane.  Nothing (the cleared value)
+//     is simply 0, the depth of a point at infinity.
+//     256 x 128 pixels (half as high, like most windows) is enough for a few
+//     dozen large occluders: a box covers an extra pixel all around, so a
+//     coarser buffer only keeps more objects, never hides a visible one.
+//     8 x 8 tiles give 16 bands, enough to keep the worker threads busy,
+//     and one compare against a tile's farthest depth settles most boxes.
+//     A deeper depth pyramid would not pay for itself with so few occluders.
+//     Four pixels at a time with SSE (part of every x64 target) needs no
+//     compiler flags or run-time dispatch, unlike AVX2, and with a buffer
+//     this small the triangle setup costs as much as the pixels.
+//
+
+#ifndef SOFTWARE_OCCLUSION_H
+#define SOFTWARE_OCCLUSION_H
+
+#include <vector>
+
+class LinearMapR4;
+class GlStaticGeometry;
+class GlCullBoxes;
+
+class SoftwareOcclusion {
+
+public:
+    static constexpr int Width = 256;       // The depth buffer covers the whole viewport
+    static constexpr int Height = 128;
+    static constexpr int TileSize = 8;      // Tiles of TileSize x TileSize pixels
+
+    SoftwareOcclusion();
+
+    // The occluders.  The triangles of the mesh are placed by the model matrix
+    //    (nullptr for the identity) and kept in world coordinates.
+    void ClearOccluders();
+    void AddOccluder(const GlStaticGeometry& geometry, int mesh, const LinearMapR4* modelMatrix = nullptr);
+    int GetNumOccluderTriangles() const { return (int)(occluderVerts.size() / 9); }
+
+    // Rasterize the occluders seen through projectionMatrix * viewMatrix.  Call from the OpenGL thread.
+    void Render(const LinearMapR4& projViewMatrix);
+
+    // Could any part of the box (in world coordinates) be seen past the occluders?
+    bool BoxVisible(const float center[3], const float extent[3]) const;
+    // Test boxes begin through end-1 that have visible[i] set, and clear visible[i]
+    //    for the hidden ones.  Returns the number of boxes that were hidden.
+    int BoxesVisible(const GlCullBoxes& boxes, int begin, int end, unsigned char* visible) const;
+
+private:
+    static constexpr int TilesWide = Width / TileSize;
+    static constexpr int TilesHigh = Height / TileSize;
+
+    // The occluder triangles, 3 vertices of 3 floats each
+    std::vector<float> occluderVerts;
+
+    // A triangle set up for rasterizing: edge functions a*x + b*y + c >= 0
+    //    inside, and 1/w as p*x + q*y + r (already moved back by half a
+    //    pixel); bounded by the pixel rectangle.
+    struct ScreenTriangle {
+        float edgeA[3], edgeB[3], edgeC[3];
+        float depthP, depthQ, depthR;
+        int minX, maxX, minY, maxY;
+    };
+    std::vector<ScreenTriangle> screenTriangles;
+    void AddScreenTriangle(const double clip[3][4]);
+
+    double projView[4][4];              // The matrix of the last Render, by rows
+    bool rendered = false;
+
+    std::vector<float> depthBuffer;     // Width x Height: 1/w of the nearest occluder, 0 if none
+    std::vector<float> tileDepth;       // TilesWide x TilesHigh: the farthest depth in each tile
+    void RasterizeBand(int band);       // One row of tiles
+};
+
+#endif // SOFTWARE_OCCLUSION_H
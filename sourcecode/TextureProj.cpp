@@ -35,6 +35,21 @@
 #include "EduPhong.h"
 #include "PhongData.h"
 #include "GlShaderMgr.h"
+#include "GlStateCache.h"
+#include "GlDebugOutput.h"
+#include "GlGpuProfiler.h"
+#include "CpuProfiler.h"
+#include "FrameTimeHistogram.h"
+#include "HeadlessContext.h"
+#include "GlOffscreenTarget.h"
+#include "RgbImage.h"
+#include "BenchRender.h"
+#include "GoldenImageTest.h"
+#include "GlFrameCapture.h"
+#include "WorkerPool.h"
+#include "MapPvs.h"
+#include "GlUniformRing.h"
+#include "GlSceneRenderer.h"
 #include "GlGeomSphere.h"
 #include "GlGeomCylinder.h"
 #include "GlGeomTorus.h"
@@ -42,6 +57,8 @@
 // Enable standard input and output via printf(), etc.
 // Put this include *after* the includes for glew and GLFW!
 #include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
 
 #include "TextureProj.h"
 #include "MyGeometries.h"
@@ -66,10 +83,19 @@ phGlobal globalPhongData;
 bool wireframeMode = false;	// Equals true for polygon GL_LINE mode. False for polygon GL_FILL mode.
 bool cullBackFaces = true;
 bool renderFloorOnly = false;
+bool frustumCulling = true;
+bool depthPrepass = false;
+bool occlusionQueries = false;
+bool softwareOcclusion = false;
+bool pvsCulling = false;
+const char* pvsFilename = nullptr;     // The PVS to load at startup (--pvs)
 
 // The next variable controls the resolution of the meshes for cylinders and spheres and tori.
 int meshRes=4;             // Resolution of the meshes (slices, stacks, and rings all equal)
 
+// The crate field: 0 for the map's four crates, or N for an N x N field of crates (a stress test).
+int crateFieldSize = 0;
+
 // These variables control the animation's state and speed.
 // YOUR CODE WILL NOT USE THIS UNLESS YOU ADD ANIMATION  
 double animateIncrement = 0.01;   // Make bigger to speed up animation, smaller to slow it down.
@@ -77,6 +103,29 @@ double currentTime = 0.0;         // Current "time" for the animation.
 bool spinMode = true;       // Controls whether running or paused.
 double currentDelta = 0.0;        // Current state of the animation (YOUR CODE MAY NOT WANT TO USE THIS.)
 
+// The animation is simulated with a fixed time step, independent of the frame rate.
+//   Each step advances currentTime by animateIncrement (while running).
+//   Frames are rendered at a time interpolated between the last two steps.
+const double simStepSeconds = 1.0 / 60.0;   // Length of one simulation step, in seconds
+const double maxFrameSeconds = 0.25;        // Longer frames are clamped, so the simulation cannot fall far behind
+double previousTime = 0.0;                  // currentTime before the last step
+double animationAlpha = 0.0;                // Fraction of a step since the last step (0 to 1)
+
+// Frame pacing: vsync, adaptive vsync (late frames are not held back), or unlimited (for benchmarks).
+SwapMode swapMode = SwapVsync;
+const char* swapModeNames[NumSwapModes] = { "vsync", "adaptive vsync", "unlimited" };
+FrameTimeHistogram frameTimes;              // Time between successive frames
+
+// Render on demand: when nothing has changed since the last frame, the main loop
+//   sleeps in glfwWaitEvents instead of redrawing the same frame.
+//   Anything that changes what is seen calls markFrameDirty().
+bool renderOnDemand = true;
+bool frameDirty = true;
+
+// Video capture: the 'P' key or --capture starts and stops recording the rendered frames.
+GlFrameCapture frameCapture;
+const char* captureFilename = "capture.y4m";
+
 // ************************
 // General data helping with setting up VAO (Vertex Array Objects)
 //    and Vertex Buffer Objects.
@@ -84,6 +133,17 @@ double currentDelta = 0.0;        // Current state of the animation (YOUR CODE M
 
 unsigned int shaderProgramBitmap;       // The shader program that applies a bitmapped texture map (from a file)
 unsigned int shaderProgramProc ;       // The shader program that applies a procedural texture map
+unsigned int shaderProgramInstanced = 0;    // Instanced version of shaderProgramBitmap (0 if not available)
+unsigned int shaderProgramDrawData = 0;     // shaderProgramBitmap with the modelview matrix in a uniform block (0 if not available)
+unsigned int shaderProgramObjectData = 0;   // shaderProgramBitmap with the object records indexed by draw ID (0 if not available)
+unsigned int shaderProgramDepth = 0;            // The depth-only programs (for the depth pre-pass)
+unsigned int shaderProgramDepthInstanced = 0;
+unsigned int shaderProgramDepthDrawData = 0;
+unsigned int shaderProgramDepthObjectData = 0;
+
+// The uniform ring: the lights and the scene's modelview matrices for each frame in flight.
+GlUniformRing uniformRing;
+const int uniformRingRegionBytes = 64 * 1024;
 
 unsigned int modelviewMatLocation;					// Location of the modelviewMatrix in the currently active shader program
 unsigned int applyTextureLocation; 					// Location of the applyTexture bool in the currently active shader program
@@ -122,6 +182,7 @@ int screenWidth = 800, screenHeight = 600;     // Width and height in pixels. In
 // This routine is only called once to initialize the data.
 // *************************
 void mySetupGeometries() {
+    CpuProfileZone zone("mySetupGeometries");
  
     MySetupSurfaces();
 
@@ -131,6 +192,7 @@ void mySetupGeometries() {
 }
 
 void mySetViewMatrix() {
+    markFrameDirty();
     // Set the view matrix. Sets view distance, and view direction.
     // The final translation is done because the ground plane lies in the xz-plane,
     //    se the center of the scene is about 3 or 4 units above the origin.
@@ -141,6 +203,16 @@ void mySetViewMatrix() {
     viewMatrix.Mult_glTranslate(0.0, -3.5, 0.0);                // Translate the scene down the y-axis so the center is near the origin.
 }
 
+// Set the view, as the arrow keys and HOME/END do, but all at once.
+void mySetView(double azimuth, double direction, double extraDistance) {
+    viewAzimuth = azimuth;
+    viewDirection = direction;
+    ZextraDistance = extraDistance;
+    mySetViewMatrix();
+    setProjectionMatrix();
+    LoadAllLights();        // Have to call this since it affects the position of the lights!
+}
+
 // *************************************
 // Main routine for rendering the scene
 // myRenderScene() is called every time the scene needs to be redrawn.
@@ -149,11 +221,14 @@ void mySetViewMatrix() {
 // The EduPhong shaders are already setup.
 // *************************************
 void myRenderScene() {
+    CpuProfileZone zone("myRenderScene");
 
-    currentTime += animateIncrement;
-    currentTime -= floor(currentTime);
+    GlGpuProfiler::BeginFrame();        // Also collects the GPU times of an earlier frame
+    uniformRing.BeginFrame();           // Waits only if the GPU is still using the region
+    phLoadLightBlocks(&uniformRing);
+    phMaterialRegistry::LoadIntoShaders();     // Uploads only if a material was edited
     selectShaderProgram(shaderProgramProc);
-    glUniform1f(timeLoc, (float)currentTime);
+    GlStateCache::Uniform1f(timeLoc, (float)myAnimationTimeForRender());
    
     // Clear the rendering window
     static const float black[] = { 0.0f, 0.0f, 0.0f, 0.0f };
@@ -162,15 +237,99 @@ void myRenderScene() {
     glClearBufferfv(GL_DEPTH, 0, &clearDepth);	// Must pass in a *pointer* to the depth
 
     selectShaderProgram(shaderProgramProc);
-    glUniform1i(applyTextureLocation, false);           // Turn off applying texture
+    GlStateCache::Uniform1i(applyTextureLocation, false);           // Turn off applying texture
+    GlGpuProfiler::BeginPass("Light spheres");
     MyRenderSpheresForLights();
+    GlGpuProfiler::EndPass();
 
     MyRenderGeometries();
+    uniformRing.EndFrame();
+    GlGpuProfiler::EndFrame();
 
-    check_for_opengl_errors();   // Really a great idea to check for errors -- esp. good for debugging!
+    GlDebugOutput::CheckHotPath("myRenderScene");   // Compiled out in release builds
+}
+
+// *************************************
+// Advance the animation by one fixed simulation step (simStepSeconds).
+// *************************************
+void myAdvanceAnimation() {
+    if (spinMode || previousTime != currentTime) {
+        markFrameDirty();       // The animation moved (or must settle after being paused)
+    }
+    previousTime = currentTime;
+    if (spinMode) {
+        currentTime += animateIncrement;
+        currentTime -= floor(currentTime);
+    }
+}
+
+// Jump the animation to the given time (0 to 1): frames render exactly this time until the next step.
+void mySetAnimationTime(double time) {
+    currentTime = time - floor(time);
+    previousTime = currentTime;
+    animationAlpha = 1.0;
+    markFrameDirty();
+}
+
+void markFrameDirty() {
+    frameDirty = true;
+}
+
+// The animation time to render: between the last two steps, by animationAlpha.
+//   currentTime wraps around from 1 to 0, so interpolate across the wrap.
+double myAnimationTimeForRender() {
+    double endTime = currentTime < previousTime ? currentTime + 1.0 : currentTime;
+    double t = previousTime + animationAlpha * (endTime - previousTime);
+    return t - floor(t);
+}
+
+// *************************************
+// Set how buffer swaps are paced.
+// Adaptive vsync needs the swap_control_tear extension; without it, it falls back to vsync.
+// *************************************
+void setSwapMode(SwapMode mode) {
+    int interval = 1;
+    if (mode == SwapAdaptive) {
+        if (glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+            interval = -1;
+        }
+        else {
+            printf("Adaptive vsync is not supported: using vsync.\n");
+        }
+    }
+    else if (mode == SwapUnlimited) {
+        interval = 0;
+    }
+    glfwSwapInterval(interval);
+    swapMode = mode;
+    frameTimes.Reset();
+    printf("Frame pacing: %s.\n", swapModeNames[mode]);
+}
+
+// Link a depth-only shader program (for the depth pre-pass) from MySceneShaders.glsl.
+//   If blockName is not null, the program's uniform block of that name is bound to blockBinding.
+//   Returns 0 if the program is not available.
+unsigned int linkDepthProgram(const char* vertexShaderName, unsigned int fragmentShader,
+                              const char* blockName = nullptr, unsigned int blockBinding = 0) {
+    unsigned int vertexShader = GlShaderMgr::CompileShader(vertexShaderName);
+    if (vertexShader == 0 || fragmentShader == 0) {
+        return 0;
+    }
+    unsigned int shaderList[2] = { vertexShader, fragmentShader };
+    unsigned int program = GlShaderMgr::LinkShaderProgram(2, shaderList);
+    if (program != 0 && blockName != nullptr) {
+        unsigned int blockIndex = glGetUniformBlockIndex(program, blockName);
+        if (blockIndex == GL_INVALID_INDEX) {
+            return 0;
+        }
+        glUniformBlockBinding(program, blockIndex, blockBinding);
+    }
+    GlDebugOutput::LabelObject(GL_PROGRAM, program, vertexShaderName);
+    return program;
 }
 
 void my_setup_SceneData() {
+    CpuProfileZone zone("my_setup_SceneData");
 
     GlShaderMgr::LoadShaderSource("EduPhong.glsl");
     GlShaderMgr::LoadShaderSource("MyShaders.glsl");
@@ -183,6 +342,7 @@ void my_setup_SceneData() {
     unsigned int shaderList1[2] = { vertexShader1 , fragmentShader1 };
     shaderProgramBitmap = GlShaderMgr::LinkShaderProgram(2, shaderList1);
     phRegisterShaderProgram(shaderProgramBitmap);
+    GlDebugOutput::LabelObject(GL_PROGRAM, shaderProgramBitmap, "shaderProgramBitmap");
 
     // The second shader program applies a procedural texture map -- Defined in MyShaders.glsl
     // FOR PROJECT 6: YOU WILL RE_WRITE THE SHADER CODE IN MyShaders.glsl.
@@ -190,13 +350,95 @@ void my_setup_SceneData() {
     unsigned int shaderList2[2] = { vertexShader1 , fragmentShader2 };
     shaderProgramProc = GlShaderMgr::LinkShaderProgram(2, shaderList2);
     phRegisterShaderProgram(shaderProgramProc);
+    GlDebugOutput::LabelObject(GL_PROGRAM, shaderProgramProc, "shaderProgramProc");
 
     timeLoc = glGetUniformLocation(shaderProgramProc, "currentTime");
 
+    // The third shader program is shaderProgramBitmap with an instanced vertex shader -- Defined in MySceneShaders.glsl
+    // It draws the repeated modules (crates, etc.).  If it is not available, the modules are drawn one by one.
+    if (GlShaderMgr::LoadShaderSource("MySceneShaders.glsl")) {
+        unsigned int vertexShader3 = GlShaderMgr::CompileShader("vertexShader_PhongPhongInstanced");
+        if (vertexShader3 != 0) {
+            unsigned int shaderList3[2] = { vertexShader3 , fragmentShader1 };
+            shaderProgramInstanced = GlShaderMgr::LinkShaderProgram(2, shaderList3);
+        }
+        if (shaderProgramInstanced != 0 && !phRegisterShaderProgram(shaderProgramInstanced)) {
+            shaderProgramInstanced = 0;
+        }
+        GlDebugOutput::LabelObject(GL_PROGRAM, shaderProgramInstanced, "shaderProgramInstanced");
+    }
+    if (shaderProgramInstanced == 0) {
+        printf("Instanced shader program not available: drawing modules one instance at a time.\n");
+    }
+
+    // The fourth shader program is shaderProgramBitmap with the modelview matrix in a uniform block,
+    //    loaded from the uniform ring.  It draws the scene table.  If it is not available, the
+    //    scene table is drawn with shaderProgramBitmap.
+    uniformRing.Create(uniformRingRegionBytes);
+    unsigned int vertexShader4 = GlShaderMgr::CompileShader("vertexShader_PhongPhongDrawData");
+    if (vertexShader4 != 0) {
+        unsigned int shaderList4[2] = { vertexShader4 , fragmentShader1 };
+        shaderProgramDrawData = GlShaderMgr::LinkShaderProgram(2, shaderList4);
+    }
+    if (shaderProgramDrawData != 0) {
+        unsigned int drawDataIndex = glGetUniformBlockIndex(shaderProgramDrawData, GlSceneRenderer::DrawDataBlockName);
+        if (drawDataIndex == GL_INVALID_INDEX || !phRegisterShaderProgram(shaderProgramDrawData)) {
+            shaderProgramDrawData = 0;
+        }
+        else {
+            glUniformBlockBinding(shaderProgramDrawData, drawDataIndex, GlSceneRenderer::DrawDataBinding);
+            GlDebugOutput::LabelObject(GL_PROGRAM, shaderProgramDrawData, "shaderProgramDrawData");
+        }
+    }
+
+    // The fifth shader program takes the modelview matrix and the material ID of each object
+    //    from an array of object records, indexed by gl_DrawIDARB, and the materials from
+    //    phMaterialRegistry's table, so the scene table is drawn with one multi-draw per texture.
+    //    It needs ARB_shader_draw_parameters (OpenGL 4.6).
+    if (GLEW_VERSION_4_6 || GLEW_ARB_shader_draw_parameters) {
+        unsigned int vertexShader5 = GlShaderMgr::CompileShader("vertexShader_PhongPhongObjectData");
+        if (vertexShader5 != 0) {
+            unsigned int shaderList5[2] = { vertexShader5 , fragmentShader1 };
+            shaderProgramObjectData = GlShaderMgr::LinkShaderProgram(2, shaderList5);
+        }
+    }
+    if (shaderProgramObjectData != 0) {
+        unsigned int objectDataIndex = glGetUniformBlockIndex(shaderProgramObjectData, GlSceneRenderer::ObjectDataBlockName);
+        unsigned int materialTableIndex = glGetUniformBlockIndex(shaderProgramObjectData, phMaterialTableName);
+        if (objectDataIndex == GL_INVALID_INDEX || materialTableIndex == GL_INVALID_INDEX
+                || !phRegisterShaderProgram(shaderProgramObjectData)) {
+            shaderProgramObjectData = 0;
+        }
+        else {
+            glUniformBlockBinding(shaderProgramObjectData, objectDataIndex, GlSceneRenderer::ObjectDataBinding);
+            glUniformBlockBinding(shaderProgramObjectData, materialTableIndex, phMaterialTableBinding);
+            GlDebugOutput::LabelObject(GL_PROGRAM, shaderProgramObjectData, "shaderProgramObjectData");
+        }
+    }
+
+    // The depth-only programs for the depth pre-pass: one for each way of loading the modelview matrix.
+    //    They are not registered with EduPhong, since they have no lights.
+    unsigned int fragmentShaderDepth = GlShaderMgr::CompileShader("fragmentShader_DepthOnly");
+    shaderProgramDepth = linkDepthProgram("vertexShader_DepthOnly", fragmentShaderDepth);
+    if (shaderProgramInstanced != 0) {
+        shaderProgramDepthInstanced = linkDepthProgram("vertexShader_DepthOnlyInstanced", fragmentShaderDepth);
+    }
+    if (shaderProgramDrawData != 0) {
+        shaderProgramDepthDrawData = linkDepthProgram("vertexShader_DepthOnlyDrawData", fragmentShaderDepth,
+                                                      GlSceneRenderer::DrawDataBlockName, GlSceneRenderer::DrawDataBinding);
+    }
+    if (shaderProgramObjectData != 0) {
+        shaderProgramDepthObjectData = linkDepthProgram("vertexShader_DepthOnlyObjectData", fragmentShaderDepth,
+                                                        GlSceneRenderer::ObjectDataBlockName, GlSceneRenderer::ObjectDataBinding);
+    }
+
     mySetupGeometries();
     check_for_opengl_errors();
     SetupForTextures();   // The shader programs should be compiled and linked before setting up textures.
     check_for_opengl_errors();
+    if (pvsFilename != nullptr && !MyLoadPvs(pvsFilename)) {
+        pvsCulling = false;
+    }
 
     MySetupGlobalLight();
     MySetupLights();
@@ -208,7 +450,7 @@ void my_setup_SceneData() {
 
 void selectShaderProgram(unsigned int shaderProgram) {
     assert(shaderProgram == shaderProgramBitmap || shaderProgram == shaderProgramProc);
-    glUseProgram(shaderProgram);
+    GlStateCache::UseProgram(shaderProgram);
     modelviewMatLocation = phGetModelviewMatLoc(shaderProgram);
     applyTextureLocation = phGetApplyTextureLoc(shaderProgram);
 }
@@ -239,8 +481,42 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     }
     case 'R':
         spinMode = !spinMode;	// Toggle animation on and off.
+        if (!spinMode) {
+            previousTime = currentTime;     // Show the paused animation at exactly currentTime
+        }
+        markFrameDirty();
+        return;
+    case 'O':       // Toggle rendering on demand (otherwise every frame is rendered)
+        renderOnDemand = !renderOnDemand;
+        printf("Render on demand: %s.\n", renderOnDemand ? "on" : "off");
+        markFrameDirty();
+        return;
+    case 'Z':       // Toggle the depth pre-pass, and report the fragments it saves
+        depthPrepass = !depthPrepass;
+        printf("Depth pre-pass: %s.\n", depthPrepass ? "on" : "off");
+        printDepthPrepassReport();
+        markFrameDirty();
+        return;
+    case 'B':       // Toggle occlusion queries (bounding boxes) for the crates
+        printOcclusionReport();
+        occlusionQueries = !occlusionQueries;
+        printf("Occlusion queries: %s.\n", occlusionQueries ? "on" : "off");
+        markFrameDirty();
+        return;
+    case 'X':       // Toggle software occlusion culling (the walls rasterized on the CPU)
+        printOcclusionReport();
+        softwareOcclusion = !softwareOcclusion;
+        printf("Software occlusion culling: %s.\n", softwareOcclusion ? "on" : "off");
+        markFrameDirty();
+        return;
+    case 'L':       // Toggle the potentially visible set (looked up by the camera's cell)
+        printOcclusionReport();
+        pvsCulling = !pvsCulling;
+        printf("PVS culling: %s.\n", pvsCulling ? "on" : "off");
+        markFrameDirty();
         return;
     case 'W':		// Toggle wireframe mode
+        markFrameDirty();
         if (wireframeMode) {
             wireframeMode = false;
             glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
@@ -251,6 +527,7 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         }
         return;
     case 'C':		// Toggle backface culling
+        markFrameDirty();
         cullBackFaces = !cullBackFaces;     // Negate truth value of cullBackFaces
         if (cullBackFaces) {
             glEnable(GL_CULL_FACE);
@@ -268,6 +545,36 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         }
         MyRemeshGeometries();
         return;
+    case 'K':       // Cycle the crate field: the map's crates, then 8x8, 32x32 and 128x128 crates
+        crateFieldSize = (crateFieldSize == 0) ? 8 : (crateFieldSize < 128 ? 4 * crateFieldSize : 0);
+        MySetupCrateField(crateFieldSize);
+        markFrameDirty();
+        printf("Crate field: %d crates.\n", crateFieldSize == 0 ? 4 : crateFieldSize * crateFieldSize);
+        return;
+    case 'Y':       // Cycle the frame pacing: vsync, adaptive vsync, unlimited
+        setSwapMode((SwapMode)((swapMode + 1) % NumSwapModes));
+        return;
+    case 'H':       // Print the histogram of frame times, and start a new one
+        frameTimes.Print("Frame times");
+        frameTimes.Reset();
+        return;
+    case 'P':       // Start or stop capturing the rendered frames to a video file
+        if (frameCapture.IsCapturing()) {
+            frameCapture.Stop();
+        }
+        else {
+            frameCapture.Start(captureFilename, screenWidth, screenHeight);
+        }
+        return;
+    case 'T':       // Save the CPU profile zones recorded so far
+        CpuProfiler::DumpChromeTrace("cpu_trace.json");
+        return;
+    case 'G':       // Print the GPU time of each render pass, and save it for comparing builds
+        GlGpuProfiler::PrintReport();
+        if (GlGpuProfiler::DumpCSV("gpu_profile.csv") && GlGpuProfiler::DumpJSON("gpu_profile.json")) {
+            printf("GPU pass times saved in gpu_profile.csv and gpu_profile.json.\n");
+        }
+        return;
     case 'F':
         if (mods & GLFW_MOD_SHIFT) {                // If upper case 'F'
             animateIncrement *= sqrt(2.0);			// Double the animation time step after two key presses
@@ -337,6 +644,31 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     else {
         // Updated the global phong data above: upload it to the shader program.
         globalPhongData.LoadIntoShaders();
+        markFrameDirty();
+    }
+}
+
+// *************************************************
+// A click of the left mouse button picks the object under the cursor,
+//    with a ray query against the map (see MyPickObject).
+// *************************************************
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+    if (button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS) {
+        return;
+    }
+    double cursorX, cursorY;
+    int windowWidth, windowHeight;
+    glfwGetCursorPos(window, &cursorX, &cursorY);
+    glfwGetWindowSize(window, &windowWidth, &windowHeight);    // The cursor is in window coordinates, not pixels
+    double ndcX = 2.0 * cursorX / (windowWidth > 0 ? windowWidth : 1) - 1.0;
+    double ndcY = 1.0 - 2.0 * cursorY / (windowHeight > 0 ? windowHeight : 1);
+    double hitPoint[3];
+    int object = MyPickObject(ndcX, ndcY, hitPoint);
+    if (object < 0) {
+        printf("Pick: nothing under the cursor.\n");
+    }
+    else {
+        printf("Pick: object %d at (%.2f, %.2f, %.2f).\n", object, hitPoint[0], hitPoint[1], hitPoint[2]);
     }
 }
 
@@ -353,6 +685,16 @@ void window_size_callback(GLFWwindow* window, int width, int height) {
     screenWidth = width == 0 ? 1 : width;
     screenHeight = height==0 ? 1 : height;
     setProjectionMatrix();
+    markFrameDirty();
+    if (frameCapture.IsCapturing() && (screenWidth != frameCapture.GetWidth() || screenHeight != frameCapture.GetHeight())) {
+        printf("Capture stopped: the window was resized.\n");
+        frameCapture.Stop();
+    }
+}
+
+// Called when the window must be redrawn, e.g., after being uncovered.
+void window_refresh_callback(GLFWwindow* window) {
+    markFrameDirty();
 }
 
 void setProjectionMatrix() {
@@ -382,14 +724,14 @@ void setProjectionMatrix() {
                                       -windowYmax * scale, windowYmax * scale, zNear, zFar);
     float matEntries[16];
     theProjectionMatrix.DumpByColumns(matEntries);
-    if (glIsProgram(shaderProgramBitmap)) {
-        check_for_opengl_errors();
-        glUseProgram(shaderProgramBitmap);
-        glUniformMatrix4fv(phGetProjMatLoc(shaderProgramBitmap), 1, false, matEntries);
-    }
-    if (glIsProgram(shaderProgramProc)) {
-        glUseProgram(shaderProgramProc);
-        glUniformMatrix4fv(phGetProjMatLoc(shaderProgramProc), 1, false, matEntries);
+    const unsigned int programs[] = { shaderProgramBitmap, shaderProgramProc, shaderProgramInstanced,
+        shaderProgramDrawData, shaderProgramObjectData, shaderProgramDepth, shaderProgramDepthInstanced,
+        shaderProgramDepthDrawData, shaderProgramDepthObjectData };
+    for (unsigned int program : programs) {
+        if (program != 0 && glIsProgram(program)) {
+            GlStateCache::UseProgram(program);
+            GlStateCache::UniformMatrix4fv(phGetProjMatLoc(program), matEntries);
+        }
     }
 
     check_for_opengl_errors();   // Really a great idea to check for errors -- esp. good for debugging!
@@ -417,16 +759,346 @@ void error_callback(int error, const char* description)
 void setup_callbacks(GLFWwindow* window) {
 	// Set callback function for resizing the window
 	glfwSetFramebufferSizeCallback(window, window_size_callback);
+	glfwSetWindowRefreshCallback(window, window_refresh_callback);
 
 	// Set callback for key up/down/repeat events
 	glfwSetKeyCallback(window, key_callback);
 
 	// Set callbacks for mouse movement (cursor position) and mouse botton up/down events.
 	// glfwSetCursorPosCallback(window, cursor_pos_callback);
-	// glfwSetMouseButtonCallback(window, mouse_button_callback);
+	glfwSetMouseButtonCallback(window, mouse_button_callback);
+}
+
+// Initialize GLEW for the current context, and print the OpenGL version.
+//   With an EGL context and no X display, GLEW (if built for GLX) reports
+//   GLEW_ERROR_NO_GLX_DISPLAY after loading the OpenGL functions: this is not an error.
+bool initializeGlew() {
+    GLenum glewStatus = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    if (glewStatus == GLEW_ERROR_NO_GLX_DISPLAY) {
+        glewStatus = GLEW_OK;
+    }
+#endif
+	if (GLEW_OK != glewStatus) {
+		printf("Failed to initialize GLEW!.\n");
+		return false;
+	}
+
+	// Print info of GPU and supported OpenGL version
+	printf("Renderer: %s\n", glGetString(GL_RENDERER));
+	printf("OpenGL version supported %s\n", glGetString(GL_VERSION));
+#ifdef GL_SHADING_LANGUAGE_VERSION
+	printf("Supported GLSL version is %s.\n", (char *)glGetString(GL_SHADING_LANGUAGE_VERSION));
+#endif
+    printf("Using GLEW version %s.\n", glewGetString(GLEW_VERSION));
+    GlDebugOutput::Initialize();            // OpenGL errors are reported by a callback, if possible
+    GlGpuProfiler::Initialize();            // Timer queries for the render passes
+    return true;
+}
+
+void printRunStatistics(const char* traceFilename) {
+    GlStateCache::PrintStatistics();      // How many redundant OpenGL state changes were skipped
+    GlGpuProfiler::PrintReport();         // GPU time of each render pass
+    frameTimes.Print("Frame times");
+    if (uniformRing.IsCreated()) {
+        printf("Uniform ring: %lld waits for the GPU, %lld allocations failed.\n",
+               uniformRing.NumFenceWaits(), uniformRing.NumAllocationFailures());
+    }
+    printOcclusionReport();
+    if (traceFilename != nullptr) {
+        CpuProfiler::DumpChromeTrace(traceFilename);
+    }
+}
+
+void printOcclusionReport() {
+    long long groupsHidden, groupsDrawn, numFrames;
+    MyGetOcclusionCounts(&groupsHidden, &groupsDrawn, &numFrames);
+    if (numFrames > 0) {
+        printf("Occlusion queries: %.1f crate groups hidden and %.1f drawn per frame, over %lld frames.\n",
+               (double)groupsHidden / numFrames, (double)groupsDrawn / numFrames, numFrames);
+    }
+    long long objectsOccluded, instancesOccluded;
+    MyGetSoftwareOcclusionCounts(&objectsOccluded, &instancesOccluded, &numFrames);
+    if (numFrames > 0) {
+        printf("Software occlusion: %.1f objects and %.1f instances culled per frame by %d occluder triangles, over %lld frames.\n",
+               (double)objectsOccluded / numFrames, (double)instancesOccluded / numFrames,
+               MyNumOccluderTriangles(), numFrames);
+    }
+    long long cellFrames, visibleObjects;
+    int numObjects;
+    MyGetPvsCounts(&cellFrames, &visibleObjects, &numObjects, &numFrames);
+    if (cellFrames > 0) {
+        printf("PVS: camera in a cell in %lld of %lld frames, with %.1f of %d objects potentially visible.\n",
+               cellFrames, numFrames, (double)visibleObjects / cellFrames, numObjects);
+    }
+    else if (numFrames > 0) {
+        printf("PVS: camera in no cell in %lld frames (everything drawn).\n", numFrames);
+    }
+    MyResetOcclusionCounts();
+}
+
+// Render the current view twice, without and with the depth pre-pass, counting
+//    the fragments that pass the depth test in the main passes (GL_SAMPLES_PASSED).
+void printDepthPrepassReport() {
+    if (!MyDepthPrepassAvailable()) {
+        printf("Depth pre-pass: the invariant shader programs are not available.\n");
+        return;
+    }
+    bool savedPrepass = depthPrepass;
+    long long shaded[2] = { 0, 0 };
+    long long depthOnly = 0;
+    MySetCountFragments(true);
+    for (int i = 0; i < 2; i++) {
+        depthPrepass = (i == 1);
+        myRenderScene();
+        MyGetFragmentCounts(&depthOnly, &shaded[i]);
+    }
+    MySetCountFragments(false);
+    depthPrepass = savedPrepass;
+    double saved = shaded[0] > 0 ? 100.0 * (double)(shaded[0] - shaded[1]) / (double)shaded[0] : 0.0;
+    printf("Depth pre-pass: %lld fragments shaded without it, %lld with it (%.1f%% fewer), plus %lld depth-only fragments.\n",
+           shaded[0], shaded[1], saved, depthOnly);
+}
+
+// *************************************************
+// Headless mode: no window and no GLFW.  The scene is set up exactly as in
+//    the windowed program, and numFrames frames are rendered into an offscreen
+//    framebuffer of the given size.  Each frame advances the animation by one
+//    fixed step.  The last frame can be saved as a bitmap, and all the frames
+//    can be captured to a video file.
+// *************************************************
+// Create the headless context and the offscreen target, and set up the scene.
+bool setupHeadless(HeadlessContext& context, GlOffscreenTarget& target, int width, int height) {
+    if (!context.Create() || !initializeGlew()) {
+        return false;
+    }
+    if (!target.Create(width, height)) {
+        return false;
+    }
+    target.Bind();
+
+    my_setup_OpenGL();
+    my_setup_SceneData();
+    window_size_callback(nullptr, width, height);
+    return true;
+}
+
+int runHeadless(int width, int height, int numFrames, const char* outputFilename, const char* traceFilename,
+                const char* videoFilename) {
+    long long startupBegin = CpuProfiler::NowMicroseconds();
+    HeadlessContext headlessContext;
+    GlOffscreenTarget offscreenTarget;
+    if (!setupHeadless(headlessContext, offscreenTarget, width, height)) {
+        return -1;
+    }
+    CpuProfiler::RecordZone("Startup", startupBegin, CpuProfiler::NowMicroseconds());
+    if (videoFilename != nullptr && !frameCapture.Start(videoFilename, width, height)) {
+        return -1;
+    }
+
+    for (int i = 0; i < numFrames; i++) {
+        CpuProfileZone frameZone("Frame");
+        long long frameBegin = CpuProfiler::NowMicroseconds();
+        myAdvanceAnimation();
+        animationAlpha = 1.0;           // Render the animation at exactly currentTime
+        myRenderScene();
+        frameCapture.CaptureFrame();
+        glFinish();                     // Wait for the frame, so its time is measured
+        frameTimes.AddSample(1.0e-6 * (CpuProfiler::NowMicroseconds() - frameBegin));
+        GlDebugOutput::ReportMessages();
+    }
+    printf("Headless: rendered %d frames at %d x %d.\n", numFrames, width, height);
+    frameCapture.Stop();
+
+    if (outputFilename != nullptr) {
+        RgbImage image;
+        if (image.LoadFromOpenglBuffer() && image.WriteBmpFile(outputFilename)) {
+            printf("Headless: last frame saved to %s.\n", outputFilename);
+        }
+        else {
+            printf("Headless: unable to save the last frame to %s.\n", outputFilename);
+        }
+    }
+
+    printRunStatistics(traceFilename);
+    return 0;
+}
+
+// Bake the potentially visible set of the map and save it.  The scene is set
+//    up headless (for its geometry), but nothing is rendered.
+int runPvsBake(const char* filename, int raysPerPair, const char* traceFilename) {
+    HeadlessContext headlessContext;
+    GlOffscreenTarget offscreenTarget;
+    if (!setupHeadless(headlessContext, offscreenTarget, 64, 64)) {
+        return -1;
+    }
+    bool ok = MyBakePvs(filename, raysPerPair);
+    if (traceFilename != nullptr) {
+        CpuProfiler::DumpChromeTrace(traceFilename);
+    }
+    return ok ? 0 : -1;
+}
+
+// Time the ray queries against the map (and check the packets against the single rays).
+//    The scene is set up headless for its geometry and the default view; nothing is rendered.
+int runRayBench(int numRays, const char* traceFilename) {
+    HeadlessContext headlessContext;
+    GlOffscreenTarget offscreenTarget;
+    if (!setupHeadless(headlessContext, offscreenTarget, 64, 32)) {
+        return -1;
+    }
+    bool ok = MyBenchRays(numRays);
+    if (traceFilename != nullptr) {
+        CpuProfiler::DumpChromeTrace(traceFilename);
+    }
+    return ok ? 0 : -1;
 }
 
-int main() {
+// Command line options:
+//   --trace [filename]   Save the CPU profile (startup and frames) at exit.  Default: cpu_trace.json
+//   --swap vsync|adaptive|unlimited    Frame pacing.  Default: vsync
+//   --headless WIDTHxHEIGHT   Render offscreen with no window (EGL), then exit.
+//   --frames N           Number of frames to render when headless.  Default: 1
+//   --output filename    Save the last headless frame as a bitmap (.bmp)
+//   --capture filename   Capture every frame to a video file (.y4m, or raw RGB for other extensions)
+//   --bench [N]          Run the benchmark headless, N frames per mesh resolution, then exit.
+//                        The size is from --headless.  Default: 1280x720, 300 frames
+//   --meshres 4,8,16,32  The mesh resolutions swept by the benchmark
+//   --bench-csv filename Save the benchmark results as CSV
+//   --golden directory   Compare fixed views with the golden bitmaps in the directory, then exit.
+//                        The size is from --headless.  Default: 640x480
+//   --golden-update directory   Save the fixed views as the golden bitmaps
+//   --tolerance N        Largest color difference (0-255) allowed in a pixel.  Default: 2
+//   --max-bad F          Fraction of pixels allowed over the tolerance.  Default: 0
+//   --budget MS          Also fail if the benchmark's p95 frame time is over MS milliseconds
+//   --threads N          Number of worker threads that build the draw packets.  Default: one less than the cores
+//   --no-cull            Draw every object, with no view frustum culling
+//   --prepass            Draw the depth first (depth pre-pass), then shade each pixel once
+//   --occlusion          Test the crates hidden by the walls with occlusion queries
+//   --soft-occlusion     Cull the objects hidden by the walls on the CPU (software occlusion culling)
+//   --bake-pvs filename  Bake the potentially visible set of the map into the file, then exit
+//   --pvs-rays N         Rays from each PVS cell to each object when baking.  Default: 2048
+//   --pvs filename       Load a baked potentially visible set, and cull by the camera's cell
+//   --bench-rays [N]     Time the ray queries against the map, N rays of each kind, then exit.  Default: 1048576
+int main(int argc, char* argv[]) {
+    const char* traceFilename = nullptr;
+    SwapMode initialSwapMode = SwapVsync;
+    int headlessWidth = 0, headlessHeight = 0;
+    int headlessFrames = 1;
+    const char* outputFilename = nullptr;
+    int benchFrames = 0;
+    const char* benchCsvFilename = nullptr;
+    const char* goldenDirectory = nullptr;
+    bool goldenUpdate = false;
+    double budgetMs = 0.0;
+    bool captureAtStart = false;
+    int numWorkers = -1;
+    const char* bakePvsFilename = nullptr;
+    int pvsRaysPerPair = MapPvs::DefaultRaysPerPair;
+    int benchRays = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--trace") == 0) {
+            traceFilename = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "cpu_trace.json";
+        }
+        else if (strcmp(argv[i], "--swap") == 0 && i + 1 < argc) {
+            i++;
+            initialSwapMode = strcmp(argv[i], "unlimited") == 0 ? SwapUnlimited
+                            : (strcmp(argv[i], "adaptive") == 0 ? SwapAdaptive : SwapVsync);
+        }
+        else if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc) {
+            i++;
+            if (sscanf(argv[i], "%dx%d", &headlessWidth, &headlessHeight) != 2 || headlessWidth <= 0 || headlessHeight <= 0) {
+                printf("Bad size %s for --headless (use, e.g., 1280x720).\n", argv[i]);
+                return -1;
+            }
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            headlessFrames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputFilename = argv[++i];
+        }
+        else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            captureFilename = argv[++i];
+            captureAtStart = true;
+        }
+        else if (strcmp(argv[i], "--bench") == 0) {
+            benchFrames = (i + 1 < argc && argv[i + 1][0] != '-') ? atoi(argv[++i]) : BenchRender::DefaultNumFrames;
+        }
+        else if (strcmp(argv[i], "--meshres") == 0 && i + 1 < argc) {
+            BenchRender::SetMeshResolutions(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--bench-csv") == 0 && i + 1 < argc) {
+            benchCsvFilename = argv[++i];
+        }
+        else if ((strcmp(argv[i], "--golden") == 0 || strcmp(argv[i], "--golden-update") == 0) && i + 1 < argc) {
+            goldenUpdate = strcmp(argv[i], "--golden-update") == 0;
+            goldenDirectory = argv[++i];
+        }
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            GoldenImageTest::SetTolerance(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--max-bad") == 0 && i + 1 < argc) {
+            GoldenImageTest::SetMaxBadFraction(atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            budgetMs = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            numWorkers = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--no-cull") == 0) {
+            frustumCulling = false;
+        }
+        else if (strcmp(argv[i], "--prepass") == 0) {
+            depthPrepass = true;
+        }
+        else if (strcmp(argv[i], "--occlusion") == 0) {
+            occlusionQueries = true;
+        }
+        else if (strcmp(argv[i], "--soft-occlusion") == 0) {
+            softwareOcclusion = true;
+        }
+        else if (strcmp(argv[i], "--bake-pvs") == 0 && i + 1 < argc) {
+            bakePvsFilename = argv[++i];
+        }
+        else if (strcmp(argv[i], "--pvs-rays") == 0 && i + 1 < argc) {
+            pvsRaysPerPair = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--pvs") == 0 && i + 1 < argc) {
+            pvsFilename = argv[++i];
+            pvsCulling = true;
+        }
+        else if (strcmp(argv[i], "--bench-rays") == 0) {
+            benchRays = (i + 1 < argc && argv[i + 1][0] != '-') ? atoi(argv[++i]) : 1 << 20;
+        }
+        else {
+            printf("Unknown option %s.\n", argv[i]);
+        }
+    }
+    CpuProfiler::SetThreadName("Main");
+    WorkerPool::Start(numWorkers);
+    if (bakePvsFilename != nullptr) {
+        return runPvsBake(bakePvsFilename, pvsRaysPerPair, traceFilename);
+    }
+    if (benchRays > 0) {
+        return runRayBench(benchRays, traceFilename);
+    }
+    if (goldenDirectory != nullptr) {
+        return runGoldenTests(headlessWidth > 0 ? headlessWidth : 640, headlessWidth > 0 ? headlessHeight : 480,
+                              goldenDirectory, goldenUpdate, budgetMs,
+                              benchFrames > 0 ? benchFrames : GoldenImageTest::DefaultBudgetFrames, traceFilename);
+    }
+    if (benchFrames > 0) {
+        return runBenchmark(headlessWidth > 0 ? headlessWidth : 1280, headlessWidth > 0 ? headlessHeight : 720,
+                            benchFrames, benchCsvFilename, traceFilename);
+    }
+    if (headlessWidth > 0) {
+        return runHeadless(headlessWidth, headlessHeight, headlessFrames, outputFilename, traceFilename,
+                           captureAtStart ? captureFilename : nullptr);
+    }
+    long long startupBegin = CpuProfiler::NowMicroseconds();
+
 	glfwSetErrorCallback(error_callback);	// Supposed to be called in event of errors. (doesn't work?)
 	glfwInit();
 #if defined(__APPLE__) || defined(__linux__)
@@ -435,6 +1107,7 @@ int main() {
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+    GlDebugOutput::SetWindowHints();        // Debug context, unless GL_DEBUG_CHECKS is off
 
 	GLFWwindow* window = glfwCreateWindow(screenWidth, screenHeight, "Project 6 (student)", NULL, NULL);
 	if (window == NULL) {
@@ -443,19 +1116,10 @@ int main() {
 	}
 	glfwMakeContextCurrent(window);
 
-	if (GLEW_OK != glewInit()) {
-		printf("Failed to initialize GLEW!.\n");
+	if (!initializeGlew()) {
 		return -1;
 	}
 
-	// Print info of GPU and supported OpenGL version
-	printf("Renderer: %s\n", glGetString(GL_RENDERER));
-	printf("OpenGL version supported %s\n", glGetString(GL_VERSION));
-#ifdef GL_SHADING_LANGUAGE_VERSION
-	printf("Supported GLSL version is %s.\n", (char *)glGetString(GL_SHADING_LANGUAGE_VERSION));
-#endif
-    printf("Using GLEW version %s.\n", glewGetString(GLEW_VERSION));
-
 	printf("------------------------------\n");
 	printf("Press 'r' or 'R' (Run) to toggle(off and on) running the animation.\n");
     printf("Press arrow keys to adjust the view direction.\n");
@@ -469,6 +1133,14 @@ int main() {
     printf("Press 'S' key (Specular) to toggle rendering Specular light.\n");
     printf("Press 'V' key (Viewer) to toggle using a local viewer.\n");
     printf("Press 'Q' key to toggle viewing all the objects besides the floor.\n");
+    printf("Press 'K' key to cycle through larger fields of crates (a stress test).\n");
+    printf("Press 'G' key (GPU) to print and save the GPU time of each render pass.\n");
+    printf("Press 'T' key (Trace) to save the CPU profile to cpu_trace.json.\n");
+    printf("Press 'Y' key to cycle the frame pacing: vsync, adaptive vsync, unlimited.\n");
+    printf("Press 'H' key (Histogram) to print the histogram of frame times.\n");
+    printf("Press 'O' key to toggle rendering on demand (idle when nothing changes).\n");
+    printf("Press 'P' key to start or stop capturing video to %s.\n", captureFilename);
+    printf("Click the left mouse button to print the object under the cursor.\n");
     printf("Press ESCAPE to exit.\n");
 	
     setup_callbacks(window);
@@ -477,19 +1149,61 @@ int main() {
     my_setup_OpenGL();
 	my_setup_SceneData();
  	window_size_callback(window, screenWidth, screenHeight);
+    setSwapMode(initialSwapMode);
+    if (captureAtStart) {
+        frameCapture.Start(captureFilename, screenWidth, screenHeight);
+    }
+    CpuProfiler::RecordZone("Startup", startupBegin, CpuProfiler::NowMicroseconds());
 
     // Loop while program is not terminated.
+    //   The simulation runs in fixed steps of simStepSeconds, as many as have come due;
+    //   the frame is rendered between the last two steps.  The pacing comes from
+    //   the buffer swap (see setSwapMode).
+    //   When rendering on demand and nothing is dirty, the loop sleeps until an event arrives.
+    double lastFrameTime = glfwGetTime();
+    double accumulator = 0.0;       // Real time not yet simulated
+    bool wasIdle = false;
 	while (!glfwWindowShouldClose(window)) {
+        if (renderOnDemand && !frameDirty && !spinMode) {
+            glfwWaitEvents();       // Uses no CPU until a key press, resize, etc.
+            wasIdle = true;
+            continue;
+        }
+        CpuProfileZone frameZone("Frame");
+
+        double now = glfwGetTime();
+        double frameSeconds = now - lastFrameTime;
+        lastFrameTime = now;
+        if (wasIdle) {
+            frameSeconds = 0.0;     // The time spent idle is not a frame, and is not simulated
+            wasIdle = false;
+        }
+        else {
+            frameTimes.AddSample(frameSeconds);
+        }
+        accumulator += frameSeconds < maxFrameSeconds ? frameSeconds : maxFrameSeconds;
+        while (accumulator >= simStepSeconds) {
+            myAdvanceAnimation();
+            accumulator -= simStepSeconds;
+        }
+        animationAlpha = accumulator / simStepSeconds;
 	
 		myRenderScene();				// Render into the current buffer
-		glfwSwapBuffers(window);		// Displays what was just rendered (using double buffering).
+        frameCapture.CaptureFrame();        // Does nothing unless capturing
+        frameDirty = false;
+        {
+            CpuProfileZone swapZone("glfwSwapBuffers");
+		    glfwSwapBuffers(window);		// Displays what was just rendered (using double buffering).
+        }
+        GlDebugOutput::ReportMessages();    // Print any OpenGL errors collected during the frame
 
 		// Poll events (key presses, mouse events)
-		glfwWaitEventsTimeout(1.0/60.0);	    // Use this to animate at 60 frames/sec (timing is NOT reliable)
-		// glfwWaitEvents();					// Or, Use this instead if no animation.
-		// glfwPollEvents();					// Use this version when animating as fast as possible
+		glfwPollEvents();
 	}
 
+    frameCapture.Stop();
+    printRunStatistics(traceFilename);
+
 	glfwTerminate();
 	return 0;
 }
@@ -498,12 +1212,17 @@ int main() {
 //   previous call to check_for_opengl_errors()
 // To find what generated the error, you can try adding more calls to
 //   check_for_opengl_errors().
+// When the KHR_debug callback is installed (see GlDebugOutput.h), this only
+//   prints the messages collected by the callback.
 char errNames[8][36] = {
 	"Unknown OpenGL error",
 	"GL_INVALID_ENUM", "GL_INVALID_VALUE", "GL_INVALID_OPERATION",
 	"GL_INVALID_FRAMEBUFFER_OPERATION", "GL_OUT_OF_MEMORY",
 	"GL_STACK_UNDERFLOW", "GL_STACK_OVERFLOW" };
 bool check_for_opengl_errors() {
+    if (GlDebugOutput::IsActive()) {
+        return GlDebugOutput::ReportMessages() != 0;   // Errors come from the callback: no glGetError
+    }
 	int numErrors = 0;
 	GLenum err;
 	while ((err = glGetError()) != GL_NO_ERROR) {
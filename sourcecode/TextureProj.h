@@ -12,6 +12,8 @@
 #include <GLFW/glfw3.h>
 
 class LinearMapR4;      // Used in the function prototypes, declared in LinearMapR4.h
+class HeadlessContext;
+class GlOffscreenTarget;
 
 //
 // External variables.  Can be be used by other .cpp files.
@@ -25,6 +27,21 @@ extern bool spinMode;
 // Controls whether to render only the floor (and no other geometries)
 extern bool renderFloorOnly;
 
+// Controls whether objects outside the view frustum are skipped (--no-cull turns it off)
+extern bool frustumCulling;
+
+// Controls the depth pre-pass: the depth is drawn first, then each pixel is shaded once (GL_EQUAL)
+extern bool depthPrepass;
+
+// Controls the occlusion queries: the crates hidden by the walls are tested with their bounding boxes
+extern bool occlusionQueries;
+
+// Controls software occlusion culling: the walls are rasterized on the CPU, and the objects behind them are culled
+extern bool softwareOcclusion;
+
+// Controls culling by the potentially visible set of the camera's cell (--pvs loads one, --bake-pvs bakes one)
+extern bool pvsCulling;
+
 // The next variable controls the resoluton of the meshes for cylinders and spheres.
 extern int meshRes;             // Resolution of the meshes (slices, stacks, and rings all equal)
 
@@ -34,7 +51,20 @@ extern double animateIncrement;   // Make bigger to speed up animation, smaller
 extern double currentTime;         // Current "time" for the animation.
 extern double currentDelta;        // Current state of the animation (YOUR CODE MAY NOT WANT TO USE THIS.)
 
+// Render on demand: when on, a frame is rendered only when something marked it dirty.
+extern bool renderOnDemand;
+
+// Frame pacing: how the buffer swap waits for the display.
+enum SwapMode { SwapVsync, SwapAdaptive, SwapUnlimited, NumSwapModes };
+extern SwapMode swapMode;
+
+// The view: set by the arrow keys and HOME/END.  Call mySetViewMatrix() after changing them.
+extern double viewAzimuth;          // Angle of view up/down (in radians)
+extern double viewDirection;        // Rotation of view around y-axis (in radians)
+extern double ZextraDistance;       // Extra distance we have moved to/from the scene
+
 extern LinearMapR4 viewMatrix;		// The current view matrix, based on viewAzimuth and viewDirection.
+extern LinearMapR4 theProjectionMatrix;		// The projection matrix, set by setProjectionMatrix()
 // Comment: This viewMatrix changes only when the view changes.
 // The modelViewMatrix is updated to render objects in the desired position and orientation.
 // The modelViewMatrix must incorporate the viewMatrix: the shaders do NOT use the viewMatrix.
@@ -42,12 +72,26 @@ extern LinearMapR4 viewMatrix;		// The current view matrix, based on viewAzimuth
 // Global variables that let program access the shader programs:
 extern unsigned int shaderProgramBitmap;     // The shader program that applies a bitmapped texture map (from a file)
 extern unsigned int shaderProgramProc;       // The shader program that applies a procedural texture map
+extern unsigned int shaderProgramInstanced;  // Instanced version of shaderProgramBitmap (0 if not available)
+extern unsigned int shaderProgramDrawData;   // shaderProgramBitmap with the modelview matrix in a uniform block (0 if not available)
+extern unsigned int shaderProgramObjectData; // shaderProgramBitmap with the object records indexed by draw ID (0 if not available)
+
+// Depth-only shader programs for the depth pre-pass, one for each of the programs above (0 if not available)
+extern unsigned int shaderProgramDepth;             // For shaderProgramBitmap
+extern unsigned int shaderProgramDepthInstanced;    // For shaderProgramInstanced
+extern unsigned int shaderProgramDepthDrawData;     // For shaderProgramDrawData
+extern unsigned int shaderProgramDepthObjectData;   // For shaderProgramObjectData
+
+// The per-frame and per-draw uniform data (lights and modelview matrices) is written into this ring.
+class GlUniformRing;
+extern GlUniformRing uniformRing;
 extern unsigned int modelviewMatLocation;
 extern unsigned int applyTextureLocation;
 
 constexpr unsigned int vertPos_loc = 0;         // "location = 0" in the vertex shader definition
 constexpr unsigned int vertNormal_loc = 1;      // "location = 1" in the vertex shader definition
 constexpr unsigned int vertTexCoords_loc = 2;   // "location = 2" in the vertex shader definition
+constexpr unsigned int instanceMatrix_loc = 9;  // "location = 9" (through 12) in the instanced vertex shader
 
 
 
@@ -59,8 +103,14 @@ bool check_for_opengl_errors();
 
 void mySetupGeometries();
 void mySetViewMatrix();  
+void mySetView(double azimuth, double direction, double extraDistance);    // Set the view and everything that depends on it
 
 void myRenderScene();
+void myAdvanceAnimation();              // One fixed simulation step
+double myAnimationTimeForRender();      // currentTime interpolated between the last two steps
+void mySetAnimationTime(double time);   // Jump to the given time, with no interpolation
+void setSwapMode(SwapMode mode);
+void markFrameDirty();                  // Something visible changed: render another frame
 
 void my_setup_SceneData();
 void my_setup_OpenGL();
@@ -69,6 +119,18 @@ void setProjectionMatrix();
 void selectShaderProgram(unsigned int shaderProgram);
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
 void window_size_callback(GLFWwindow* window, int width, int height);
+void window_refresh_callback(GLFWwindow* window);
 void error_callback(int error, const char* description);
 void setup_callbacks(GLFWwindow* window);
+
+bool initializeGlew();
+void printRunStatistics(const char* traceFilename);
+void printDepthPrepassReport();         // Renders the view with and without the depth pre-pass, and prints the fragments shaded
+void printOcclusionReport();            // Prints the occlusion culling counts per frame, and starts counting again
+bool setupHeadless(HeadlessContext& context, GlOffscreenTarget& target, int width, int height);
+int runHeadless(int width, int height, int numFrames, const char* outputFilename, const char* traceFilename,
+                const char* videoFilename = nullptr);
+int runPvsBake(const char* filename, int raysPerPair, const char* traceFilename);
+int runRayBench(int numRays, const char* traceFilename);
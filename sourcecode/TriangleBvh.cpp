@@ -0,0 +1,718 @@
+//
+// TriangleBvh.cpp
+//
+//   A bounding volume hierarchy over static triangles, built with the
+//   surface area heuristic, and ray queries one ray or one packet at a time.
+//   See TriangleBvh.h.
+//
+
+#include "TriangleBvh.h"
+#include "GlStaticGeometry.h"
+#include "GlGeomBase.h"
+#include "LinearR4.h"
+#include "WorkerPool.h"
+#include "CpuProfiler.h"
+#include <math.h>
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define TRIANGLE_BVH_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace {
+    const float TraversalCost = 1.0f;       // The SAH cost of visiting a node, relative to testing one triangle
+    const int PacketsPerChunk = 64;         // Packets per task in IntersectRays and OccludedRays
+    const float BoxPadding = 1.0e-5f;       // Relative to the largest side of the box
+
+    float BoxArea(const float* boxMin, const float* boxMax) {
+        float dx = boxMax[0] - boxMin[0];
+        float dy = boxMax[1] - boxMin[1];
+        float dz = boxMax[2] - boxMin[2];
+        return dx * dy + dy * dz + dz * dx;         // Half the surface area is enough for the SAH
+    }
+
+    // 1/d, with d == 0 treated as a very small d (so box tests never compute 0 * infinity)
+    float SafeInverse(float d) {
+        return 1.0f / (d != 0.0f ? d : 1.0e-30f);
+    }
+
+    // Clear hit, for rays that miss
+    void ClearHit(BvhHit* hit) {
+        hit->t = 0.0f;
+        hit->u = hit->v = 0.0f;
+        hit->triangle = -1;
+        hit->object = -1;
+    }
+}
+
+// **********************************************
+// Adding the triangles
+// **********************************************
+void TriangleBvh::Clear()
+{
+    nodes.clear();
+    leafTriangles.clear();
+    triangleVerts.clear();
+    triangleObjects.clear();
+    numObjects = 0;
+    depth = 0;
+}
+
+void TriangleBvh::AddTriangles(const float* positions, int stride, const unsigned int* elements, int numElements,
+                               const LinearMapR4* m)
+{
+    for (int i = 0; i + 2 < numElements; i += 3) {
+        for (int j = 0; j < 3; j++) {
+            const float* pos = positions + (size_t)elements[i + j] * stride;
+            if (m == nullptr) {
+                triangleVerts.insert(triangleVerts.end(), pos, pos + 3);
+            }
+            else {
+                triangleVerts.push_back((float)(m->m11 * pos[0] + m->m12 * pos[1] + m->m13 * pos[2] + m->m14));
+                triangleVerts.push_back((float)(m->m21 * pos[0] + m->m22 * pos[1] + m->m23 * pos[2] + m->m24));
+                triangleVerts.push_back((float)(m->m31 * pos[0] + m->m32 * pos[1] + m->m33 * pos[2] + m->m34));
+            }
+        }
+        triangleObjects.push_back(numObjects);
+    }
+}
+
+int TriangleBvh::AddMesh(const GlStaticGeometry& geometry, int mesh, const LinearMapR4* modelMatrix)
+{
+    const GlMeshRange& range = geometry.GetMesh(mesh);
+    const float* positions = &geometry.GetVertexData()[(size_t)range.baseVertex * GlStaticGeometry::FloatsPerVertex];
+    AddTriangles(positions, GlStaticGeometry::FloatsPerVertex, &geometry.GetElementData()[range.firstIndex],
+                 range.numIndices, modelMatrix);
+    return numObjects++;
+}
+
+int TriangleBvh::AddShape(GlGeomBase& shape, const LinearMapR4* modelMatrix)
+{
+    // Positions only, tightly packed
+    std::vector<float> positions((size_t)3 * shape.GetNumVerticesNoTexCoords());
+    std::vector<unsigned int> elements(shape.GetNumElementsMax());
+    shape.CalcVboAndEbo(positions.data(), elements.data(), 0, -1, -1, 3);
+    AddTriangles(positions.data(), 3, elements.data(), shape.GetNumElementsRender(), modelMatrix);
+    return numObjects++;
+}
+
+// **********************************************
+// Build the tree top down.  Each node's triangles are split by binning their
+//    centroids along each axis and taking the split with the least SAH cost;
+//    a node becomes a leaf when no split is cheaper than testing its triangles.
+// **********************************************
+void TriangleBvh::Build()
+{
+    CpuProfileZone zone("TriangleBvh::Build");
+    int numTriangles = GetNumTriangles();
+    nodes.clear();
+    leafTriangles.clear();
+    depth = 0;
+    if (numTriangles == 0) {
+        return;
+    }
+    buildTriangles.resize(numTriangles);
+    for (int t = 0; t < numTriangles; t++) {
+        const float* v = &triangleVerts[(size_t)9 * t];
+        BuildTriangle& bt = buildTriangles[t];
+        for (int k = 0; k < 3; k++) {
+            bt.boxMin[k] = std::min(v[k], std::min(v[3 + k], v[6 + k]));
+            bt.boxMax[k] = std::max(v[k], std::max(v[3 + k], v[6 + k]));
+            bt.centroid[k] = 0.5f * (bt.boxMin[k] + bt.boxMax[k]);
+        }
+        bt.triangle = t;
+    }
+    nodes.reserve(2 * (size_t)numTriangles);
+    leafTriangles.reserve(numTriangles);
+    nodes.emplace_back();
+    BuildNode(0, 0, numTriangles, 1);
+    buildTriangles.clear();
+    buildTriangles.shrink_to_fit();
+}
+
+void TriangleBvh::BuildNode(int nodeIndex, int first, int count, int level)
+{
+    depth = std::max(depth, level);
+    float boxMin[3], boxMax[3], centroidMin[3], centroidMax[3];
+    for (int k = 0; k < 3; k++) {
+        boxMin[k] = centroidMin[k] = 1.0e30f;
+        boxMax[k] = centroidMax[k] = -1.0e30f;
+    }
+    for (int i = first; i < first + count; i++) {
+        const BuildTriangle& bt = buildTriangles[i];
+        for (int k = 0; k < 3; k++) {
+            boxMin[k] = std::min(boxMin[k], bt.boxMin[k]);
+            boxMax[k] = std::max(boxMax[k], bt.boxMax[k]);
+            centroidMin[k] = std::min(centroidMin[k], bt.centroid[k]);
+            centroidMax[k] = std::max(centroidMax[k], bt.centroid[k]);
+        }
+    }
+    // The node's box is padded a little, so that rounding in the ray tests
+    //    cannot miss a flat box (e.g., around a wall or the floor).
+    Node& node = nodes[nodeIndex];
+    float pad = BoxPadding * std::max(boxMax[0] - boxMin[0], std::max(boxMax[1] - boxMin[1], boxMax[2] - boxMin[2]));
+    for (int k = 0; k < 3; k++) {
+        node.boxMin[k] = boxMin[k] - pad;
+        node.boxMax[k] = boxMax[k] + pad;
+    }
+
+    int axis = 0;
+    int splitBin = 0;
+    bool split = level < MaxStackDepth - 1         // Keeps the traversal stacks from overflowing
+        && FindSplit(first, count, boxMin, boxMax, centroidMin, centroidMax, &axis, &splitBin);
+    if (!split) {
+        node.first = (int)leafTriangles.size();
+        node.count = count;
+        for (int i = first; i < first + count; i++) {
+            const float* v = &triangleVerts[(size_t)9 * buildTriangles[i].triangle];
+            LeafTriangle lt;
+            for (int k = 0; k < 3; k++) {
+                lt.v0[k] = v[k];
+                lt.edge1[k] = v[3 + k] - v[k];
+                lt.edge2[k] = v[6 + k] - v[k];
+            }
+            lt.triangle = buildTriangles[i].triangle;
+            leafTriangles.push_back(lt);
+        }
+        return;
+    }
+
+    // The triangles in bins below splitBin go to the first child
+    float binScale = NumBins * 0.99999f / (centroidMax[axis] - centroidMin[axis]);
+    BuildTriangle* mid = std::partition(&buildTriangles[first], &buildTriangles[first] + count,
+        [&](const BuildTriangle& bt) {
+            return (int)((bt.centroid[axis] - centroidMin[axis]) * binScale) < splitBin;
+        });
+    int leftCount = (int)(mid - &buildTriangles[first]);
+    node.count = -1 - axis;
+
+    int leftIndex = (int)nodes.size();          // The first child follows its parent
+    nodes.emplace_back();
+    BuildNode(leftIndex, first, leftCount, level + 1);
+    int rightIndex = (int)nodes.size();
+    nodes.emplace_back();
+    nodes[nodeIndex].first = rightIndex;        // (Not node: emplace_back may have moved it)
+    BuildNode(rightIndex, first + leftCount, count - leftCount, level + 1);
+}
+
+// Find the cheapest split of the triangles first through first+count-1 between two bins.
+//    Returns false if a leaf is cheaper (and the leaf is not too large), or if the centroids all coincide.
+bool TriangleBvh::FindSplit(int first, int count, const float boxMin[3], const float boxMax[3],
+                            const float centroidMin[3], const float centroidMax[3], int* axis, int* splitBin)
+{
+    float bestCost = (float)count;          // The cost of a leaf
+    if (count > MaxLeafTriangles) {
+        bestCost = 1.0e30f;
+    }
+    float parentArea = BoxArea(boxMin, boxMax);
+    bool found = false;
+    for (int k = 0; k < 3; k++) {
+        float extent = centroidMax[k] - centroidMin[k];
+        if (extent <= 0.0f) {
+            continue;
+        }
+        float binScale = NumBins * 0.99999f / extent;
+        int binCount[NumBins];
+        float binMin[NumBins][3], binMax[NumBins][3];
+        for (int b = 0; b < NumBins; b++) {
+            binCount[b] = 0;
+            for (int j = 0; j < 3; j++) {
+                binMin[b][j] = 1.0e30f;
+                binMax[b][j] = -1.0e30f;
+            }
+        }
+        for (int i = first; i < first + count; i++) {
+            const BuildTriangle& bt = buildTriangles[i];
+            int b = (int)((bt.centroid[k] - centroidMin[k]) * binScale);
+            binCount[b]++;
+            for (int j = 0; j < 3; j++) {
+                binMin[b][j] = std::min(binMin[b][j], bt.boxMin[j]);
+                binMax[b][j] = std::max(binMax[b][j], bt.boxMax[j]);
+            }
+        }
+        // Sweep from the right to get the cost of everything above each split,
+        //    then from the left.  Split s puts bins 0 through s-1 on the left.
+        float rightCost[NumBins];
+        float sweepMin[3] = { 1.0e30f, 1.0e30f, 1.0e30f };
+        float sweepMax[3] = { -1.0e30f, -1.0e30f, -1.0e30f };
+        int sweepCount = 0;
+        for (int b = NumBins - 1; b > 0; b--) {
+            sweepCount += binCount[b];
+            for (int j = 0; j < 3; j++) {
+                sweepMin[j] = std::min(sweepMin[j], binMin[b][j]);
+                sweepMax[j] = std::max(sweepMax[j], binMax[b][j]);
+            }
+            rightCost[b] = sweepCount > 0 ? sweepCount * BoxArea(sweepMin, sweepMax) : -1.0f;
+        }
+        for (int j = 0; j < 3; j++) {
+            sweepMin[j] = 1.0e30f;
+            sweepMax[j] = -1.0e30f;
+        }
+        sweepCount = 0;
+        for (int s = 1; s < NumBins; s++) {
+            sweepCount += binCount[s - 1];
+            for (int j = 0; j < 3; j++) {
+                sweepMin[j] = std::min(sweepMin[j], binMin[s - 1][j]);
+                sweepMax[j] = std::max(sweepMax[j], binMax[s - 1][j]);
+            }
+            if (sweepCount == 0 || rightCost[s] < 0.0f) {
+                continue;           // One side would be empty
+            }
+            float cost = TraversalCost + (sweepCount * BoxArea(sweepMin, sweepMax) + rightCost[s]) / parentArea;
+            if (cost < bestCost) {
+                bestCost = cost;
+                *axis = k;
+                *splitBin = s;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+// **********************************************
+// One ray: depth first.  Both children's boxes are tested at their parent;
+//    the nearer child is entered first, and the other is skipped later if
+//    the closest hit so far is before it.
+// **********************************************
+namespace {
+    struct ScalarRay {
+        float origin[3];
+        float direction[3];
+        float invDirection[3];
+        float tBest;
+        bool frontFacesOnly;
+    };
+
+    void SetupScalarRay(const BvhRay& ray, bool frontFacesOnly, ScalarRay* r) {
+        for (int k = 0; k < 3; k++) {
+            r->origin[k] = ray.origin[k];
+            r->direction[k] = ray.direction[k];
+            r->invDirection[k] = SafeInverse(ray.direction[k]);
+        }
+        r->tBest = ray.tMax;
+        r->frontFacesOnly = frontFacesOnly;
+    }
+}
+
+// Does the ray enter the box before tBest?  If so, *entry is where it enters (or 0 if it starts inside).
+static inline bool RayEntersBox(const ScalarRay& r, const float* boxMin, const float* boxMax, float* entry)
+{
+    float tNear = 0.0f;
+    float tFar = r.tBest;
+    for (int k = 0; k < 3; k++) {
+        float t0 = (boxMin[k] - r.origin[k]) * r.invDirection[k];
+        float t1 = (boxMax[k] - r.origin[k]) * r.invDirection[k];
+        tNear = std::max(tNear, std::min(t0, t1));
+        tFar = std::min(tFar, std::max(t0, t1));
+    }
+    *entry = tNear;
+    return tNear <= tFar;
+}
+
+// Moller-Trumbore, from either side (or only from the front: a positive determinant).
+//    Sets *t, *u, *v if the ray hits at 0 < t <= tBest.
+//    The tests are written so that a degenerate triangle (NaN) is a miss.
+static inline bool RayHitsTriangle(const ScalarRay& r, const float* v0, const float* edge1, const float* edge2,
+                                   float* t, float* u, float* v)
+{
+    const float* d = r.direction;
+    float p[3] = { d[1] * edge2[2] - d[2] * edge2[1], d[2] * edge2[0] - d[0] * edge2[2], d[0] * edge2[1] - d[1] * edge2[0] };
+    float det = edge1[0] * p[0] + edge1[1] * p[1] + edge1[2] * p[2];
+    if (r.frontFacesOnly && !(det > 0.0f)) {
+        return false;
+    }
+    float invDet = 1.0f / det;
+    float s[3] = { r.origin[0] - v0[0], r.origin[1] - v0[1], r.origin[2] - v0[2] };
+    float uu = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+    if (!(uu >= 0.0f)) {
+        return false;
+    }
+    float q[3] = { s[1] * edge1[2] - s[2] * edge1[1], s[2] * edge1[0] - s[0] * edge1[2], s[0] * edge1[1] - s[1] * edge1[0] };
+    float vv = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * invDet;
+    if (!(vv >= 0.0f && uu + vv <= 1.0f)) {
+        return false;
+    }
+    float tt = (edge2[0] * q[0] + edge2[1] * q[1] + edge2[2] * q[2]) * invDet;
+    if (!(tt > 0.0f && tt <= r.tBest)) {
+        return false;
+    }
+    *t = tt;
+    *u = uu;
+    *v = vv;
+    return true;
+}
+
+bool TriangleBvh::Intersect(const BvhRay& ray, BvhHit* hit) const
+{
+    ClearHit(hit);
+    ScalarRay r;
+    SetupScalarRay(ray, frontFacesOnly, &r);
+    float entry;
+    if (nodes.empty() || !RayEntersBox(r, nodes[0].boxMin, nodes[0].boxMax, &entry)) {
+        return false;
+    }
+    struct StackEntry {
+        int node;
+        float entry;
+    };
+    StackEntry stack[MaxStackDepth];
+    int stackSize = 0;
+    int nodeIndex = 0;
+    while (true) {
+        const Node& node = nodes[nodeIndex];
+        if (node.count < 0) {
+            int nearChild = nodeIndex + 1;
+            int farChild = node.first;
+            float nearEntry, farEntry;
+            bool hitNear = RayEntersBox(r, nodes[nearChild].boxMin, nodes[nearChild].boxMax, &nearEntry);
+            bool hitFar = RayEntersBox(r, nodes[farChild].boxMin, nodes[farChild].boxMax, &farEntry);
+            if (hitNear && hitFar) {
+                if (farEntry < nearEntry) {
+                    std::swap(nearChild, farChild);
+                    std::swap(nearEntry, farEntry);
+                }
+                stack[stackSize++] = { farChild, farEntry };
+                nodeIndex = nearChild;
+                continue;
+            }
+            if (hitNear || hitFar) {
+                nodeIndex = hitNear ? nearChild : farChild;
+                continue;
+            }
+        }
+        else {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                const LeafTriangle& lt = leafTriangles[i];
+                if (RayHitsTriangle(r, lt.v0, lt.edge1, lt.edge2, &hit->t, &hit->u, &hit->v)) {
+                    r.tBest = hit->t;
+                    hit->triangle = lt.triangle;
+                }
+            }
+        }
+        // The next node that the ray enters before its closest hit so far
+        nodeIndex = -1;
+        while (stackSize > 0) {
+            const StackEntry& next = stack[--stackSize];
+            if (next.entry <= r.tBest) {
+                nodeIndex = next.node;
+                break;
+            }
+        }
+        if (nodeIndex < 0) {
+            break;
+        }
+    }
+    if (hit->triangle < 0) {
+        return false;
+    }
+    hit->object = triangleObjects[hit->triangle];
+    return true;
+}
+
+bool TriangleBvh::Occluded(const BvhRay& ray) const
+{
+    ScalarRay r;
+    SetupScalarRay(ray, frontFacesOnly, &r);
+    float entry;
+    if (nodes.empty() || !RayEntersBox(r, nodes[0].boxMin, nodes[0].boxMax, &entry)) {
+        return false;
+    }
+    int stack[MaxStackDepth];
+    int stackSize = 0;
+    int nodeIndex = 0;
+    while (true) {
+        const Node& node = nodes[nodeIndex];
+        if (node.count < 0) {
+            float firstEntry, secondEntry;
+            bool hitFirst = RayEntersBox(r, nodes[nodeIndex + 1].boxMin, nodes[nodeIndex + 1].boxMax, &firstEntry);
+            bool hitSecond = RayEntersBox(r, nodes[node.first].boxMin, nodes[node.first].boxMax, &secondEntry);
+            if (hitFirst && hitSecond) {
+                stack[stackSize++] = node.first;
+            }
+            if (hitFirst || hitSecond) {
+                nodeIndex = hitFirst ? nodeIndex + 1 : node.first;
+                continue;
+            }
+        }
+        else {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                const LeafTriangle& lt = leafTriangles[i];
+                float t, u, v;
+                if (RayHitsTriangle(r, lt.v0, lt.edge1, lt.edge2, &t, &u, &v)) {
+                    return true;
+                }
+            }
+        }
+        if (stackSize == 0) {
+            break;
+        }
+        nodeIndex = stack[--stackSize];
+    }
+    return false;
+}
+
+// **********************************************
+// Packets: four rays in the SSE lanes.  A node is entered if any active ray
+//    hits its box, in the order that is nearer for the packet's first ray.
+//    Lanes without a ray (and, for Occluded, rays already blocked) have
+//    tBest = -1, so they hit no box and no triangle.
+// **********************************************
+#ifdef TRIANGLE_BVH_USE_SSE
+
+namespace {
+    struct RayPacket {
+        __m128 origin[3];
+        __m128 direction[3];
+        __m128 invDirection[3];
+        __m128 tBest;
+        bool frontFacesOnly;
+    };
+
+    void SetupPacket(const BvhRay* rays, int numRays, bool frontFacesOnly, RayPacket* packet) {
+        alignas(16) float lanes[10][4];
+        for (int lane = 0; lane < 4; lane++) {
+            const BvhRay& ray = rays[lane < numRays ? lane : 0];
+            for (int k = 0; k < 3; k++) {
+                lanes[k][lane] = ray.origin[k];
+                lanes[3 + k][lane] = ray.direction[k];
+                lanes[6 + k][lane] = SafeInverse(ray.direction[k]);
+            }
+            lanes[9][lane] = lane < numRays ? ray.tMax : -1.0f;
+        }
+        for (int k = 0; k < 3; k++) {
+            packet->origin[k] = _mm_load_ps(lanes[k]);
+            packet->direction[k] = _mm_load_ps(lanes[3 + k]);
+            packet->invDirection[k] = _mm_load_ps(lanes[6 + k]);
+        }
+        packet->tBest = _mm_load_ps(lanes[9]);
+        packet->frontFacesOnly = frontFacesOnly;
+    }
+
+    // The lanes whose rays hit the box before their tBest
+    inline int PacketHitsBox(const RayPacket& p, const float* boxMin, const float* boxMax) {
+        __m128 tNear = _mm_setzero_ps();
+        __m128 tFar = p.tBest;
+        for (int k = 0; k < 3; k++) {
+            __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(boxMin[k]), p.origin[k]), p.invDirection[k]);
+            __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(boxMax[k]), p.origin[k]), p.invDirection[k]);
+            tNear = _mm_max_ps(tNear, _mm_min_ps(t0, t1));
+            tFar = _mm_min_ps(tFar, _mm_max_ps(t0, t1));
+        }
+        return _mm_movemask_ps(_mm_cmple_ps(tNear, tFar));
+    }
+
+    // The same test as RayHitsTriangle, for the four lanes.  Returns the lanes that hit.
+    inline int PacketHitsTriangle(const RayPacket& r, const float* v0, const float* edge1, const float* edge2,
+                                  __m128* t, __m128* u, __m128* v) {
+        const __m128* d = r.direction;
+        __m128 e1x = _mm_set1_ps(edge1[0]), e1y = _mm_set1_ps(edge1[1]), e1z = _mm_set1_ps(edge1[2]);
+        __m128 e2x = _mm_set1_ps(edge2[0]), e2y = _mm_set1_ps(edge2[1]), e2z = _mm_set1_ps(edge2[2]);
+        __m128 px = _mm_sub_ps(_mm_mul_ps(d[1], e2z), _mm_mul_ps(d[2], e2y));
+        __m128 py = _mm_sub_ps(_mm_mul_ps(d[2], e2x), _mm_mul_ps(d[0], e2z));
+        __m128 pz = _mm_sub_ps(_mm_mul_ps(d[0], e2y), _mm_mul_ps(d[1], e2x));
+        __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+        __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+        __m128 sx = _mm_sub_ps(r.origin[0], _mm_set1_ps(v0[0]));
+        __m128 sy = _mm_sub_ps(r.origin[1], _mm_set1_ps(v0[1]));
+        __m128 sz = _mm_sub_ps(r.origin[2], _mm_set1_ps(v0[2]));
+        __m128 uu = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet);
+        __m128 zero = _mm_setzero_ps();
+        __m128 mask = _mm_cmpge_ps(uu, zero);
+        if (r.frontFacesOnly) {
+            mask = _mm_and_ps(mask, _mm_cmpgt_ps(det, zero));
+        }
+        if (_mm_movemask_ps(mask) == 0) {
+            return 0;
+        }
+        __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+        __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+        __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+        __m128 vv = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(d[0], qx), _mm_mul_ps(d[1], qy)), _mm_mul_ps(d[2], qz)), invDet);
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(vv, zero));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(uu, vv), _mm_set1_ps(1.0f)));
+        if (_mm_movemask_ps(mask) == 0) {
+            return 0;
+        }
+        __m128 tt = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+        mask = _mm_and_ps(mask, _mm_cmpgt_ps(tt, zero));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(tt, r.tBest));
+        *t = tt;
+        *u = uu;
+        *v = vv;
+        return _mm_movemask_ps(mask);
+    }
+}
+
+void TriangleBvh::IntersectPacket(const BvhRay* rays, int numRays, BvhHit* hits) const
+{
+    for (int i = 0; i < numRays; i++) {
+        ClearHit(&hits[i]);
+    }
+    if (nodes.empty() || numRays <= 0) {
+        return;
+    }
+    RayPacket packet;
+    SetupPacket(rays, numRays, frontFacesOnly, &packet);
+    alignas(16) float bestT[4], bestU[4], bestV[4];
+    int bestTriangle[4] = { -1, -1, -1, -1 };
+    int stack[MaxStackDepth];
+    int stackSize = 0;
+    int nodeIndex = 0;
+    while (true) {
+        const Node& node = nodes[nodeIndex];
+        if (PacketHitsBox(packet, node.boxMin, node.boxMax) != 0) {
+            if (node.count < 0) {
+                int axis = -1 - node.count;
+                if (rays[0].direction[axis] < 0.0f) {
+                    stack[stackSize++] = nodeIndex + 1;
+                    nodeIndex = node.first;
+                }
+                else {
+                    stack[stackSize++] = node.first;
+                    nodeIndex = nodeIndex + 1;
+                }
+                continue;
+            }
+            for (int i = node.first; i < node.first + node.count; i++) {
+                const LeafTriangle& lt = leafTriangles[i];
+                __m128 t, u, v;
+                int hitLanes = PacketHitsTriangle(packet, lt.v0, lt.edge1, lt.edge2, &t, &u, &v);
+                if (hitLanes != 0) {
+                    // Hits are rare next to the tests, so keep the lanes' hits one lane at a time
+                    alignas(16) float laneT[4], laneU[4], laneV[4];
+                    _mm_store_ps(laneT, t);
+                    _mm_store_ps(laneU, u);
+                    _mm_store_ps(laneV, v);
+                    _mm_store_ps(bestT, packet.tBest);
+                    for (int lane = 0; lane < 4; lane++) {
+                        if (hitLanes & (1 << lane)) {
+                            bestT[lane] = laneT[lane];
+                            bestU[lane] = laneU[lane];
+                            bestV[lane] = laneV[lane];
+                            bestTriangle[lane] = lt.triangle;
+                        }
+                    }
+                    packet.tBest = _mm_load_ps(bestT);
+                }
+            }
+        }
+        if (stackSize == 0) {
+            break;
+        }
+        nodeIndex = stack[--stackSize];
+    }
+    for (int i = 0; i < numRays; i++) {
+        if (bestTriangle[i] >= 0) {
+            hits[i].t = bestT[i];
+            hits[i].u = bestU[i];
+            hits[i].v = bestV[i];
+            hits[i].triangle = bestTriangle[i];
+            hits[i].object = triangleObjects[bestTriangle[i]];
+        }
+    }
+}
+
+void TriangleBvh::OccludedPacket(const BvhRay* rays, int numRays, unsigned char* occluded) const
+{
+    for (int i = 0; i < numRays; i++) {
+        occluded[i] = 0;
+    }
+    if (nodes.empty() || numRays <= 0) {
+        return;
+    }
+    RayPacket packet;
+    SetupPacket(rays, numRays, frontFacesOnly, &packet);
+    const int allLanes = (1 << numRays) - 1;
+    int blockedLanes = 0;
+    int stack[MaxStackDepth];
+    int stackSize = 0;
+    int nodeIndex = 0;
+    while (true) {
+        const Node& node = nodes[nodeIndex];
+        if (PacketHitsBox(packet, node.boxMin, node.boxMax) != 0) {
+            if (node.count < 0) {
+                stack[stackSize++] = node.first;
+                nodeIndex = nodeIndex + 1;
+                continue;
+            }
+            for (int i = node.first; i < node.first + node.count; i++) {
+                const LeafTriangle& lt = leafTriangles[i];
+                __m128 t, u, v;
+                int hitLanes = PacketHitsTriangle(packet, lt.v0, lt.edge1, lt.edge2, &t, &u, &v);
+                if (hitLanes != 0) {
+                    blockedLanes |= hitLanes;
+                    if (blockedLanes == allLanes) {
+                        break;
+                    }
+                    // The blocked rays drop out of the packet
+                    alignas(16) float laneBest[4];
+                    _mm_store_ps(laneBest, packet.tBest);
+                    for (int lane = 0; lane < 4; lane++) {
+                        if (hitLanes & (1 << lane)) {
+                            laneBest[lane] = -1.0f;
+                        }
+                    }
+                    packet.tBest = _mm_load_ps(laneBest);
+                }
+            }
+            if (blockedLanes == allLanes) {
+                break;
+            }
+        }
+        if (stackSize == 0) {
+            break;
+        }
+        nodeIndex = stack[--stackSize];
+    }
+    for (int i = 0; i < numRays; i++) {
+        occluded[i] = (blockedLanes >> i) & 1;
+    }
+}
+
+#else   // Without SSE, a packet is its rays one at a time
+
+void TriangleBvh::IntersectPacket(const BvhRay* rays, int numRays, BvhHit* hits) const
+{
+    for (int i = 0; i < numRays; i++) {
+        Intersect(rays[i], &hits[i]);
+    }
+}
+
+void TriangleBvh::OccludedPacket(const BvhRay* rays, int numRays, unsigned char* occluded) const
+{
+    for (int i = 0; i < numRays; i++) {
+        occluded[i] = Occluded(rays[i]) ? 1 : 0;
+    }
+}
+
+#endif  // TRIANGLE_BVH_USE_SSE
+
+// **********************************************
+// Batches: consecutive rays are packed together, so give adjacent rays
+//    similar origins and directions for the best speed.
+// **********************************************
+void TriangleBvh::IntersectRays(const BvhRay* rays, int numRays, BvhHit* hits) const
+{
+    CpuProfileZone zone("TriangleBvh::IntersectRays");
+    int numPackets = (numRays + PacketSize - 1) / PacketSize;
+    WorkerPool::ParallelFor(numPackets, PacketsPerChunk, [&](int begin, int end) {
+        for (int p = begin; p < end; p++) {
+            int firstRay = p * PacketSize;
+            IntersectPacket(rays + firstRay, std::min(PacketSize, numRays - firstRay), hits + firstRay);
+        }
+    });
+}
+
+void TriangleBvh::OccludedRays(const BvhRay* rays, int numRays, unsigned char* occluded) const
+{
+    CpuProfileZone zone("TriangleBvh::OccludedRays");
+    int numPackets = (numRays + PacketSize - 1) / PacketSize;
+    WorkerPool::ParallelFor(numPackets, PacketsPerChunk, [&](int begin, int end) {
+        for (int p = begin; p < end; p++) {
+            int firstRay = p * PacketSize;
+            OccludedPacket(rays + firstRay, std::min(PacketSize, numRays - firstRay), occluded + firstRay);
+        }
+    });
+}
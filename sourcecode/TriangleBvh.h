@@ -0,0 +1,137 @@
+#pragma once
+
+//
+// TriangleBvh.h  ---  Header file for TriangleBvh.cpp
+//
+//   A bounding volume hierarchy over static triangles, for ray queries on
+//   the CPU: hitscan traces, mouse picking and line-of-sight checks.
+//
+//   The tree is built once with the surface area heuristic (SAH), binning
+//   the triangles' centroids, and is stored flattened in depth-first order:
+//   each node is 32 bytes, an interior node's first child follows it, and
+//   the leaves' triangles are stored in the order of the leaves.
+//
+//   Queries:
+//     Intersect finds the closest hit along a ray; Occluded stops at any hit.
+//     The packet versions trace up to four rays together, with SSE when it is
+//     available: a node is visited when any of the rays hits its box, and a
+//     triangle is tested against all four rays at once.  Packets of rays that
+//     start near each other and point the same way (e.g., through adjacent
+//     pixels) are the fastest.  The batch versions split the rays into
+//     packets and trace them on the worker threads (see WorkerPool.h).
+//
+//   Triangles are hit from both sides, unless SetFrontFacesOnly is set (e.g.,
+//   for one sided walls).  A hit must be at t > 0 and t <= tMax.
+//
+
+#ifndef TRIANGLE_BVH_H
+#define TRIANGLE_BVH_H
+
+#include <vector>
+
+class LinearMapR4;
+class GlStaticGeometry;
+class GlGeomBase;
+
+// BvhRay
+//    The points origin + t * direction, for 0 < t <= tMax.  The direction need not be a unit vector:
+//    e.g., a line of sight from a to b has direction b - a and tMax = 1.
+struct BvhRay {
+    float origin[3];
+    float direction[3];
+    float tMax;
+};
+
+// BvhHit
+//    Where a ray hit: the point is origin + t * direction, or
+//    (1-u-v) * v0 + u * v1 + v * v2 in the triangle.
+struct BvhHit {
+    float t;
+    float u, v;
+    int triangle;           // Index of the triangle, in the order they were added; -1 for no hit
+    int object;             // The object of the triangle (see AddMesh); -1 for no hit
+};
+
+class TriangleBvh {
+
+public:
+    static constexpr int PacketSize = 4;            // Rays traced together
+    static constexpr int MaxLeafTriangles = 4;      // Larger nodes are always split (if their triangles can be)
+    static constexpr int NumBins = 16;              // SAH bins along each axis
+
+    TriangleBvh() {}
+
+    // The triangles, in world coordinates.  Each mesh or shape is placed by the
+    //    model matrix (nullptr for the identity) and becomes one object.
+    //    Returns the object's number.  Build must be called after adding triangles.
+    void Clear();
+    int AddMesh(const GlStaticGeometry& geometry, int mesh, const LinearMapR4* modelMatrix = nullptr);
+    int AddShape(GlGeomBase& shape, const LinearMapR4* modelMatrix = nullptr);     // A GlGeomSphere, GlGeomTorus, etc.
+    void Build();
+
+    // Only hit the front faces: the triangles whose vertices are counterclockwise as seen by the ray.
+    //    Applies to all the queries; it is kept by Clear.
+    void SetFrontFacesOnly(bool only) { frontFacesOnly = only; }
+    bool GetFrontFacesOnly() const { return frontFacesOnly; }
+
+    int GetNumTriangles() const { return (int)triangleObjects.size(); }
+    int GetNumObjects() const { return numObjects; }
+    int GetNumNodes() const { return (int)nodes.size(); }
+    int GetDepth() const { return depth; }
+
+    // One ray.  Return true if the ray hit.  Intersect fills in the closest hit (object -1 for none).
+    bool Intersect(const BvhRay& ray, BvhHit* hit) const;
+    bool Occluded(const BvhRay& ray) const;
+
+    // One packet of 1 to PacketSize rays.  occluded[i] is set to 1 or 0.
+    void IntersectPacket(const BvhRay* rays, int numRays, BvhHit* hits) const;
+    void OccludedPacket(const BvhRay* rays, int numRays, unsigned char* occluded) const;
+
+    // Any number of rays, in packets on the worker threads.  Call from the OpenGL thread.
+    void IntersectRays(const BvhRay* rays, int numRays, BvhHit* hits) const;
+    void OccludedRays(const BvhRay* rays, int numRays, unsigned char* occluded) const;
+
+private:
+    // A node: the bounding box, then either a leaf's triangles
+    //    (count > 0: triangles first through first+count-1 in leafTriangles),
+    //    or an interior node's second child (count is -1 - the split axis).
+    struct Node {
+        float boxMin[3];
+        int first;
+        float boxMax[3];
+        int count;
+    };
+    std::vector<Node> nodes;
+    int depth = 0;
+
+    // A triangle ready for ray tests: a vertex and the two edges from it
+    struct LeafTriangle {
+        float v0[3];
+        float edge1[3];
+        float edge2[3];
+        int triangle;               // Index in the order added
+    };
+    std::vector<LeafTriangle> leafTriangles;
+
+    std::vector<float> triangleVerts;       // 9 floats per triangle, in the order added
+    std::vector<int> triangleObjects;
+    int numObjects = 0;
+    bool frontFacesOnly = false;
+    void AddTriangles(const float* positions, int stride, const unsigned int* elements, int numElements,
+                      const LinearMapR4* modelMatrix);
+
+    // Building
+    struct BuildTriangle {
+        float boxMin[3], boxMax[3];
+        float centroid[3];
+        int triangle;
+    };
+    std::vector<BuildTriangle> buildTriangles;
+    void BuildNode(int nodeIndex, int first, int count, int level);
+    bool FindSplit(int first, int count, const float boxMin[3], const float boxMax[3],
+                   const float centroidMin[3], const float centroidMax[3], int* axis, int* splitBin);
+
+    static constexpr int MaxStackDepth = 64;       // Bounds the depth of the tree, for the traversal stacks
+};
+
+#endif // TRIANGLE_BVH_H
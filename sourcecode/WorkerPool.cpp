@@ -0,0 +1,148 @@
+//
+// WorkerPool.cpp
+//
+//   Worker threads for data-parallel loops.  See WorkerPool.h.
+//
+
+#include "WorkerPool.h"
+#include "CpuProfiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+int WorkerPool::numWorkers = 0;
+
+namespace {
+    std::vector<std::thread> workerThreads;
+    std::mutex jobMutex;
+    std::condition_variable jobStarted;
+    std::condition_variable jobFinished;
+    bool stopWorkers = false;
+    bool stopRegistered = false;
+
+    // The current loop.  jobNumber changes for each loop, which wakes the workers.
+    //   A new loop is not started until every worker has left the previous one
+    //   (workersBusy is zero), so no worker can take a chunk of the wrong loop.
+    long long jobNumber = 0;
+    const std::function<void(int, int)>* jobBody = nullptr;
+    int jobNumItems = 0;
+    int jobGrainSize = 1;
+    int workersBusy = 0;
+    std::atomic<int> nextChunk(0);
+    std::atomic<int> chunksLeft(0);
+}
+
+void WorkerPool::Start(int theNumWorkers)
+{
+    Stop();
+    if (theNumWorkers < 0) {
+        int hardwareThreads = (int)std::thread::hardware_concurrency();
+        theNumWorkers = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+    numWorkers = theNumWorkers < MaxWorkers ? theNumWorkers : MaxWorkers;
+    stopWorkers = false;
+    for (int i = 0; i < numWorkers; i++) {
+        workerThreads.emplace_back(WorkerLoop, i + 1);
+    }
+    if (!stopRegistered) {
+        atexit(Stop);
+        stopRegistered = true;
+    }
+    printf("Worker threads: %d.\n", numWorkers);
+}
+
+void WorkerPool::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopWorkers = true;
+    }
+    jobStarted.notify_all();
+    for (std::thread& worker : workerThreads) {
+        worker.join();
+    }
+    workerThreads.clear();
+    numWorkers = 0;
+}
+
+// Take chunks of the current loop until there are none left.
+void WorkerPool::RunChunks(const std::function<void(int begin, int end)>& body, int numItems, int grainSize)
+{
+    int numChunks = NumChunks(numItems, grainSize);
+    for (;;) {
+        int chunk = nextChunk.fetch_add(1);
+        if (chunk >= numChunks) {
+            return;
+        }
+        int begin = chunk * grainSize;
+        int end = begin + grainSize < numItems ? begin + grainSize : numItems;
+        body(begin, end);
+        if (chunksLeft.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(jobMutex);     // The last chunk: wake the calling thread
+            jobFinished.notify_all();
+        }
+    }
+}
+
+void WorkerPool::WorkerLoop(int workerIndex)
+{
+    char threadName[32];
+    snprintf(threadName, sizeof(threadName), "Worker %d", workerIndex);
+    CpuProfiler::SetThreadName(threadName);
+    long long lastJob = 0;
+    for (;;) {
+        const std::function<void(int, int)>* body;
+        int numItems, grainSize;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobStarted.wait(lock, [&lastJob] { return stopWorkers || jobNumber != lastJob; });
+            if (stopWorkers) {
+                return;
+            }
+            lastJob = jobNumber;
+            body = jobBody;
+            numItems = jobNumItems;
+            grainSize = jobGrainSize;
+            workersBusy++;
+        }
+        RunChunks(*body, numItems, grainSize);
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            workersBusy--;
+        }
+        jobFinished.notify_all();
+    }
+}
+
+void WorkerPool::ParallelFor(int numItems, int grainSize, const std::function<void(int begin, int end)>& body)
+{
+    if (grainSize < 1) {
+        grainSize = 1;
+    }
+    if (numItems <= grainSize || numWorkers == 0) {
+        for (int begin = 0; begin < numItems; begin += grainSize) {
+            body(begin, begin + grainSize < numItems ? begin + grainSize : numItems);
+        }
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(jobMutex);
+        jobFinished.wait(lock, [] { return workersBusy == 0; });    // Workers still leaving the previous loop
+        jobBody = &body;
+        jobNumItems = numItems;
+        jobGrainSize = grainSize;
+        nextChunk.store(0);
+        chunksLeft.store(NumChunks(numItems, grainSize));
+        jobNumber++;
+    }
+    jobStarted.notify_all();
+    RunChunks(body, numItems, grainSize);       // The calling thread works too
+
+    std::unique_lock<std::mutex> lock(jobMutex);
+    jobFinished.wait(lock, [] { return chunksLeft.load() == 0; });
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+//
+// WorkerPool.h  ---  Header file for WorkerPool.cpp
+//
+//   A fixed set of worker threads for data-parallel loops:
+//       WorkerPool::ParallelFor(numItems, grainSize, [&](int begin, int end) {
+//           for (int i = begin; i < end; i++) { ... }
+//       });
+//   The items are split into chunks of grainSize.  The workers and the calling
+//   thread take chunks until none are left; ParallelFor returns when all the
+//   chunks are done.  Loops of at most grainSize items run on the calling thread.
+//
+//   The workers never make OpenGL calls: they only fill arrays that the
+//   OpenGL thread then submits.  ParallelFor must only be called from one
+//   thread at a time (the OpenGL thread).
+//
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <functional>
+
+class WorkerPool {
+
+public:
+    static constexpr int MaxWorkers = 31;
+
+    // Start numWorkers worker threads.  numWorkers < 0 means one less than the
+    //   number of hardware threads; 0 runs every loop on the calling thread.
+    //   The workers are stopped at exit.
+    static void Start(int numWorkers = -1);
+    static void Stop();
+    static int GetNumWorkers() { return numWorkers; }
+
+    // Call body(begin, end) for consecutive chunks of the items 0 through numItems-1.
+    static void ParallelFor(int numItems, int grainSize, const std::function<void(int begin, int end)>& body);
+
+    // The number of chunks ParallelFor splits the items into.  Chunk c is items c*grainSize and up.
+    static int NumChunks(int numItems, int grainSize) { return (numItems + grainSize - 1) / grainSize; }
+
+private:
+    static int numWorkers;
+    static void WorkerLoop(int workerIndex);
+    static void RunChunks(const std::function<void(int begin, int end)>& body, int numItems, int grainSize);
+};
+
+#endif // WORKER_POOL_H